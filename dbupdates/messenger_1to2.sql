@@ -0,0 +1,5 @@
+DROP INDEX IF EXISTS messagesCounterIdx;
+CREATE INDEX IF NOT EXISTS messagesUserCounterIdx ON messages ( userid, morder );
+CREATE INDEX IF NOT EXISTS messagesUserConfirmedIdx ON messages ( userid, isConfirmed, morder );
+CREATE INDEX IF NOT EXISTS messagesUserHashIdx ON messages ( userid, hash, channelid, morder, isConfirmed );
+CREATE INDEX IF NOT EXISTS messagesNotDecryptedIdx ON messages ( userid, morder ) WHERE isDecrypted = 0 AND canDecrypted = 1;
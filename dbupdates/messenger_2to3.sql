@@ -0,0 +1,3 @@
+ALTER TABLE lastreadmessage ADD COLUMN unreadcount INT8 NOT NULL DEFAULT 0;
+UPDATE lastreadmessage SET unreadcount = ( SELECT COUNT(*) FROM messages m WHERE m.userid = lastreadmessage.userid AND m.contactid = lastreadmessage.contactid AND m.morder > lastreadmessage.lastcounter ) WHERE contactid IS NOT NULL;
+UPDATE lastreadmessage SET unreadcount = ( SELECT COUNT(*) FROM messages m WHERE m.userid = lastreadmessage.userid AND m.channelid = lastreadmessage.channelid AND m.morder > lastreadmessage.lastcounter ) WHERE channelid IS NOT NULL;
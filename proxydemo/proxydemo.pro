@@ -26,6 +26,7 @@ SOURCES += \
         ../src/utils.cpp \
         ../src/Paths.cpp \
         ../src/btctx/Base58.cpp \
+        ../src/HexBase64.cpp \
         \
         ../src/proxy/UPnPDevices.cpp \
         ../src/proxy/UPnPRouter.cpp \
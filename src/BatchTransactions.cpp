@@ -0,0 +1,73 @@
+#include "BatchTransactions.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+
+#include "Wallet.h"
+#include "check.h"
+#include "TypedException.h"
+#include "ParallelFor.h"
+
+// Подпись транзакции стоит десятки микросекунд, запуск потока сравним с ней, поэтому потоку отдается хотя бы несколько транзакций
+const static size_t MIN_TRANSACTIONS_PER_THREAD = 4;
+
+static uint64_t parseBatchNumber(const QJsonObject &jsonObj, const QString &field, size_t index) {
+    const std::string error = field.toStdString() + " field incorrect in transaction " + std::to_string(index);
+    CHECK_TYPED(jsonObj.contains(field) && jsonObj.value(field).isString(), TypeErrors::INCORRECT_USER_DATA, error);
+    bool isValid;
+    const uint64_t result = jsonObj.value(field).toString().toULongLong(&isValid, 10);
+    CHECK_TYPED(isValid, TypeErrors::INCORRECT_USER_DATA, error);
+    return result;
+}
+
+std::vector<BatchTransaction> parseBatchTransactions(const QString &jsonTransactions) {
+    const QJsonDocument document = QJsonDocument::fromJson(jsonTransactions.toUtf8());
+    CHECK_TYPED(document.isArray(), TypeErrors::INCORRECT_USER_DATA, "jsonTransactions not array");
+    const QJsonArray root = document.array();
+
+    std::vector<BatchTransaction> result;
+    result.reserve(root.size());
+    for (const auto &jsonObj2: root) {
+        CHECK_TYPED(jsonObj2.isObject(), TypeErrors::INCORRECT_USER_DATA, "transaction not object");
+        const QJsonObject jsonObj = jsonObj2.toObject();
+        const size_t index = result.size();
+        BatchTransaction tx;
+        CHECK_TYPED(jsonObj.contains("to") && jsonObj.value("to").isString(), TypeErrors::INCORRECT_USER_DATA, "to field not found in transaction " + std::to_string(index));
+        tx.toAddress = jsonObj.value("to").toString().toStdString();
+        tx.value = parseBatchNumber(jsonObj, "value", index);
+        tx.fee = 0;
+        if (jsonObj.contains("fee") && jsonObj.value("fee") != QJsonValue("")) {
+            tx.fee = parseBatchNumber(jsonObj, "fee", index);
+        }
+        tx.nonce = parseBatchNumber(jsonObj, "nonce", index);
+        if (jsonObj.contains("data")) {
+            CHECK_TYPED(jsonObj.value("data").isString(), TypeErrors::INCORRECT_USER_DATA, "data field incorrect in transaction " + std::to_string(index));
+            tx.dataHex = jsonObj.value("data").toString().toStdString();
+        }
+        result.emplace_back(tx);
+    }
+    return result;
+}
+
+QJsonDocument makeJsonBatchSignatures(const std::vector<BatchSignature> &signatures) {
+    QJsonArray jsonArray;
+    for (const BatchSignature &signature: signatures) {
+        QJsonObject val;
+        val.insert("signature", QString::fromStdString(signature.signature));
+        val.insert("publicKey", QString::fromStdString(signature.publicKey));
+        val.insert("tx", QString::fromStdString(signature.tx));
+        jsonArray.push_back(val);
+    }
+    return QJsonDocument(jsonArray);
+}
+
+std::vector<BatchSignature> signBatchTransactions(const Wallet &wallet, const std::vector<BatchTransaction> &transactions) {
+    std::vector<BatchSignature> signatures(transactions.size());
+    parallelFor(0, transactions.size(), MIN_TRANSACTIONS_PER_THREAD, [&transactions, &signatures, &wallet](size_t i) {
+        const BatchTransaction &tx = transactions[i];
+        BatchSignature &signature = signatures[i];
+        wallet.sign(tx.toAddress, tx.value, tx.fee, tx.nonce, tx.dataHex, signature.tx, signature.signature, signature.publicKey);
+    });
+    return signatures;
+}
@@ -0,0 +1,34 @@
+#ifndef BATCHTRANSACTIONS_H
+#define BATCHTRANSACTIONS_H
+
+#include <string>
+#include <vector>
+
+#include <QString>
+#include <QJsonDocument>
+
+class Wallet;
+
+struct BatchTransaction {
+    std::string toAddress;
+    uint64_t value;
+    uint64_t fee;
+    uint64_t nonce;
+    std::string dataHex;
+};
+
+struct BatchSignature {
+    std::string tx;
+    std::string signature;
+    std::string publicKey;
+};
+
+// json массив [{"to": "0x...", "value": "100", "fee": "0", "nonce": "5", "data": "hex"}], fee и data необязательны
+std::vector<BatchTransaction> parseBatchTransactions(const QString &jsonTransactions);
+
+QJsonDocument makeJsonBatchSignatures(const std::vector<BatchSignature> &signatures);
+
+// Подписи возвращаются в порядке транзакций. Короткие пачки подписываются в вызывающем потоке
+std::vector<BatchSignature> signBatchTransactions(const Wallet &wallet, const std::vector<BatchTransaction> &transactions);
+
+#endif // BATCHTRANSACTIONS_H
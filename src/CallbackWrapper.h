@@ -75,6 +75,10 @@ public:
         emitFunc(exception, std::forward<Args>(args)...);
     }
 
+    bool isSet() const {
+        return signal != nullptr;
+    }
+
 private:
 
     std::function<Callback> callback;
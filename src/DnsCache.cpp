@@ -0,0 +1,100 @@
+#include "DnsCache.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+
+#include <algorithm>
+
+#include "check.h"
+
+namespace dns_cache {
+
+const static seconds MIN_DNS_TTL = 1min;
+
+const static seconds MAX_DNS_TTL = hours(24);
+
+Cache readFile(const QString &file) {
+    Cache cache;
+    QFile inputFile(file);
+    if (!inputFile.open(QIODevice::ReadOnly)) {
+        return cache;
+    }
+    const QJsonDocument document = QJsonDocument::fromJson(inputFile.readAll());
+    if (!document.isArray()) {
+        return cache;
+    }
+    for (const QJsonValue &value: document.array()) {
+        const QJsonObject record = value.toObject();
+        if (!record.value("name").isString() || !record.value("ips").isArray() || !record.value("expire").isString()) {
+            continue;
+        }
+        bool isNumber = false;
+        const qulonglong expire = record.value("expire").toString().toULongLong(&isNumber);
+        if (!isNumber) {
+            continue;
+        }
+        Record cacheRecord;
+        for (const QJsonValue &ip: record.value("ips").toArray()) {
+            if (ip.isString()) {
+                cacheRecord.ips.emplace_back(ip.toString());
+            }
+        }
+        cacheRecord.expire = intToSystemTimePoint(expire);
+        cache[record.value("name").toString()] = cacheRecord;
+    }
+    return cache;
+}
+
+void writeFile(const QString &file, const Cache &cache) {
+    QJsonArray array;
+    for (const auto &pair: cache) {
+        QJsonObject record;
+        record.insert("name", pair.first);
+        QJsonArray ips;
+        for (const QString &ip: pair.second.ips) {
+            ips.push_back(ip);
+        }
+        record.insert("ips", ips);
+        record.insert("expire", QString::number(systemTimePointToInt(pair.second.expire)));
+        array.push_back(record);
+    }
+    const QByteArray data = QJsonDocument(array).toJson(QJsonDocument::Compact);
+
+    QSaveFile outputFile(file);
+    CHECK(outputFile.open(QIODevice::WriteOnly), "Not open file " + file.toStdString());
+    CHECK(outputFile.write(data) == data.size(), "Not write file " + file.toStdString());
+    CHECK(outputFile.commit(), "Not commit file " + file.toStdString());
+}
+
+system_time_point calcExpire(size_t ttlSeconds, const system_time_point &now) {
+    const seconds ttl = seconds(std::min(ttlSeconds, size_t(MAX_DNS_TTL.count())));
+    return now + std::max(ttl, MIN_DNS_TTL);
+}
+
+void splitNames(const Cache &cache, const std::set<QString> &names, const system_time_point &now, std::set<QString> &missing, std::set<QString> &stale) {
+    for (const QString &name: names) {
+        const auto found = cache.find(name);
+        if (found == cache.end() || found->second.ips.empty()) {
+            missing.insert(name);
+        } else if (found->second.expire <= now) {
+            stale.insert(name);
+        }
+    }
+}
+
+system_time_point nearestExpire(const Cache &cache, const std::set<QString> &names) {
+    system_time_point result = system_time_point::max();
+    for (const QString &name: names) {
+        const auto found = cache.find(name);
+        if (found != cache.end() && !found->second.ips.empty()) {
+            result = std::min(result, found->second.expire);
+        }
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,38 @@
+#ifndef DNSCACHE_H
+#define DNSCACHE_H
+
+#include <QString>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "duration.h"
+
+namespace dns_cache {
+
+struct Record {
+    std::vector<QString> ips; // ip без порта
+    system_time_point expire;
+};
+
+using Cache = std::map<QString, Record>;
+
+// Некорректные записи пропускаются, при отсутствии или повреждении файла кэш остается пустым
+Cache readFile(const QString &file);
+
+// Запись через временный файл с последующим переименованием
+void writeFile(const QString &file, const Cache &cache);
+
+// ttl ограничивается снизу и сверху, чтобы не долбить dns и не хранить адреса вечно
+system_time_point calcExpire(size_t ttlSeconds, const system_time_point &now);
+
+// missing - имена без адресов, stale - с адресами, но с истекшим ttl
+void splitNames(const Cache &cache, const std::set<QString> &names, const system_time_point &now, std::set<QString> &missing, std::set<QString> &stale);
+
+// Ближайшее время истечения среди имен names. Если адресов нет ни для одного имени, возвращается system_time_point::max()
+system_time_point nearestExpire(const Cache &cache, const std::set<QString> &names);
+
+}
+
+#endif // DNSCACHE_H
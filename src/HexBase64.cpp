@@ -0,0 +1,536 @@
+#include "HexBase64.h"
+
+#include <cstring>
+#include <cstdint>
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define HEXBASE64_SIMD 1
+#endif
+
+#ifdef HEXBASE64_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// gcc и clang собирают SIMD код без глобальных -mssse3 -mavx2
+#if defined(HEXBASE64_SIMD) && defined(__GNUC__)
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SSSE3_TARGET
+#define AVX2_TARGET
+#endif
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Векторный декодер base64 пишет полными регистрами, поэтому под результат выделяется запас
+static const size_t BASE64_DECODE_RESERVE = 32;
+
+static std::array<int8_t, 256> makeHexValues() {
+    std::array<int8_t, 256> values;
+    values.fill(-1);
+    for (int i = 0; i < 16; i++) {
+        values[uint8_t(HEX_DIGITS[i])] = int8_t(i);
+        values[uint8_t("0123456789ABCDEF"[i])] = int8_t(i);
+    }
+    return values;
+}
+
+static std::array<int8_t, 256> makeBase64Values() {
+    std::array<int8_t, 256> values;
+    values.fill(-1);
+    for (int i = 0; i < 64; i++) {
+        values[uint8_t(BASE64_ALPHABET[i])] = int8_t(i);
+    }
+    return values;
+}
+
+static const std::array<int8_t, 256> HEX_VALUES = makeHexValues();
+
+static const std::array<int8_t, 256> BASE64_VALUES = makeBase64Values();
+
+static inline int hexValue(char c) {
+    return HEX_VALUES[uint8_t(c)];
+}
+
+static inline int base64Value(char c) {
+    return BASE64_VALUES[uint8_t(c)];
+}
+
+enum class SimdLevel {
+    None = 0, Ssse3 = 1, Avx2 = 2
+};
+
+#ifdef HEXBASE64_SIMD
+
+static SimdLevel detectSimdLevel() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const unsigned int ecx = info[2];
+#else
+    unsigned int eax, ebx, ecx, edx;
+    const unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+    if (maxLeaf < 1) {
+        return SimdLevel::None;
+    }
+    __cpuid(1, eax, ebx, ecx, edx);
+#endif
+    if ((ecx & (1u << 9)) == 0) {
+        return SimdLevel::None;
+    }
+
+    // AVX2 нужна еще поддержка сохранения ymm регистров со стороны ОС
+    const bool osxsave = (ecx & (1u << 27)) != 0 && (ecx & (1u << 28)) != 0;
+    if (maxLeaf < 7 || !osxsave) {
+        return SimdLevel::Ssse3;
+    }
+#ifdef _MSC_VER
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    const unsigned int ebx7 = info[1];
+#else
+    unsigned int xcr0Low, xcr0High;
+    __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+    const unsigned long long xcr0 = xcr0Low;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    const unsigned int ebx7 = ebx;
+#endif
+    if ((xcr0 & 6) == 6 && (ebx7 & (1u << 5)) != 0) {
+        return SimdLevel::Avx2;
+    }
+    return SimdLevel::Ssse3;
+}
+
+static SimdLevel getSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+SSSE3_TARGET static size_t toHexBlocksSsse3(const uint8_t *in, size_t size, char *out) {
+    const __m128i lut = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i high = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+        const __m128i low = _mm_shuffle_epi8(lut, _mm_and_si128(bytes, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_unpackhi_epi8(high, low));
+    }
+    return i;
+}
+
+AVX2_TARGET static size_t toHexBlocksAvx2(const uint8_t *in, size_t size, char *out) {
+    const __m256i lut = _mm256_setr_epi8(
+        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+    );
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        // Распаковка идет внутри 128-битных половин, поэтому заранее переставляем 64-битные части
+        const __m256i bytes = _mm256_permute4x64_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), 0xD8);
+        const __m256i high = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask));
+        const __m256i low = _mm256_shuffle_epi8(lut, _mm256_and_si256(bytes, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2), _mm256_unpacklo_epi8(high, low));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2 + 32), _mm256_unpackhi_epi8(high, low));
+    }
+    return i;
+}
+
+SSSE3_TARGET static inline __m128i hexValuesSsse3(__m128i chars, __m128i &valid) {
+    const __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+    valid = _mm_or_si128(isDigit, isLetter);
+    return _mm_or_si128(_mm_and_si128(isDigit, digits), _mm_and_si128(isLetter, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+}
+
+// Останавливается на первом блоке с не hex символом
+SSSE3_TARGET static size_t fromHexBlocksSsse3(const char *in, size_t size, uint8_t *out) {
+    // Пара полубайтов в байт: high * 16 + low
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m128i valid0, valid1;
+        const __m128i values0 = hexValuesSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), valid0);
+        const __m128i values1 = hexValuesSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16)), valid1);
+        if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xFFFF) {
+            break;
+        }
+        const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(values0, weights), _mm_maddubs_epi16(values1, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 2), bytes);
+    }
+    return i;
+}
+
+AVX2_TARGET static inline __m256i hexValuesAvx2(__m256i chars, __m256i &valid) {
+    const __m256i digits = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    const __m256i letters = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+    const __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letters, _mm256_set1_epi8(5)), letters);
+    valid = _mm256_or_si256(isDigit, isLetter);
+    return _mm256_or_si256(_mm256_and_si256(isDigit, digits), _mm256_and_si256(isLetter, _mm256_add_epi8(letters, _mm256_set1_epi8(10))));
+}
+
+AVX2_TARGET static size_t fromHexBlocksAvx2(const char *in, size_t size, uint8_t *out) {
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m256i valid0, valid1;
+        const __m256i values0 = hexValuesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), valid0);
+        const __m256i values1 = hexValuesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 32)), valid1);
+        if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1) {
+            break;
+        }
+        const __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(values0, weights), _mm256_maddubs_epi16(values1, weights));
+        // Упаковка тоже идет по половинам
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 2), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    return i;
+}
+
+/*
+   Каждые 3 байта раскладываются на 4 индекса по 6 бит умножениями вместо сдвигов,
+   индекс переводится в символ прибавлением смещения, которое зависит от диапазона индекса
+ */
+SSSE3_TARGET static inline __m128i base64CharsSsse3(__m128i bytes) {
+    const __m128i spread = _mm_shuffle_epi8(bytes, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i indices0 = _mm_mulhi_epu16(_mm_and_si128(spread, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+    const __m128i indices1 = _mm_mullo_epi16(_mm_and_si128(spread, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(indices0, indices1);
+
+    // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12
+    __m128i ranges = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    ranges = _mm_or_si128(ranges, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+    const __m128i shifts = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(shifts, ranges), indices);
+}
+
+SSSE3_TARGET static size_t toBase64BlocksSsse3(const uint8_t *in, size_t size, char *out) {
+    size_t i = 0;
+    // Читается 16 байт, используется 12
+    for (; i + 16 <= size; i += 12, out += 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), base64CharsSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+    }
+    return i;
+}
+
+AVX2_TARGET static inline __m256i base64CharsAvx2(__m256i bytes) {
+    const __m256i spread = _mm256_shuffle_epi8(bytes, _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1
+    ));
+    const __m256i indices0 = _mm256_mulhi_epu16(_mm256_and_si256(spread, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+    const __m256i indices1 = _mm256_mullo_epi16(_mm256_and_si256(spread, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(indices0, indices1);
+
+    __m256i ranges = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    ranges = _mm256_or_si256(ranges, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+    const __m256i shifts = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0
+    );
+    return _mm256_add_epi8(_mm256_shuffle_epi8(shifts, ranges), indices);
+}
+
+AVX2_TARGET static size_t toBase64BlocksAvx2(const uint8_t *in, size_t size, char *out) {
+    size_t i = 0;
+    // В каждую половину регистра своя тройка по 12 байт
+    for (; i + 28 <= size; i += 24, out += 32) {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12));
+        const __m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), base64CharsAvx2(bytes));
+    }
+    return i;
+}
+
+SSSE3_TARGET static inline __m128i inRangeSsse3(__m128i chars, char from, char to) {
+    return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(char(from - 1))), _mm_cmplt_epi8(chars, _mm_set1_epi8(char(to + 1))));
+}
+
+// Останавливается на первом блоке с символом вне алфавита (в том числе '=')
+SSSE3_TARGET static size_t fromBase64BlocksSsse3(const char *in, size_t size, uint8_t *out) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16, out += 12) {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i isUpper = inRangeSsse3(chars, 'A', 'Z');
+        const __m128i isLower = inRangeSsse3(chars, 'a', 'z');
+        const __m128i isDigit = inRangeSsse3(chars, '0', '9');
+        const __m128i isPlus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+        const __m128i isSlash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+        const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(isUpper, isLower), _mm_or_si128(isDigit, isPlus)), isSlash);
+        if (_mm_movemask_epi8(valid) != 0xFFFF) {
+            break;
+        }
+        __m128i shifts = _mm_and_si128(isUpper, _mm_set1_epi8(-'A'));
+        shifts = _mm_or_si128(shifts, _mm_and_si128(isLower, _mm_set1_epi8(26 - 'a')));
+        shifts = _mm_or_si128(shifts, _mm_and_si128(isDigit, _mm_set1_epi8(52 - '0')));
+        shifts = _mm_or_si128(shifts, _mm_and_si128(isPlus, _mm_set1_epi8(62 - '+')));
+        shifts = _mm_or_si128(shifts, _mm_and_si128(isSlash, _mm_set1_epi8(63 - '/')));
+        const __m128i values = _mm_add_epi8(chars, shifts);
+
+        // Склеиваем 4 значения по 6 бит в 24 бита и берем 3 старших байта каждого слова
+        const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+    }
+    return i;
+}
+
+AVX2_TARGET static inline __m256i inRangeAvx2(__m256i chars, char from, char to) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(char(from - 1))), _mm256_cmpgt_epi8(_mm256_set1_epi8(char(to + 1)), chars));
+}
+
+AVX2_TARGET static size_t fromBase64BlocksAvx2(const char *in, size_t size, uint8_t *out) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32, out += 24) {
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i isUpper = inRangeAvx2(chars, 'A', 'Z');
+        const __m256i isLower = inRangeAvx2(chars, 'a', 'z');
+        const __m256i isDigit = inRangeAvx2(chars, '0', '9');
+        const __m256i isPlus = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('+'));
+        const __m256i isSlash = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/'));
+        const __m256i valid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(isUpper, isLower), _mm256_or_si256(isDigit, isPlus)), isSlash);
+        if (_mm256_movemask_epi8(valid) != -1) {
+            break;
+        }
+        __m256i shifts = _mm256_and_si256(isUpper, _mm256_set1_epi8(-'A'));
+        shifts = _mm256_or_si256(shifts, _mm256_and_si256(isLower, _mm256_set1_epi8(26 - 'a')));
+        shifts = _mm256_or_si256(shifts, _mm256_and_si256(isDigit, _mm256_set1_epi8(52 - '0')));
+        shifts = _mm256_or_si256(shifts, _mm256_and_si256(isPlus, _mm256_set1_epi8(62 - '+')));
+        shifts = _mm256_or_si256(shifts, _mm256_and_si256(isSlash, _mm256_set1_epi8(63 - '/')));
+        const __m256i values = _mm256_add_epi8(chars, shifts);
+
+        const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        const __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        const __m256i packed = _mm256_shuffle_epi8(words, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+        ));
+        // По 12 байт из каждой половины подряд
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7)));
+    }
+    return i;
+}
+
+#endif // HEXBASE64_SIMD
+
+// Функции ниже обрабатывают начало данных целыми блоками и возвращают, сколько входных байт обработано
+
+static size_t toHexBlocks(const uint8_t *in, size_t size, char *out) {
+    size_t done = 0;
+#ifdef HEXBASE64_SIMD
+    const SimdLevel level = getSimdLevel();
+    if (level >= SimdLevel::Avx2) {
+        done = toHexBlocksAvx2(in, size, out);
+    }
+    if (level >= SimdLevel::Ssse3) {
+        done += toHexBlocksSsse3(in + done, size - done, out + done * 2);
+    }
+#endif
+    return done;
+}
+
+static size_t fromHexBlocks(const char *in, size_t size, uint8_t *out) {
+    size_t done = 0;
+#ifdef HEXBASE64_SIMD
+    const SimdLevel level = getSimdLevel();
+    if (level >= SimdLevel::Avx2) {
+        done = fromHexBlocksAvx2(in, size, out);
+    }
+    if (level >= SimdLevel::Ssse3) {
+        done += fromHexBlocksSsse3(in + done, size - done, out + done / 2);
+    }
+#endif
+    return done;
+}
+
+static size_t toBase64Blocks(const uint8_t *in, size_t size, char *out) {
+    size_t done = 0;
+#ifdef HEXBASE64_SIMD
+    const SimdLevel level = getSimdLevel();
+    if (level >= SimdLevel::Avx2) {
+        done = toBase64BlocksAvx2(in, size, out);
+    }
+    if (level >= SimdLevel::Ssse3) {
+        done += toBase64BlocksSsse3(in + done, size - done, out + done / 3 * 4);
+    }
+#endif
+    return done;
+}
+
+static size_t fromBase64Blocks(const char *in, size_t size, uint8_t *out) {
+    size_t done = 0;
+#ifdef HEXBASE64_SIMD
+    const SimdLevel level = getSimdLevel();
+    if (level >= SimdLevel::Avx2) {
+        done = fromBase64BlocksAvx2(in, size, out);
+    }
+    if (level >= SimdLevel::Ssse3) {
+        done += fromBase64BlocksSsse3(in + done, size - done, out + done / 4 * 3);
+    }
+#endif
+    return done;
+}
+
+bool isHexBase64Accelerated() {
+#ifdef HEXBASE64_SIMD
+    return getSimdLevel() != SimdLevel::None;
+#else
+    return false;
+#endif
+}
+
+void appendToHex(const char *data, size_t size, std::string &result) {
+    if (size == 0) {
+        return;
+    }
+    const size_t oldSize = result.size();
+    result.resize(oldSize + size * 2);
+    const uint8_t *in = reinterpret_cast<const uint8_t*>(data);
+    char *out = &result[oldSize];
+
+    for (size_t i = toHexBlocks(in, size, out); i < size; i++) {
+        out[i * 2] = HEX_DIGITS[in[i] >> 4];
+        out[i * 2 + 1] = HEX_DIGITS[in[i] & 0x0F];
+    }
+}
+
+static bool decodeHexPairs(const char *data, size_t size, uint8_t *out) {
+    for (size_t i = fromHexBlocks(data, size, out); i < size; i += 2) {
+        const int high = hexValue(data[i]);
+        const int low = hexValue(data[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        out[i / 2] = uint8_t((high << 4) | low);
+    }
+    return true;
+}
+
+void appendFromHex(const char *data, size_t size, std::string &result) {
+    if (size == 0) {
+        return;
+    }
+    const size_t oldSize = result.size();
+    const size_t maxSize = (size + 1) / 2;
+    result.resize(oldSize + maxSize);
+    uint8_t *begin = reinterpret_cast<uint8_t*>(&result[oldSize]);
+    if (size % 2 == 0 && decodeHexPairs(data, size, begin)) {
+        return;
+    }
+
+    // Повторяет QByteArray::fromHex: разбор с конца с пропуском не hex символов
+    uint8_t *out = begin + maxSize;
+    bool isLowNibble = true;
+    for (size_t i = size; i-- > 0;) {
+        const int value = hexValue(data[i]);
+        if (value < 0) {
+            continue;
+        }
+        if (isLowNibble) {
+            *--out = uint8_t(value);
+        } else {
+            *out |= uint8_t(value << 4);
+        }
+        isLowNibble = !isLowNibble;
+    }
+    const size_t resultSize = begin + maxSize - out;
+    std::memmove(begin, out, resultSize);
+    result.resize(oldSize + resultSize);
+}
+
+bool appendFromHexStrict(const char *data, size_t size, std::string &result) {
+    if (size == 0) {
+        return true;
+    }
+    const size_t oldSize = result.size();
+    result.resize(oldSize + (size + 1) / 2);
+    uint8_t *out = reinterpret_cast<uint8_t*>(&result[oldSize]);
+    if (size % 2 != 0) {
+        const int value = hexValue(data[0]);
+        if (value < 0) {
+            result.resize(oldSize);
+            return false;
+        }
+        *out++ = uint8_t(value);
+        data++;
+        size--;
+    }
+    if (!decodeHexPairs(data, size, out)) {
+        result.resize(oldSize);
+        return false;
+    }
+    return true;
+}
+
+void appendToBase64(const char *data, size_t size, std::string &result) {
+    if (size == 0) {
+        return;
+    }
+    const size_t oldSize = result.size();
+    result.resize(oldSize + (size + 2) / 3 * 4);
+    const uint8_t *in = reinterpret_cast<const uint8_t*>(data);
+    char *out = &result[oldSize];
+
+    size_t i = toBase64Blocks(in, size, out);
+    out += i / 3 * 4;
+    for (; i + 3 <= size; i += 3, out += 4) {
+        const uint32_t triple = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) | uint32_t(in[i + 2]);
+        out[0] = BASE64_ALPHABET[triple >> 18];
+        out[1] = BASE64_ALPHABET[(triple >> 12) & 0x3F];
+        out[2] = BASE64_ALPHABET[(triple >> 6) & 0x3F];
+        out[3] = BASE64_ALPHABET[triple & 0x3F];
+    }
+    const size_t rest = size - i;
+    if (rest != 0) {
+        const uint32_t triple = (uint32_t(in[i]) << 16) | (rest == 2 ? uint32_t(in[i + 1]) << 8 : 0);
+        out[0] = BASE64_ALPHABET[triple >> 18];
+        out[1] = BASE64_ALPHABET[(triple >> 12) & 0x3F];
+        out[2] = rest == 2 ? BASE64_ALPHABET[(triple >> 6) & 0x3F] : '=';
+        out[3] = '=';
+    }
+}
+
+void appendFromBase64(const char *data, size_t size, std::string &result) {
+    if (size == 0) {
+        return;
+    }
+    const size_t oldSize = result.size();
+    result.resize(oldSize + size / 4 * 3 + 3 + BASE64_DECODE_RESERVE);
+    uint8_t *begin = reinterpret_cast<uint8_t*>(&result[oldSize]);
+
+    const size_t done = fromBase64Blocks(data, size, begin);
+    uint8_t *out = begin + done / 4 * 3;
+
+    // Остаток как в QByteArray::fromBase64. Блоки выше кратны 4 символам, так что накопленных бит нет
+    uint32_t buffer = 0;
+    int countBits = 0;
+    for (size_t i = done; i < size; i++) {
+        const int value = base64Value(data[i]);
+        if (value < 0) {
+            continue;
+        }
+        buffer = (buffer << 6) | uint32_t(value);
+        countBits += 6;
+        if (countBits >= 8) {
+            countBits -= 8;
+            *out++ = uint8_t(buffer >> countBits);
+            buffer &= (1u << countBits) - 1;
+        }
+    }
+    result.resize(oldSize + (out - begin));
+}
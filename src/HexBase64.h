@@ -0,0 +1,33 @@
+#ifndef HEXBASE64_H
+#define HEXBASE64_H
+
+#include <string>
+#include <cstddef>
+
+/*
+   Кодирование hex и base64 без промежуточных QByteArray и QString.
+   Функции дописывают результат в конец result, так что строку можно собирать по частям без лишних копий.
+   Основной цикл выбирается один раз по возможностям процессора: AVX2, SSSE3 или переносимая реализация.
+ */
+
+// Строчные буквы, как у QByteArray::toHex
+void appendToHex(const char *data, size_t size, std::string &result);
+
+// Как QByteArray::fromHex: не hex символы пропускаются, при нечетном числе hex символов первый байт получается из одного символа
+void appendFromHex(const char *data, size_t size, std::string &result);
+
+/*
+   Строгий разбор: при не hex символе возвращает false и оставляет result без изменений.
+   Нечетная длина допускается, первый символ тогда дает младший полубайт первого байта
+ */
+bool appendFromHexStrict(const char *data, size_t size, std::string &result);
+
+// С дополнением '=', как у QByteArray::toBase64
+void appendToBase64(const char *data, size_t size, std::string &result);
+
+// Как QByteArray::fromBase64: символы вне алфавита, в том числе '=', пропускаются
+void appendFromBase64(const char *data, size_t size, std::string &result);
+
+bool isHexBase64Accelerated();
+
+#endif // HEXBASE64_H
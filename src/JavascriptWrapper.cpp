@@ -23,6 +23,8 @@ using namespace std::placeholders;
 #include "WalletRsa.h"
 #include "EthWallet.h"
 #include "BtcWallet.h"
+#include "btctx/CoinSelection.h"
+#include "btctx/wif.h"
 
 #include "mainwindow.h"
 
@@ -42,6 +44,7 @@ using namespace std::placeholders;
 #include "makeJsFunc.h"
 #include "qrcoder.h"
 #include "QRegister.h"
+#include "BatchTransactions.h"
 
 #include "Module.h"
 
@@ -114,6 +117,7 @@ JavascriptWrapper::JavascriptWrapper(MainWindow &mainWindow, WebSocketClient &ws
     , nsLookup(nsLookup)
     , transactionsManager(transactionsManager)
     , applicationVersion(applicationVersion)
+    , unlockedWalletsTimer(this)
 {
     hardwareId = QString::fromStdString(::getMachineUid());
     utmData = QString::fromLatin1(getUtmData());
@@ -133,6 +137,9 @@ JavascriptWrapper::JavascriptWrapper(MainWindow &mainWindow, WebSocketClient &ws
 
     CHECK(connect(this, &JavascriptWrapper::getListWallets, this, &JavascriptWrapper::onGetListWallets), "not connect onGetListWallets");
 
+    CHECK(connect(&unlockedWalletsTimer, &QTimer::timeout, this, &JavascriptWrapper::onResetUnlockedWallets), "not connect onResetUnlockedWallets");
+    unlockedWalletsTimer.setInterval(milliseconds(1s).count());
+
     Q_REG2(TypedException, "TypedException", false);
     Q_REG(JavascriptWrapper::ReturnCallback, "JavascriptWrapper::ReturnCallback");
     Q_REG(WalletsListCallback, "WalletsListCallback");
@@ -152,19 +159,19 @@ BEGIN_SLOT_WRAPPER
     std::vector<QString> result;
     const TypedException &exception = apiVrapper2([&]{
         if (type == WalletType::Tmh) {
-            const std::vector<std::pair<QString, QString>> res = Wallet::getAllWalletsInFolder(walletPathTmh);
+            const std::vector<std::pair<QString, QString>> res = walletsIndex.get(walletPathTmh, &Wallet::getAllWalletsInFolder);
             result.reserve(res.size());
             std::transform(res.begin(), res.end(), std::back_inserter(result), std::mem_fn(&std::pair<QString, QString>::first));
         } else if (type == WalletType::Mth) {
-            const std::vector<std::pair<QString, QString>> res = Wallet::getAllWalletsInFolder(walletPathMth);
+            const std::vector<std::pair<QString, QString>> res = walletsIndex.get(walletPathMth, &Wallet::getAllWalletsInFolder);
             result.reserve(res.size());
             std::transform(res.begin(), res.end(), std::back_inserter(result), std::mem_fn(&std::pair<QString, QString>::first));
         } else if (type == WalletType::Btc) {
-            const std::vector<std::pair<QString, QString>> res = BtcWallet::getAllWalletsInFolder(walletPathBtc);
+            const std::vector<std::pair<QString, QString>> res = walletsIndex.get(walletPathBtc, &BtcWallet::getAllWalletsInFolder);
             result.reserve(res.size());
             std::transform(res.begin(), res.end(), std::back_inserter(result), std::mem_fn(&std::pair<QString, QString>::first));
         } else if (type == WalletType::Eth) {
-            const std::vector<std::pair<QString, QString>> res = EthWallet::getAllWalletsInFolder(walletPathEth);
+            const std::vector<std::pair<QString, QString>> res = walletsIndex.get(walletPathEth, &EthWallet::getAllWalletsInFolder);
             result.reserve(res.size());
             std::transform(res.begin(), res.end(), std::back_inserter(result), std::mem_fn(&std::pair<QString, QString>::first));
         } else {
@@ -211,10 +218,10 @@ void JavascriptWrapper::sendAppInfoToWss(QString userName, bool force) {
     const QString newUserName = userName;
     if (force || newUserName != sendedUserName) {
         std::vector<QString> keysTmh;
-        const std::vector<std::pair<QString, QString>> keys1 = Wallet::getAllWalletsInFolder(walletPathTmh);
+        const std::vector<std::pair<QString, QString>> keys1 = walletsIndex.get(walletPathTmh, &Wallet::getAllWalletsInFolder);
         std::transform(keys1.begin(), keys1.end(), std::back_inserter(keysTmh), [](const auto &pair) {return pair.first;});
         std::vector<QString> keysMth;
-        const std::vector<std::pair<QString, QString>> keys2 = Wallet::getAllWalletsInFolder(walletPathMth);
+        const std::vector<std::pair<QString, QString>> keys2 = walletsIndex.get(walletPathMth, &Wallet::getAllWalletsInFolder);
         std::transform(keys2.begin(), keys2.end(), std::back_inserter(keysMth), [](const auto &pair) {return pair.first;});
 
         const QString message = makeMessageApplicationForWss(hardwareId, utmData, newUserName, applicationVersion, mainWindow.getCurrentHtmls().lastVersion, keysTmh, keysMth);
@@ -384,6 +391,54 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void JavascriptWrapper::unlockWallet(QString requestId, QString keyName, QString password, int timeSeconds) {
+BEGIN_SLOT_WRAPPER
+    unlockWalletMTHS(requestId, keyName, password, timeSeconds, walletPathTmh, "unlockWalletResultJs");
+END_SLOT_WRAPPER
+}
+
+void JavascriptWrapper::lockWallet(QString requestId, QString keyName) {
+BEGIN_SLOT_WRAPPER
+    lockWalletMTHS(requestId, keyName, walletPathTmh, "lockWalletResultJs");
+END_SLOT_WRAPPER
+}
+
+void JavascriptWrapper::remainingTimeWallet(QString requestId, QString keyName) {
+BEGIN_SLOT_WRAPPER
+    remainingTimeWalletMTHS(requestId, keyName, walletPathTmh, "remainingTimeWalletResultJs");
+END_SLOT_WRAPPER
+}
+
+void JavascriptWrapper::unlockWalletMHC(QString requestId, QString keyName, QString password, int timeSeconds) {
+BEGIN_SLOT_WRAPPER
+    unlockWalletMTHS(requestId, keyName, password, timeSeconds, walletPathMth, "unlockWalletMHCResultJs");
+END_SLOT_WRAPPER
+}
+
+void JavascriptWrapper::lockWalletMHC(QString requestId, QString keyName) {
+BEGIN_SLOT_WRAPPER
+    lockWalletMTHS(requestId, keyName, walletPathMth, "lockWalletMHCResultJs");
+END_SLOT_WRAPPER
+}
+
+void JavascriptWrapper::remainingTimeWalletMHC(QString requestId, QString keyName) {
+BEGIN_SLOT_WRAPPER
+    remainingTimeWalletMTHS(requestId, keyName, walletPathMth, "remainingTimeWalletMHCResultJs");
+END_SLOT_WRAPPER
+}
+
+void JavascriptWrapper::signMessagesBatch(QString requestId, QString keyName, QString password, QString jsonTransactions) {
+BEGIN_SLOT_WRAPPER
+    signMessagesBatchMTHS(requestId, keyName, password, jsonTransactions, walletPathTmh, "signMessagesBatchResultJs");
+END_SLOT_WRAPPER
+}
+
+void JavascriptWrapper::signMessagesBatchMHC(QString requestId, QString keyName, QString password, QString jsonTransactions) {
+BEGIN_SLOT_WRAPPER
+    signMessagesBatchMTHS(requestId, keyName, password, jsonTransactions, walletPathMth, "signMessagesBatchMHCResultJs");
+END_SLOT_WRAPPER
+}
+
 void JavascriptWrapper::signMessageMHC(QString requestId, QString keyName, QString text, QString password) {
 BEGIN_SLOT_WRAPPER
     signMessageMTHS(requestId, keyName, text, password, walletPathMth, "signMessageMHCResultJs");
@@ -426,7 +481,7 @@ static QString makeJsonWalletsAndPaths(const std::vector<std::pair<QString, QStr
 QString JavascriptWrapper::getAllMTHSWalletsAndPathsJson(QString walletPath, QString name) {
     try {
         CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = Wallet::getAllWalletsInFolder(walletPath);
+        const std::vector<std::pair<QString, QString>> result = walletsIndex.get(walletPath, &Wallet::getAllWalletsInFolder);
         const QString jsonStr = makeJsonWalletsAndPaths(result);
         LOG << PeriodicLog::make("w2_" + name.toStdString()) << "get " << name << " wallets json " << jsonStr << " " << walletPath;
         return jsonStr;
@@ -442,7 +497,7 @@ QString JavascriptWrapper::getAllMTHSWalletsAndPathsJson(QString walletPath, QSt
 QString JavascriptWrapper::getAllMTHSWalletsJson(QString walletPath, QString name) {
     try {
         CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = Wallet::getAllWalletsInFolder(walletPath);
+        const std::vector<std::pair<QString, QString>> result = walletsIndex.get(walletPath, &Wallet::getAllWalletsInFolder);
         const QString jsonStr = makeJsonWallets(result);
         LOG << PeriodicLog::make("w_" + name.toStdString()) << "get " << name << " wallets json " << jsonStr << " " << walletPath;
         return jsonStr;
@@ -485,9 +540,9 @@ void JavascriptWrapper::signMessageMTHS(QString requestId, QString keyName, QStr
     Opt<std::string> publicKey;
     const TypedException exception = apiVrapper2([&, this]() {
         CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        Wallet wallet(walletPath, keyName.toStdString(), password.toStdString());
+        const std::shared_ptr<Wallet> wallet = getWallet(walletPath, keyName, password);
         std::string pubKey;
-        signature = wallet.sign(textStr, pubKey);
+        signature = wallet->sign(textStr, pubKey);
         publicKey = pubKey;
     });
 
@@ -506,7 +561,7 @@ void JavascriptWrapper::signMessageMTHS(QString requestId, QString keyName, QStr
     Opt<std::string> signature2;
     const TypedException exception = apiVrapper2([&, this]() {
         CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
-        Wallet wallet(walletPath, keyName.toStdString(), password.toStdString());
+        const std::shared_ptr<Wallet> wallet = getWallet(walletPath, keyName, password);
         std::string publicKey;
         std::string tx;
         std::string signature;
@@ -517,7 +572,7 @@ void JavascriptWrapper::signMessageMTHS(QString requestId, QString keyName, QStr
         CHECK(tmp, "Fee not valid");
         const uint64_t nonceInt = nonce.toULongLong(&tmp, 10);
         CHECK(tmp, "Nonce not valid");
-        wallet.sign(toAddress.toStdString(), valueInt, feeInt, nonceInt, dataHex.toStdString(), tx, signature, publicKey);
+        wallet->sign(toAddress.toStdString(), valueInt, feeInt, nonceInt, dataHex.toStdString(), tx, signature, publicKey);
         publicKey2 = publicKey;
         tx2 = tx;
         signature2 = signature;
@@ -528,6 +583,24 @@ void JavascriptWrapper::signMessageMTHS(QString requestId, QString keyName, QStr
     makeAndRunJsFuncParams(jsNameResult, exception, Opt<QString>(requestId), signature2, publicKey2, tx2);
 }
 
+void JavascriptWrapper::signMessagesBatchMTHS(QString requestId, QString keyName, QString password, QString jsonTransactions, QString walletPath, QString jsNameResult) {
+    LOG << "Sign messages batch " << requestId << " " << keyName;
+
+    Opt<QJsonDocument> result;
+    const TypedException exception = apiVrapper2([&, this]() {
+        CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
+        const std::vector<BatchTransaction> transactions = parseBatchTransactions(jsonTransactions);
+        const std::shared_ptr<Wallet> wallet = getWallet(walletPath, keyName, password);
+
+        const std::vector<BatchSignature> signatures = signBatchTransactions(*wallet, transactions);
+        result = makeJsonBatchSignatures(signatures);
+
+        LOG << "Sign messages batch ok " << keyName << " " << signatures.size();
+    });
+
+    makeAndRunJsFuncParams(jsNameResult, exception, Opt<QString>(requestId), result);
+}
+
 void JavascriptWrapper::createV8AddressImpl(QString requestId, const QString jsNameResult, QString address, int nonce) {
     Opt<QString> result;
     const TypedException exception = apiVrapper2([&, this]() {
@@ -536,6 +609,82 @@ void JavascriptWrapper::createV8AddressImpl(QString requestId, const QString jsN
     makeAndRunJsFuncParams(jsNameResult, exception, Opt<QString>(requestId), result);
 }
 
+std::shared_ptr<Wallet> JavascriptWrapper::getWallet(const QString &walletPath, const QString &keyName, const QString &password) {
+    const auto found = unlockedWallets.find(Wallet::makeFullWalletPath(walletPath, keyName.toStdString()));
+    if (found != unlockedWallets.end()) {
+        if (::now() - found->second.startTime < found->second.time) {
+            return found->second.wallet;
+        }
+        unlockedWallets.erase(found);
+    }
+    return std::make_shared<Wallet>(walletPath, keyName.toStdString(), password.toStdString());
+}
+
+void JavascriptWrapper::unlockWalletMTHS(QString requestId, QString keyName, QString password, int timeSeconds, QString walletPath, QString jsNameResult) {
+    LOG << "Unlock wallet " << requestId << " " << keyName << " timeout " << timeSeconds;
+
+    Opt<QString> result;
+    const TypedException exception = apiVrapper2([&, this]() {
+        CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
+        CHECK_TYPED(timeSeconds > 0, TypeErrors::INCORRECT_USER_DATA, "Incorrect time " + std::to_string(timeSeconds));
+        const std::shared_ptr<Wallet> wallet = std::make_shared<Wallet>(walletPath, keyName.toStdString(), password.toStdString());
+        const QString fullPath = wallet->getFullPath();
+        unlockedWallets[fullPath] = UnlockedWallet{wallet, ::now(), seconds(timeSeconds)};
+        if (!unlockedWalletsTimer.isActive()) {
+            unlockedWalletsTimer.start();
+        }
+        result = "Ok";
+    });
+
+    makeAndRunJsFuncParams(jsNameResult, exception, Opt<QString>(requestId), result);
+}
+
+void JavascriptWrapper::lockWalletMTHS(QString requestId, QString keyName, QString walletPath, QString jsNameResult) {
+    LOG << "Lock wallet " << requestId << " " << keyName;
+
+    Opt<QString> result;
+    const TypedException exception = apiVrapper2([&, this]() {
+        CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
+        unlockedWallets.erase(Wallet::makeFullWalletPath(walletPath, keyName.toStdString()));
+        result = "Ok";
+    });
+
+    makeAndRunJsFuncParams(jsNameResult, exception, Opt<QString>(requestId), result);
+}
+
+void JavascriptWrapper::remainingTimeWalletMTHS(QString requestId, QString keyName, QString walletPath, QString jsNameResult) {
+    Opt<int> result;
+    const TypedException exception = apiVrapper2([&, this]() {
+        CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
+        const auto found = unlockedWallets.find(Wallet::makeFullWalletPath(walletPath, keyName.toStdString()));
+        seconds remaining(0);
+        if (found != unlockedWallets.end()) {
+            const seconds elapsed = std::chrono::duration_cast<seconds>(::now() - found->second.startTime);
+            remaining = std::max(found->second.time - elapsed, seconds(0));
+        }
+        result = static_cast<int>(remaining.count());
+    });
+
+    makeAndRunJsFuncParams(jsNameResult, exception, Opt<QString>(requestId), result);
+}
+
+void JavascriptWrapper::onResetUnlockedWallets() {
+BEGIN_SLOT_WRAPPER
+    const time_point now = ::now();
+    for (auto iter = unlockedWallets.begin(); iter != unlockedWallets.end();) {
+        if (now - iter->second.startTime >= iter->second.time) {
+            LOG << "Reseted wallet " << iter->second.wallet->getAddress();
+            iter = unlockedWallets.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    if (unlockedWallets.empty()) {
+        unlockedWalletsTimer.stop();
+    }
+END_SLOT_WRAPPER
+}
+
 void JavascriptWrapper::signMessageMTHSWithTxManager(const QString &requestId, const QString &walletPath, const QString jsNameResult, const QString &nonce, const QString &keyName, const QString &password, const QString &paramsJson, const std::function<void(size_t nonce)> &signTransaction) {
     const TypedException exception = apiVrapper2([&, this]() {
         const transactions::SendParameters sendParams = transactions::parseSendParams(paramsJson);
@@ -548,8 +697,8 @@ void JavascriptWrapper::signMessageMTHSWithTxManager(const QString &requestId, c
 
         const bool isNonce = !nonce.isEmpty();
         if (!isNonce) {
-            Wallet wallet(walletPath, keyName.toStdString(), password.toStdString());
-            emit transactionsManager.getNonce(requestId, QString::fromStdString(wallet.getAddress()), sendParams, transactions::Transactions::GetNonceCallback([this, jsNameResult, requestId, signTransaction, keyName](size_t nonce, const QString &serverError) {
+            const std::shared_ptr<Wallet> wallet = getWallet(walletPath, keyName, password);
+            emit transactionsManager.getNonce(requestId, QString::fromStdString(wallet->getAddress()), sendParams, transactions::Transactions::GetNonceCallback([this, jsNameResult, requestId, signTransaction, keyName](size_t nonce, const QString &serverError) {
                 LOG << "Nonce getted " << keyName << " " << nonce << " " << serverError;
                 signTransaction(nonce);
             }, errorFunc, std::bind(&JavascriptWrapper::callbackCall, this, _1)));
@@ -576,7 +725,7 @@ void JavascriptWrapper::signMessageMTHSV3(QString requestId, QString keyName, QS
     }
 
     const auto signTransaction = [this, requestId, walletPath, keyName, password, toAddress, value, fee, dataHex, sendParams, jsNameResult](size_t nonce) {
-        Wallet wallet(walletPath, keyName.toStdString(), password.toStdString());
+        const std::shared_ptr<Wallet> wallet = getWallet(walletPath, keyName, password);
         std::string publicKey;
         std::string tx;
         std::string signature;
@@ -585,7 +734,7 @@ void JavascriptWrapper::signMessageMTHSV3(QString requestId, QString keyName, QS
         CHECK(tmp, "Value not valid");
         const uint64_t feeInt = fee.toULongLong(&tmp, 10);
         CHECK(tmp, "Fee not valid");
-        wallet.sign(toAddress.toStdString(), valueInt, feeInt, nonce, dataHex.toStdString(), tx, signature, publicKey);
+        wallet->sign(toAddress.toStdString(), valueInt, feeInt, nonce, dataHex.toStdString(), tx, signature, publicKey);
 
         emit transactionsManager.sendTransaction(requestId, toAddress, value, nonce, dataHex, fee, QString::fromStdString(publicKey), QString::fromStdString(signature), sendParams, transactions::Transactions::SendTransactionCallback([this, jsNameResult, requestId, keyName](){
             LOG << "Sign messagev3 ok " << keyName;
@@ -607,7 +756,7 @@ void JavascriptWrapper::signMessageDelegateMTHS(QString requestId, QString keyNa
     }
 
     const auto signTransaction = [this, requestId, walletPath, password, toAddress, value, fee, valueDelegate, isDelegate, sendParams, jsNameResult, keyName](size_t nonce) {
-        Wallet wallet(walletPath, keyName.toStdString(), password.toStdString());
+        const std::shared_ptr<Wallet> wallet = getWallet(walletPath, keyName, password);
 
         bool isValid;
         const uint64_t delegValue = valueDelegate.toULongLong(&isValid);
@@ -622,7 +771,7 @@ void JavascriptWrapper::signMessageDelegateMTHS(QString requestId, QString keyNa
         CHECK(tmp, "Value not valid");
         const uint64_t feeInt = fee.toULongLong(&tmp, 10);
         CHECK(tmp, "Fee not valid");
-        wallet.sign(toAddress.toStdString(), valueInt, feeInt, nonce, dataHex, tx, signature, publicKey, false);
+        wallet->sign(toAddress.toStdString(), valueInt, feeInt, nonce, dataHex, tx, signature, publicKey, false);
 
         emit transactionsManager.sendTransaction(requestId, toAddress, value, nonce, QString::fromStdString(dataHex), fee, QString::fromStdString(publicKey), QString::fromStdString(signature), sendParams, transactions::Transactions::SendTransactionCallback([this, jsNameResult, requestId, keyName](){
             LOG << "Sign message delegate ok " << keyName;
@@ -1003,7 +1152,7 @@ END_SLOT_WRAPPER
 QString JavascriptWrapper::getAllEthWalletsJson() {
     try {
         CHECK(!walletPathEth.isNull() && !walletPathEth.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = EthWallet::getAllWalletsInFolder(walletPathEth);
+        const std::vector<std::pair<QString, QString>> result = walletsIndex.get(walletPathEth, &EthWallet::getAllWalletsInFolder);
         const QString jsonStr = makeJsonWallets(result);
         LOG << PeriodicLog::make("w_eth") << "get eth wallets json " << jsonStr;
         return jsonStr;
@@ -1019,7 +1168,7 @@ QString JavascriptWrapper::getAllEthWalletsJson() {
 QString JavascriptWrapper::getAllEthWalletsAndPathsJson() {
     try {
         CHECK(!walletPathEth.isNull() && !walletPathEth.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = EthWallet::getAllWalletsInFolder(walletPathEth);
+        const std::vector<std::pair<QString, QString>> result = walletsIndex.get(walletPathEth, &EthWallet::getAllWalletsInFolder);
         const QString jsonStr = makeJsonWalletsAndPaths(result);
         LOG << PeriodicLog::make("w2_eth") << "get eth wallets json " << jsonStr;
         return jsonStr;
@@ -1234,6 +1383,67 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void JavascriptWrapper::selectCoinsBtc(QString requestId, QString jsonInputs, QString toAddress, QString value, QString estimateComissionInSatoshi, QString jsonUsedUtxos) {
+BEGIN_SLOT_WRAPPER
+    const QString JS_NAME_RESULT = "selectCoinsBtcResultJs";
+
+    LOG << "Select coins btc " << toAddress << " " << value << " " << estimateComissionInSatoshi;
+
+    Opt<QJsonDocument> jsonSelected;
+    Opt<QString> fee;
+    Opt<QString> change;
+    const TypedException exception = apiVrapper2([&, this]() {
+        CHECK_TYPED(isDecimal(value.toStdString()), TypeErrors::INCORRECT_USER_DATA, "Not dec number value");
+        CHECK_TYPED(isDecimal(estimateComissionInSatoshi.toStdString()), TypeErrors::INCORRECT_USER_DATA, "Not dec number estimateComissionInSatoshi");
+
+        std::set<QString> usedUtxos;
+        const QJsonDocument documentUsed = QJsonDocument::fromJson(jsonUsedUtxos.toUtf8());
+        CHECK(documentUsed.isArray(), "jsonUsedUtxos not array");
+        for (const auto &jsonUsedUtxo: documentUsed.array()) {
+            CHECK(jsonUsedUtxo.isString(), "value field not found");
+            usedUtxos.insert(jsonUsedUtxo.toString());
+        }
+
+        const QJsonDocument document = QJsonDocument::fromJson(jsonInputs.toUtf8());
+        CHECK(document.isArray(), "jsonInputs not array");
+        std::vector<QJsonObject> inputs;
+        std::vector<uint64_t> values;
+        for (const auto &jsonObj2: document.array()) {
+            const QJsonObject jsonObj = jsonObj2.toObject();
+            CHECK(jsonObj.contains("tx_hash") && jsonObj.value("tx_hash").isString(), "tx_hash field not found");
+            if (usedUtxos.find(jsonObj.value("tx_hash").toString()) != usedUtxos.end()) {
+                continue;
+            }
+            CHECK(jsonObj.contains("value") && jsonObj.value("value").isString(), "value field not found");
+            bool isValid;
+            const uint64_t outBalance = jsonObj.value("value").toString().toULongLong(&isValid);
+            CHECK(isValid, "Out balance not valid");
+            inputs.emplace_back(jsonObj);
+            values.emplace_back(outBalance);
+        }
+
+        const std::string outputScript = AddressToPubkeyScript(toAddress.toStdString());
+        // Кошельки создаются со сжатыми ключами
+        CoinSelectionParams params = makeP2pkhCoinSelectionParams(std::stoull(value.toStdString()), std::stoull(estimateComissionInSatoshi.toStdString()), values.size(), outputScript.size(), true);
+        // BtcWallet::buildTransaction не опускает комиссию ниже размера транзакции + 30
+        params.isMinFeeBySize = true;
+        params.minFeeOverSize = 30;
+        const CoinSelectionResult selected = selectCoins(values, params);
+        LOG << "Selected utxos " << selected.indexes.size() << " of " << values.size() << ", fee " << selected.fee;
+
+        QJsonArray jsonArraySelected;
+        for (const size_t index: selected.indexes) {
+            jsonArraySelected.push_back(inputs[index]);
+        }
+        jsonSelected = QJsonDocument(jsonArraySelected);
+        fee = QString::number(selected.fee);
+        change = QString::number(selected.change);
+    });
+
+    makeAndRunJsFuncParams(JS_NAME_RESULT, exception, Opt<QString>(requestId), jsonSelected, fee, change);
+END_SLOT_WRAPPER
+}
+
 // deprecated
 void JavascriptWrapper::signMessageBtc(QString requestId, QString address, QString jsonInputs, QString toAddress, QString value, QString estimateComissionInSatoshi, QString fees) {
 BEGIN_SLOT_WRAPPER
@@ -1244,7 +1454,7 @@ END_SLOT_WRAPPER
 QString JavascriptWrapper::getAllBtcWalletsJson() {
     try {
         CHECK(!walletPathBtc.isNull() && !walletPathBtc.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = BtcWallet::getAllWalletsInFolder(walletPathBtc);
+        const std::vector<std::pair<QString, QString>> result = walletsIndex.get(walletPathBtc, &BtcWallet::getAllWalletsInFolder);
         const QString jsonStr = makeJsonWallets(result);
         LOG << PeriodicLog::make("w_btc") << "get btc wallets json " << jsonStr;
         return jsonStr;
@@ -1260,7 +1470,7 @@ QString JavascriptWrapper::getAllBtcWalletsJson() {
 QString JavascriptWrapper::getAllBtcWalletsAndPathsJson() {
     try {
         CHECK(!walletPathBtc.isNull() && !walletPathBtc.isEmpty(), "Incorrect path to wallet: empty");
-        const std::vector<std::pair<QString, QString>> result = BtcWallet::getAllWalletsInFolder(walletPathBtc);
+        const std::vector<std::pair<QString, QString>> result = walletsIndex.get(walletPathBtc, &BtcWallet::getAllWalletsInFolder);
         const QString jsonStr = makeJsonWalletsAndPaths(result);
         LOG << PeriodicLog::make("w2_btc") << "get btc wallets json " << jsonStr;
         return jsonStr;
@@ -1388,22 +1598,26 @@ void JavascriptWrapper::setPathsImpl(QString newPatch, QString newUserName) {
     CHECK(!walletPath.isNull() && !walletPath.isEmpty(), "Incorrect path to wallet: empty");
     createFolder(walletPath);
 
+    unlockedWallets.clear();
+
     for (const FolderWalletInfo &folderInfo: folderWalletsInfos) {
         fileSystemWatcher.removePath(folderInfo.walletPath.absolutePath());
     }
     folderWalletsInfos.clear();
+    walletsIndex.clear();
 
-    auto setPathToWallet = [this](QString &curPath, const QString &suffix, const QString &name) {
+    auto setPathToWallet = [this](QString &curPath, const QString &suffix, const QString &name, const WalletsIndex::ListFunc &listFunc) {
         curPath = makePath(walletPath, suffix);
         createFolder(curPath);
-        folderWalletsInfos.emplace_back(curPath, name);
+        folderWalletsInfos.emplace_back(curPath, name, listFunc);
         fileSystemWatcher.addPath(curPath);
+        walletsIndex.addFolder(curPath);
     };
 
-    setPathToWallet(walletPathEth, WALLET_PATH_ETH, "eth");
-    setPathToWallet(walletPathBtc, WALLET_PATH_BTC, "btc");
-    setPathToWallet(walletPathMth, Wallet::WALLET_PATH_MTH, "mhc");
-    setPathToWallet(walletPathTmh, WALLET_PATH_TMH, "tmh");
+    setPathToWallet(walletPathEth, WALLET_PATH_ETH, "eth", &EthWallet::getAllWalletsInFolder);
+    setPathToWallet(walletPathBtc, WALLET_PATH_BTC, "btc", &BtcWallet::getAllWalletsInFolder);
+    setPathToWallet(walletPathMth, Wallet::WALLET_PATH_MTH, "mhc", &Wallet::getAllWalletsInFolder);
+    setPathToWallet(walletPathTmh, WALLET_PATH_TMH, "tmh", &Wallet::getAllWalletsInFolder);
 
     walletPathOldTmh = makePath(walletPath, WALLET_PATH_TMH_OLD);
     LOG << "Wallets path " << walletPath;
@@ -1704,11 +1918,25 @@ END_SLOT_WRAPPER
 void JavascriptWrapper::onDirChanged(const QString &dir) {
 BEGIN_SLOT_WRAPPER
     const QString JS_NAME_RESULT = "directoryChangedResultJs";
+    const QString JS_NAME_RESULT_WALLETS = "walletsChangedResultJs";
     const QDir d(dir);
     for (const FolderWalletInfo &folderInfo: folderWalletsInfos) {
         if (folderInfo.walletPath == d) {
             LOG << "folder changed " << folderInfo.nameWallet << " " << d.absolutePath();
             makeAndRunJsFuncParams(JS_NAME_RESULT, TypedException(), Opt<QString>(d.absolutePath()), Opt<QString>(folderInfo.nameWallet));
+
+            // Список кошельков сообщается только при его изменении, а не на любое изменение файлов в папке
+            Opt<QString> walletsJson;
+            const TypedException exception = apiVrapper2([&, this]() {
+                WalletsIndex::Wallets wallets;
+                if (walletsIndex.refresh(dir, folderInfo.listFunc, wallets)) {
+                    walletsJson = makeJsonWallets(wallets);
+                }
+            });
+            if (exception.isSet() || walletsJson.isSet) {
+                LOG << "wallets changed " << folderInfo.nameWallet;
+                makeAndRunJsFuncParams(JS_NAME_RESULT_WALLETS, exception, Opt<QString>(d.absolutePath()), Opt<QString>(folderInfo.nameWallet), walletsJson);
+            }
         }
     }
 END_SLOT_WRAPPER
@@ -5,17 +5,24 @@
 #include <QString>
 #include <QFileSystemWatcher>
 #include <QDir>
+#include <QTimer>
+
+#include <map>
+#include <memory>
 
 #include "uploader.h"
 
 #include "client.h"
 
 #include "CallbackWrapper.h"
+#include "duration.h"
+#include "WalletsIndex.h"
 
 class NsLookup;
 class WebSocketClient;
 struct TypedException;
 class MainWindow;
+class Wallet;
 
 namespace transactions {
 class Transactions;
@@ -102,6 +109,8 @@ public slots:
 
     Q_INVOKABLE void signMessageUnDelegate(QString requestId, QString keyName, QString password, QString toAddress, QString value, QString fee, QString nonce, QString valueDelegate, QString paramsJson);
 
+    Q_INVOKABLE void signMessagesBatch(QString requestId, QString keyName, QString password, QString jsonTransactions);
+
     Q_INVOKABLE void getOnePrivateKey(QString requestId, QString keyName, bool isCompact);
 
     Q_INVOKABLE void saveRawPrivKey(QString requestId, QString rawPrivKey, QString password);
@@ -110,6 +119,12 @@ public slots:
 
     Q_INVOKABLE void createV8Address(QString requestId, QString address, int nonce);
 
+    Q_INVOKABLE void unlockWallet(QString requestId, QString keyName, QString password, int timeSeconds);
+
+    Q_INVOKABLE void lockWallet(QString requestId, QString keyName);
+
+    Q_INVOKABLE void remainingTimeWallet(QString requestId, QString keyName);
+
 public slots:
 
     Q_INVOKABLE void createWalletMHC(QString requestId, QString password);
@@ -130,6 +145,8 @@ public slots:
 
     Q_INVOKABLE void signMessageMHCUnDelegate(QString requestId, QString keyName, QString password, QString toAddress, QString value, QString fee, QString nonce, QString valueDelegate, QString paramsJson);
 
+    Q_INVOKABLE void signMessagesBatchMHC(QString requestId, QString keyName, QString password, QString jsonTransactions);
+
     Q_INVOKABLE void getOnePrivateKeyMHC(QString requestId, QString keyName, bool isCompact);
 
     Q_INVOKABLE void saveRawPrivKeyMHC(QString requestId, QString rawPrivKey, QString password);
@@ -138,6 +155,12 @@ public slots:
 
     Q_INVOKABLE void createV8AddressMHC(QString requestId, QString address, int nonce);
 
+    Q_INVOKABLE void unlockWalletMHC(QString requestId, QString keyName, QString password, int timeSeconds);
+
+    Q_INVOKABLE void lockWalletMHC(QString requestId, QString keyName);
+
+    Q_INVOKABLE void remainingTimeWalletMHC(QString requestId, QString keyName);
+
 public slots:
 
     Q_INVOKABLE void createRsaKey(QString requestId, QString address, QString password);
@@ -190,6 +213,8 @@ public slots:
 
     Q_INVOKABLE void signMessageBtcPswdUsedUtxos(QString requestId, QString address, QString password, QString jsonInputs, QString toAddress, QString value, QString estimateComissionInSatoshi, QString fees, QString jsonUsedUtxos);
 
+    Q_INVOKABLE void selectCoinsBtc(QString requestId, QString jsonInputs, QString toAddress, QString value, QString estimateComissionInSatoshi, QString jsonUsedUtxos);
+
     Q_INVOKABLE QString getAllBtcWalletsJson();
 
     Q_INVOKABLE QString getAllBtcWalletsAndPathsJson();
@@ -266,6 +291,8 @@ private slots:
 
     void onSendCommandLineMessageToWss(const QString &hardwareId, const QString &userId, size_t focusCount, const QString &line, bool isEnter, bool isUserText);
 
+    void onResetUnlockedWallets();
+
 private:
 
     void createRsaKeyMTHS(QString requestId, QString address, QString password, QString walletPath, QString jsNameResult);
@@ -312,10 +339,20 @@ private:
 
     void signMessageDelegateMTHS(QString requestId, QString keyName, QString password, QString toAddress, QString value, QString fee, QString nonce, QString valueDelegate, bool isDelegate, QString paramsJson, QString walletPath, QString jsNameResult);
 
+    void signMessagesBatchMTHS(QString requestId, QString keyName, QString password, QString jsonTransactions, QString walletPath, QString jsNameResult);
+
     void signMessageMTHSWithTxManager(const QString &requestId, const QString &walletPath, const QString jsNameResult, const QString &nonce, const QString &keyName, const QString &password, const QString &paramsJson, const std::function<void(size_t nonce)> &signTransaction);
 
     void createV8AddressImpl(QString requestId, const QString jsNameResult, QString address, int nonce);
 
+    void unlockWalletMTHS(QString requestId, QString keyName, QString password, int timeSeconds, QString walletPath, QString jsNameResult);
+
+    void lockWalletMTHS(QString requestId, QString keyName, QString walletPath, QString jsNameResult);
+
+    void remainingTimeWalletMTHS(QString requestId, QString keyName, QString walletPath, QString jsNameResult);
+
+    std::shared_ptr<Wallet> getWallet(const QString &walletPath, const QString &keyName, const QString &password);
+
     template<typename... Args>
     void makeAndRunJsFuncParams(const QString &function, const QString &lastArg, const TypedException &exception, Args&& ...args);
 
@@ -375,10 +412,12 @@ private:
     struct FolderWalletInfo {
         QDir walletPath;
         QString nameWallet;
+        WalletsIndex::ListFunc listFunc;
 
-        FolderWalletInfo(const QDir &walletPath, const QString &nameWallet)
+        FolderWalletInfo(const QDir &walletPath, const QString &nameWallet, const WalletsIndex::ListFunc &listFunc)
             : walletPath(walletPath)
             , nameWallet(nameWallet)
+            , listFunc(listFunc)
         {}
     };
 
@@ -386,6 +425,19 @@ private:
 
     QFileSystemWatcher fileSystemWatcher;
 
+    WalletsIndex walletsIndex;
+
+    struct UnlockedWallet {
+        std::shared_ptr<Wallet> wallet;
+        time_point startTime;
+        seconds time;
+    };
+
+    // Ключ - полный путь к файлу кошелька
+    std::map<QString, UnlockedWallet> unlockedWallets;
+
+    QTimer unlockedWalletsTimer;
+
 };
 
 #endif // JAVASCRIPTWRAPPER_H
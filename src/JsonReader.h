@@ -0,0 +1,259 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "check.h"
+
+/*
+   Потоковое чтение json без построения дерева.
+   Char - единица кодировки входной строки (для QString - ushort, UTF-16).
+   Строки без escape последовательностей отдаются как указатели на исходный буфер.
+ */
+template<typename Char>
+class JsonReader {
+public:
+
+    struct Span {
+        const Char *begin = nullptr;
+        const Char *end = nullptr;
+
+        size_t size() const {
+            return end - begin;
+        }
+
+        bool operator==(const char *str) const {
+            const Char *c = begin;
+            for (; c != end && *str != 0; c++, str++) {
+                if (static_cast<uint32_t>(*c) != static_cast<unsigned char>(*str)) {
+                    return false;
+                }
+            }
+            return c == end && *str == 0;
+        }
+    };
+
+public:
+
+    JsonReader(const Char *begin, const Char *end)
+        : pos(begin)
+        , end(end)
+    {}
+
+    void beginObject() {
+        expect('{');
+        isFirstItem = true;
+    }
+
+    /*
+       Переходит к следующему ключу объекта. Возвращает false, если объект закончился.
+       Ключ с escape последовательностями раскодируется во внутренний буфер, key действителен до следующего вызова nextKey
+     */
+    bool nextKey(Span &key) {
+        if (!nextItem('}')) {
+            return false;
+        }
+        if (!readString(key, decodedKey)) {
+            key.begin = decodedKey.data();
+            key.end = decodedKey.data() + decodedKey.size();
+        }
+        expect(':');
+        return true;
+    }
+
+    void beginArray() {
+        expect('[');
+        isFirstItem = true;
+    }
+
+    // Переходит к следующему элементу массива. Возвращает false, если массив закончился
+    bool nextElement() {
+        return nextItem(']');
+    }
+
+    bool isString() {
+        return peek() == '"';
+    }
+
+    bool isObject() {
+        return peek() == '{';
+    }
+
+    bool isArray() {
+        return peek() == '[';
+    }
+
+    /*
+       Читает строку. Если в ней нет escape последовательностей, возвращает true и строку в raw.
+       Иначе возвращает false, а раскодированная строка записывается в decoded
+     */
+    bool readString(Span &raw, std::vector<Char> &decoded) {
+        expect('"');
+        raw.begin = pos;
+        while (pos != end && *pos != '"' && *pos != '\\') {
+            pos++;
+        }
+        CHECK(pos != end, "Incorrect json: unterminated string");
+        if (*pos == '"') {
+            raw.end = pos;
+            pos++;
+            return true;
+        }
+
+        decoded.assign(raw.begin, pos);
+        while (true) {
+            CHECK(pos != end, "Incorrect json: unterminated string");
+            const Char c = *pos++;
+            if (c == '"') {
+                break;
+            } else if (c != '\\') {
+                decoded.push_back(c);
+                continue;
+            }
+            CHECK(pos != end, "Incorrect json: unterminated string");
+            const Char escaped = *pos++;
+            switch (escaped) {
+            case '"': decoded.push_back('"'); break;
+            case '\\': decoded.push_back('\\'); break;
+            case '/': decoded.push_back('/'); break;
+            case 'b': decoded.push_back('\b'); break;
+            case 'f': decoded.push_back('\f'); break;
+            case 'n': decoded.push_back('\n'); break;
+            case 'r': decoded.push_back('\r'); break;
+            case 't': decoded.push_back('\t'); break;
+            case 'u': decoded.push_back(readHex4()); break;
+            default: throwErr("Incorrect json: incorrect escape sequence");
+            }
+        }
+        raw.end = pos - 1;
+        return false;
+    }
+
+    // Пропускает значение любого типа и возвращает его текст
+    Span skipValue() {
+        skipWhitespaces();
+        Span result;
+        result.begin = pos;
+        CHECK(pos != end, "Incorrect json: unexpected end");
+        if (*pos == '"') {
+            skipString();
+        } else if (*pos == '{' || *pos == '[') {
+            size_t depth = 0;
+            do {
+                CHECK(pos != end, "Incorrect json: unexpected end");
+                if (*pos == '"') {
+                    skipString();
+                    continue;
+                }
+                if (*pos == '{' || *pos == '[') {
+                    depth++;
+                } else if (*pos == '}' || *pos == ']') {
+                    depth--;
+                }
+                pos++;
+            } while (depth != 0);
+        } else {
+            while (pos != end && *pos != ',' && *pos != '}' && *pos != ']' && !isWhitespace(*pos)) {
+                pos++;
+            }
+            CHECK(pos != result.begin, "Incorrect json: value not found");
+        }
+        result.end = pos;
+        return result;
+    }
+
+    void finish() {
+        skipWhitespaces();
+        CHECK(pos == end, "Incorrect json: unexpected data at end");
+    }
+
+private:
+
+    static bool isWhitespace(Char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    void skipWhitespaces() {
+        while (pos != end && isWhitespace(*pos)) {
+            pos++;
+        }
+    }
+
+    Char peek() {
+        skipWhitespaces();
+        CHECK(pos != end, "Incorrect json: unexpected end");
+        return *pos;
+    }
+
+    void expect(char c) {
+        CHECK(peek() == Char(c), std::string("Incorrect json: expected ") + c);
+        pos++;
+    }
+
+    /*
+       Перед первым элементом запятой быть не должно, перед остальными она обязательна.
+       После закрытия вложенного объекта или массива продолжается родительский, в котором элемент уже был прочитан
+     */
+    bool nextItem(char close) {
+        if (peek() == Char(close)) {
+            pos++;
+            isFirstItem = false;
+            return false;
+        }
+        if (isFirstItem) {
+            isFirstItem = false;
+        } else {
+            expect(',');
+        }
+        return true;
+    }
+
+    void skipString() {
+        pos++;
+        while (true) {
+            CHECK(pos != end, "Incorrect json: unterminated string");
+            if (*pos == '\\') {
+                pos += 2;
+                CHECK(pos <= end, "Incorrect json: unterminated string");
+                continue;
+            }
+            if (*pos++ == '"') {
+                return;
+            }
+        }
+    }
+
+    Char readHex4() {
+        CHECK(end - pos >= 4, "Incorrect json: incorrect escape sequence");
+        uint32_t result = 0;
+        for (int i = 0; i < 4; i++) {
+            const Char c = *pos++;
+            result <<= 4;
+            if (c >= '0' && c <= '9') {
+                result |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                result |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                result |= c - 'A' + 10;
+            } else {
+                throwErr("Incorrect json: incorrect escape sequence");
+            }
+        }
+        // Для UTF-16 суррогатные пары \uXXXX\uXXXX склеиваются сами
+        return static_cast<Char>(result);
+    }
+
+private:
+
+    const Char *pos;
+
+    const Char *end;
+
+    bool isFirstItem = false;
+
+    std::vector<Char> decodedKey;
+};
+
+#endif // JSONREADER_H
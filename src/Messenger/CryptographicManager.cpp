@@ -8,14 +8,34 @@
 #include "TypedException.h"
 #include "utils.h"
 #include "QRegister.h"
+#include "Paths.h"
+#include "ParallelFor.h"
+#include "HexBase64.h"
+
+#include <QSettings>
+
+#include <algorithm>
 
 SET_LOG_NAMESPACE("MSG");
 
 namespace messenger {
 
+static size_t getDecryptedCacheSize() {
+    QSettings settings(getSettingsPath(), QSettings::IniFormat);
+    CHECK(settings.contains("messenger/saveDecryptedMessage"), "settings messenger/saveDecryptedMessage not found");
+    CHECK(settings.contains("messenger/lazyDecrypt"), "settings messenger/lazyDecrypt not found");
+    CHECK(settings.contains("messenger/lazyDecryptCacheKb"), "settings messenger/lazyDecryptCacheKb not found");
+    const bool isLazy = !settings.value("messenger/saveDecryptedMessage").toBool() && settings.value("messenger/lazyDecrypt").toBool();
+    if (!isLazy) {
+        return 0;
+    }
+    return settings.value("messenger/lazyDecryptCacheKb").toULongLong() * 1024;
+}
+
 CryptographicManager::CryptographicManager(QObject *parent)
     : TimerClass(1s, parent)
     , isSaveDecrypted_(false)
+    , decryptedCache(getDecryptedCacheSize())
 {
     CHECK(connect(this, &TimerClass::timerEvent, this, &CryptographicManager::onResetWallets), "not connect onTimerEvent");
 
@@ -30,8 +50,10 @@ CryptographicManager::CryptographicManager(QObject *parent)
     CHECK(connect(this, &CryptographicManager::unlockWallet, this, &CryptographicManager::onUnlockWallet), "not connect onUnlockWallet");
     CHECK(connect(this, &CryptographicManager::lockWallet, this, &CryptographicManager::onLockWallet), "not connect onLockWallet");
     CHECK(connect(this, &CryptographicManager::remainingTime, this, &CryptographicManager::onRemainingTime), "not connect onRemainingTime");
+    CHECK(connect(this, &CryptographicManager::getDecryptedCacheInfo, this, &CryptographicManager::onGetDecryptedCacheInfo), "not connect onGetDecryptedCacheInfo");
 
     Q_REG(DecryptMessagesCallback, "DecryptMessagesCallback");
+    Q_REG(DecryptMessagesProgressCallback, "DecryptMessagesProgressCallback");
     Q_REG(std::vector<Message>, "std::vector<Message>");
     Q_REG2(std::vector<QString>, "std::vector<QString>", false);
     Q_REG(SignMessageCallback, "SignMessageCallback");
@@ -42,10 +64,13 @@ CryptographicManager::CryptographicManager(QObject *parent)
     Q_REG(UnlockWalletCallback, "UnlockWalletCallback");
     Q_REG(LockWalletCallback, "LockWalletCallback");
     Q_REG(RemainingTimeCallback, "RemainingTimeCallback");
+    Q_REG(DecryptedCacheInfoCallback, "DecryptedCacheInfoCallback");
     Q_REG2(std::string, "std::string", false);
     Q_REG2(seconds, "seconds", false);
     Q_REG2(uint64_t, "uint64_t", false);
 
+    LOG << "Lazy decrypt cache size " << decryptedCache.getInfo().maxMemorySize;
+
     moveToThread(&thread1);
 }
 
@@ -77,9 +102,11 @@ WalletRsa* CryptographicManager::getWalletRsaWithoutCheck(const std::string &add
 void CryptographicManager::lockWalletImpl() {
     wallet = nullptr;
     walletRsa = nullptr;
+    decryptedCache.clear();
 }
 
 void CryptographicManager::unlockWalletImpl(const QString &folder, const std::string &address, const std::string &password, const std::string &passwordRsa, const seconds &time_) {
+    decryptedCache.clear();
     wallet = std::make_unique<Wallet>(folder, address, password);
     walletRsa = std::make_unique<WalletRsa>(folder, address);
     walletRsa->unlock(passwordRsa);
@@ -97,41 +124,66 @@ BEGIN_SLOT_WRAPPER
 
         if (elapsedTime >= time) {
             LOG << "Reseted wallets";
-            wallet = nullptr;
-            walletRsa = nullptr;
+            lockWalletImpl();
         }
     }
 END_SLOT_WRAPPER
 }
 
-static std::vector<Message> decryptMsg(const std::vector<Message> &messages, const WalletRsa *walletRsa, bool isThrow) {
-    std::vector<Message> result;
-    result.reserve(messages.size());
-    std::transform(messages.begin(), messages.end(), std::back_inserter(result), [walletRsa, isThrow](const Message &message) {
-        if (message.isDecrypted) {
-            return message;
-        }
-        Message result = message;
-        const bool isEncrypted = !result.isChannel;
-        if (!isEncrypted) {
-            result.decryptedDataHex = result.dataHex;
-            result.isDecrypted = true;
-        } else {
-            if (result.isCanDecrypted) {
-                if (walletRsa == nullptr) {
-                    if (isThrow) {
-                        throwErrTyped(TypeErrors::WALLET_NOT_UNLOCK, "Wallet rsa not unlock");
-                    } else {
-                        return result;
-                    }
+const static size_t DECRYPT_BLOCK_SIZE = 200;
+
+// hex строки в ascii, поэтому с QString они переводятся через latin1 без разбора utf-8
+static std::string hexToBinary(const QString &hex) {
+    const QByteArray hexLatin = hex.toLatin1();
+    std::string result;
+    appendFromHex(hexLatin.constData(), hexLatin.size(), result);
+    return result;
+}
+
+static QString hexToQString(const std::string &hex) {
+    return QString::fromLatin1(hex.data(), (int)hex.size());
+}
+
+static QString binaryToHex(const std::string &data) {
+    std::string hex;
+    appendToHex(data.data(), data.size(), hex);
+    return hexToQString(hex);
+}
+
+static Message decryptOneMsg(const Message &message, const WalletRsa *walletRsa, bool isThrow) {
+    if (message.isDecrypted) {
+        return message;
+    }
+    Message result = message;
+    const bool isEncrypted = !result.isChannel;
+    if (!isEncrypted) {
+        result.decryptedDataHex = result.dataHex;
+        result.isDecrypted = true;
+    } else {
+        if (result.isCanDecrypted) {
+            if (walletRsa == nullptr) {
+                if (isThrow) {
+                    throwErrTyped(TypeErrors::WALLET_NOT_UNLOCK, "Wallet rsa not unlock");
+                } else {
+                    return result;
                 }
-                CHECK_TYPED(walletRsa != nullptr, TypeErrors::WALLET_NOT_UNLOCK, "Wallet rsa not unlock");
-                const std::string decryptedData = toHex(walletRsa->decryptMessage(result.dataHex.toStdString()));
-                result.decryptedDataHex = QString::fromStdString(decryptedData);
-                result.isDecrypted = true;
             }
+            CHECK_TYPED(walletRsa != nullptr, TypeErrors::WALLET_NOT_UNLOCK, "Wallet rsa not unlock");
+            result.decryptedDataHex = binaryToHex(walletRsa->decryptMessage(result.dataHex.toStdString()));
+            result.isDecrypted = true;
         }
-        return result;
+    }
+    return result;
+}
+
+// Сообщения расшифровываются блоками по порядку, после каждого блока вызывается progress
+template<typename Progress>
+static std::vector<Message> decryptMsg(const std::vector<Message> &messages, const WalletRsa *walletRsa, bool isThrow, const Progress &progress) {
+    std::vector<Message> result(messages.size());
+    parallelForBlocks(0, messages.size(), DECRYPT_BLOCK_SIZE, [&](size_t i) {
+        result[i] = decryptOneMsg(messages[i], walletRsa, isThrow);
+    }, [&](size_t from, size_t to) {
+        progress(result, from, to);
     });
     return result;
 }
@@ -140,18 +192,51 @@ void CryptographicManager::onDecryptMessages(const std::vector<Message> &message
 BEGIN_SLOT_WRAPPER
     std::vector<Message> result;
     const TypedException exception = apiVrapper2([&, this] {
-        result = decryptMsg(messages, getWalletRsaWithoutCheck(address.toStdString()), true);
+        const WalletRsa *walletRsa = getWalletRsaWithoutCheck(address.toStdString());
+        if (!decryptedCache.isEnabled() || walletRsa == nullptr) {
+            result = decryptMsg(messages, walletRsa, true, [](const std::vector<Message>&, size_t, size_t) {});
+            return;
+        }
+
+        const auto isCached = [](const Message &message) {
+            return !message.isDecrypted && !message.isChannel && message.isCanDecrypted && message.dbId != -1;
+        };
+
+        result = messages;
+        std::vector<Message> toDecrypt;
+        std::vector<size_t> positions;
+        for (size_t i = 0; i < messages.size(); i++) {
+            Message &message = result[i];
+            if (isCached(message) && decryptedCache.get(message.dbId, message.decryptedDataHex)) {
+                message.isDecrypted = true;
+            } else {
+                toDecrypt.emplace_back(message);
+                positions.emplace_back(i);
+            }
+        }
+
+        const std::vector<Message> decrypted = decryptMsg(toDecrypt, walletRsa, true, [](const std::vector<Message>&, size_t, size_t) {});
+        for (size_t i = 0; i < decrypted.size(); i++) {
+            if (isCached(toDecrypt[i]) && decrypted[i].isDecrypted) {
+                decryptedCache.add(decrypted[i].dbId, decrypted[i].decryptedDataHex);
+            }
+            result[positions[i]] = decrypted[i];
+        }
     });
 
     callback.emitFunc(exception, result);
 END_SLOT_WRAPPER
 }
 
-void CryptographicManager::onTryDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesCallback &callback) {
+void CryptographicManager::onTryDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesProgressCallback &progressCallback, const DecryptMessagesCallback &callback) {
 BEGIN_SLOT_WRAPPER
     std::vector<Message> result;
     const TypedException exception = apiVrapper2([&, this] {
-        result = decryptMsg(messages, getWalletRsaWithoutCheck(address.toStdString()), false);
+        result = decryptMsg(messages, getWalletRsaWithoutCheck(address.toStdString()), false, [&progressCallback](const std::vector<Message> &decrypted, size_t from, size_t to) {
+            if (progressCallback.isSet() && to < decrypted.size()) {
+                progressCallback.emitCallback(std::vector<Message>(decrypted.begin() + from, decrypted.begin() + to), from, decrypted.size());
+            }
+        });
     });
 
     callback.emitFunc(exception, result);
@@ -223,9 +308,9 @@ void CryptographicManager::onEncryptDataRsa(const QString &dataHex, const QStrin
 BEGIN_SLOT_WRAPPER
     QString encryptedData;
     const TypedException exception = apiVrapper2([&] {
-        const std::string data = fromHex(dataHex.toStdString());
+        const std::string data = hexToBinary(dataHex);
         const WalletRsa walletRsa = WalletRsa::fromPublicKey(pubkeyDest.toStdString());
-        encryptedData = QString::fromStdString(walletRsa.encrypt(data));
+        encryptedData = hexToQString(walletRsa.encrypt(data));
     });
 
     callback.emitFunc(exception, encryptedData);
@@ -236,8 +321,8 @@ void CryptographicManager::onEncryptDataPrivateKey(const QString &dataHex, const
 BEGIN_SLOT_WRAPPER
     QString encryptedData;
     const TypedException exception = apiVrapper2([&] {
-        const std::string data = fromHex(dataHex.toStdString());
-        encryptedData = QString::fromStdString(getWalletRsa(address.toStdString()).encrypt(data));
+        const std::string data = hexToBinary(dataHex);
+        encryptedData = hexToQString(getWalletRsa(address.toStdString()).encrypt(data));
     });
 
     callback.emitFunc(exception, encryptedData);
@@ -264,6 +349,17 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void CryptographicManager::onGetDecryptedCacheInfo(const DecryptedCacheInfoCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    DecryptedMessagesCache::Info info;
+    const TypedException exception = apiVrapper2([&, this] {
+        info = decryptedCache.getInfo();
+    });
+
+    callback.emitFunc(exception, info);
+END_SLOT_WRAPPER
+}
+
 void CryptographicManager::onRemainingTime(const RemainingTimeCallback &callback) {
 BEGIN_SLOT_WRAPPER
     QString address;
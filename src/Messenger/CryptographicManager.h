@@ -7,6 +7,7 @@
 #include "CallbackWrapper.h"
 
 #include "Message.h"
+#include "DecryptedMessagesCache.h"
 
 class Wallet;
 class WalletRsa;
@@ -31,6 +32,9 @@ public:
 
     using DecryptMessagesCallback = CallbackWrapper<void(const std::vector<Message> &messages)>;
 
+    // Вызывается после расшифровки очередного блока сообщений [from, from + messages.size()) из countAll
+    using DecryptMessagesProgressCallback = CallbackWrapper<void(const std::vector<Message> &messages, size_t from, size_t countAll)>;
+
     using SignMessageCallback = CallbackWrapper<void(const QString &pubkey, const QString &sign)>;
 
     using SignMessagesCallback = CallbackWrapper<void(const QString &pubkey, const std::vector<QString> &sign)>;
@@ -47,11 +51,13 @@ public:
 
     using RemainingTimeCallback = CallbackWrapper<void(const QString &address, const seconds &elapsed)>;
 
+    using DecryptedCacheInfoCallback = CallbackWrapper<void(const DecryptedMessagesCache::Info &info)>;
+
 signals:
 
     void decryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesCallback &callback);
 
-    void tryDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesCallback &callback);
+    void tryDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesProgressCallback &progressCallback, const DecryptMessagesCallback &callback);
 
     void signMessage(const QString &address, const QString &message, const SignMessageCallback &callback);
 
@@ -71,11 +77,13 @@ signals:
 
     void remainingTime(const RemainingTimeCallback &callback);
 
+    void getDecryptedCacheInfo(const DecryptedCacheInfoCallback &callback);
+
 private slots:
 
     void onDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesCallback &callback);
 
-    void onTryDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesCallback &callback);
+    void onTryDecryptMessages(const std::vector<Message> &messages, const QString &address, const DecryptMessagesProgressCallback &progressCallback, const DecryptMessagesCallback &callback);
 
     void onSignMessage(const QString &address, const QString &message, const SignMessageCallback &callback);
 
@@ -95,6 +103,8 @@ private slots:
 
     void onRemainingTime(const RemainingTimeCallback &callback);
 
+    void onGetDecryptedCacheInfo(const DecryptedCacheInfoCallback &callback);
+
 private slots:
 
     void onResetWallets();
@@ -115,6 +125,9 @@ private:
 
     const bool isSaveDecrypted_;
 
+    // Используется в режиме ленивой расшифровки, когда в базе сообщения хранятся зашифрованными
+    DecryptedMessagesCache decryptedCache;
+
     std::unique_ptr<Wallet> wallet;
     std::unique_ptr<WalletRsa> walletRsa;
 
@@ -0,0 +1,75 @@
+#include "DecryptedMessagesCache.h"
+
+namespace messenger {
+
+DecryptedMessagesCache::DecryptedMessagesCache(size_t maxMemorySize)
+    : maxMemorySize(maxMemorySize)
+{}
+
+size_t DecryptedMessagesCache::elementSize(const QString &decryptedDataHex) {
+    // Строка, узел списка и элемент индекса
+    return decryptedDataHex.size() * sizeof(QChar) + sizeof(Element) + 4 * sizeof(void*) + sizeof(qint64);
+}
+
+bool DecryptedMessagesCache::get(qint64 id, QString &decryptedDataHex) {
+    const auto found = index.find(id);
+    if (found == index.end()) {
+        countMisses++;
+        return false;
+    }
+    elements.splice(elements.begin(), elements, found->second);
+    decryptedDataHex = found->second->second;
+    countHits++;
+    return true;
+}
+
+void DecryptedMessagesCache::add(qint64 id, const QString &decryptedDataHex) {
+    if (!isEnabled()) {
+        return;
+    }
+    // Старое значение убирается, даже если новое не поместится, чтобы не отдавать устаревший текст
+    const auto found = index.find(id);
+    if (found != index.end()) {
+        memorySize -= elementSize(found->second->second);
+        elements.erase(found->second);
+        index.erase(found);
+    }
+
+    const size_t size = elementSize(decryptedDataHex);
+    if (size > maxMemorySize) {
+        return;
+    }
+
+    while (memorySize + size > maxMemorySize) {
+        removeLast();
+    }
+
+    elements.emplace_front(id, decryptedDataHex);
+    index[id] = elements.begin();
+    memorySize += size;
+}
+
+void DecryptedMessagesCache::removeLast() {
+    const Element &last = elements.back();
+    memorySize -= elementSize(last.second);
+    index.erase(last.first);
+    elements.pop_back();
+}
+
+void DecryptedMessagesCache::clear() {
+    elements.clear();
+    index.clear();
+    memorySize = 0;
+}
+
+DecryptedMessagesCache::Info DecryptedMessagesCache::getInfo() const {
+    Info info;
+    info.countElements = elements.size();
+    info.memorySize = memorySize;
+    info.maxMemorySize = maxMemorySize;
+    info.countHits = countHits;
+    info.countMisses = countMisses;
+    return info;
+}
+
+}
@@ -0,0 +1,68 @@
+#ifndef DECRYPTEDMESSAGESCACHE_H
+#define DECRYPTEDMESSAGESCACHE_H
+
+#include <QString>
+
+#include <list>
+#include <unordered_map>
+
+namespace messenger {
+
+/*
+   LRU расшифрованных текстов сообщений по id сообщения в базе.
+   Размер ограничивается суммарным объемом хранимых строк.
+   Класс не потокобезопасен.
+ */
+class DecryptedMessagesCache {
+public:
+
+    struct Info {
+        size_t countElements = 0;
+        size_t memorySize = 0;
+        size_t maxMemorySize = 0;
+        size_t countHits = 0;
+        size_t countMisses = 0;
+    };
+
+public:
+
+    explicit DecryptedMessagesCache(size_t maxMemorySize);
+
+    bool isEnabled() const {
+        return maxMemorySize != 0;
+    }
+
+    bool get(qint64 id, QString &decryptedDataHex);
+
+    void add(qint64 id, const QString &decryptedDataHex);
+
+    void clear();
+
+    Info getInfo() const;
+
+private:
+
+    static size_t elementSize(const QString &decryptedDataHex);
+
+    void removeLast();
+
+private:
+
+    using Element = std::pair<qint64, QString>;
+
+    const size_t maxMemorySize;
+
+    std::list<Element> elements;
+
+    std::unordered_map<qint64, std::list<Element>::iterator> index;
+
+    size_t memorySize = 0;
+
+    size_t countHits = 0;
+
+    size_t countMisses = 0;
+};
+
+}
+
+#endif // DECRYPTEDMESSAGESCACHE_H
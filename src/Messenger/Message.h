@@ -21,6 +21,8 @@ struct Message {
     bool isChannel = false;
     bool isDecrypted = false;
     QString channel = QString("");
+    // id сообщения в базе, -1 если сообщение еще не сохранено
+    qint64 dbId = -1;
 
     bool operator< (const Message &second) const {
         return this->counter < second.counter;
@@ -33,9 +35,18 @@ struct ChannelInfo {
     QString admin = QString("");
     uint64_t fee;
     Message::Counter counter = -1;
+    Message::Counter unreadCount = 0;
     bool isWriter;
 };
 
+// Непрочитанные сообщения диалога с контактом или канала. name - адрес контакта или sha канала
+struct UnreadCounter {
+    QString name;
+    bool isChannel = false;
+    Message::Counter lastCounter = -1;
+    Message::Counter unreadCount = 0;
+};
+
 struct ContactInfo {
     QString pubkeyRsa = QString("");
     QString txRsaHash = QString("");
@@ -0,0 +1,124 @@
+#include "MessagesGapTracker.h"
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+#include "check.h"
+
+namespace messenger {
+
+void MessagesGapTracker::addRange(Ranges &ranges, Message::Counter from, Message::Counter to) {
+    CHECK(from <= to, "Incorrect range");
+    auto iter = ranges.upper_bound(from);
+    if (iter != ranges.begin() && std::prev(iter)->second + 1 >= from) {
+        iter = std::prev(iter);
+        from = iter->first;
+        to = std::max(to, iter->second);
+    }
+    while (iter != ranges.end() && iter->first <= to + 1) {
+        to = std::max(to, iter->second);
+        iter = ranges.erase(iter);
+    }
+    ranges[from] = to;
+}
+
+void MessagesGapTracker::removeRange(Ranges &ranges, Message::Counter from, Message::Counter to) {
+    auto iter = ranges.upper_bound(from);
+    if (iter != ranges.begin() && std::prev(iter)->second >= from) {
+        iter = std::prev(iter);
+    }
+    while (iter != ranges.end() && iter->first <= to) {
+        const Message::Counter begin = iter->first;
+        const Message::Counter end = iter->second;
+        iter = ranges.erase(iter);
+        if (begin < from) {
+            ranges[begin] = from - 1;
+        }
+        if (end > to) {
+            ranges[to + 1] = end;
+        }
+    }
+}
+
+void MessagesGapTracker::removeIfEmpty(const Key &key) {
+    const auto found = gaps.find(key);
+    if (found != gaps.end() && found->second.missing.empty() && found->second.requested.empty()) {
+        gaps.erase(found);
+    }
+}
+
+void MessagesGapTracker::addGap(const Key &key, Message::Counter from, Message::Counter to) {
+    if (from > to) {
+        return;
+    }
+    addRange(gaps[key].missing, from, to);
+}
+
+void MessagesGapTracker::removeCounter(const Key &key, Message::Counter counter) {
+    const auto found = gaps.find(key);
+    if (found == gaps.end()) {
+        return;
+    }
+    removeRange(found->second.missing, counter, counter);
+    removeIfEmpty(key);
+}
+
+std::vector<MessagesGapTracker::Range> MessagesGapTracker::getNotRequested(const Key &key) const {
+    std::vector<Range> result;
+    const auto found = gaps.find(key);
+    if (found == gaps.end()) {
+        return result;
+    }
+    Ranges notRequested = found->second.missing;
+    for (const auto &requested: found->second.requested) {
+        removeRange(notRequested, requested.first, requested.second);
+    }
+    for (const auto &range: notRequested) {
+        result.emplace_back(Range{range.first, range.second});
+    }
+    return result;
+}
+
+void MessagesGapTracker::addRequest(size_t requestId, const Key &key, const Range &range, const time_point &now) {
+    addRange(gaps[key].requested, range.from, range.to);
+    requests[requestId] = Request{key, range, now};
+}
+
+bool MessagesGapTracker::isRequest(size_t requestId) const {
+    return requests.find(requestId) != requests.end();
+}
+
+MessagesGapTracker::Key MessagesGapTracker::finishRequest(size_t requestId) {
+    const auto found = requests.find(requestId);
+    CHECK(found != requests.end(), "Not found gap request " + std::to_string(requestId));
+    const Request request = found->second;
+    requests.erase(found);
+
+    Gaps &keyGaps = gaps[request.key];
+    removeRange(keyGaps.missing, request.range.from, request.range.to);
+    removeRange(keyGaps.requested, request.range.from, request.range.to);
+    removeIfEmpty(request.key);
+    return request.key;
+}
+
+std::vector<MessagesGapTracker::Key> MessagesGapTracker::finishExpiredRequests(const time_point &now, const milliseconds &timeout) {
+    std::vector<size_t> expired;
+    for (const auto &request: requests) {
+        if (now - request.second.time >= timeout) {
+            expired.emplace_back(request.first);
+        }
+    }
+    std::set<Key> keys;
+    for (const size_t requestId: expired) {
+        keys.insert(finishRequest(requestId));
+    }
+    return std::vector<Key>(keys.begin(), keys.end());
+}
+
+bool MessagesGapTracker::isGap(const Key &key) const {
+    const auto found = gaps.find(key);
+    return found != gaps.end() && !found->second.missing.empty();
+}
+
+}
@@ -0,0 +1,82 @@
+#ifndef MESSAGESGAPTRACKER_H
+#define MESSAGESGAPTRACKER_H
+
+#include <QString>
+
+#include <map>
+#include <vector>
+
+#include "duration.h"
+
+#include "Message.h"
+
+namespace messenger {
+
+/*
+   Пропущенные диапазоны счетчиков сообщений для пары (адрес, канал).
+   Пересекающиеся и соседние диапазоны объединяются, уже запрошенные части повторно не отдаются.
+   Класс не потокобезопасен.
+ */
+class MessagesGapTracker {
+public:
+
+    // Адрес и канал. Для личных сообщений канал пустой
+    using Key = std::pair<QString, QString>;
+
+    struct Range {
+        Message::Counter from;
+        Message::Counter to;
+    };
+
+public:
+
+    void addGap(const Key &key, Message::Counter from, Message::Counter to);
+
+    void removeCounter(const Key &key, Message::Counter counter);
+
+    // Объединенные диапазоны, для которых еще нет запроса
+    std::vector<Range> getNotRequested(const Key &key) const;
+
+    void addRequest(size_t requestId, const Key &key, const Range &range, const time_point &now);
+
+    bool isRequest(size_t requestId) const;
+
+    // Запрос завершен ответом или ошибкой, весь его диапазон считается закрытым
+    Key finishRequest(size_t requestId);
+
+    std::vector<Key> finishExpiredRequests(const time_point &now, const milliseconds &timeout);
+
+    bool isGap(const Key &key) const;
+
+private:
+
+    // Начало диапазона -> конец диапазона включительно
+    using Ranges = std::map<Message::Counter, Message::Counter>;
+
+    static void addRange(Ranges &ranges, Message::Counter from, Message::Counter to);
+
+    static void removeRange(Ranges &ranges, Message::Counter from, Message::Counter to);
+
+    void removeIfEmpty(const Key &key);
+
+private:
+
+    struct Gaps {
+        Ranges missing;
+        Ranges requested;
+    };
+
+    struct Request {
+        Key key;
+        Range range;
+        time_point time;
+    };
+
+    std::map<Key, Gaps> gaps;
+
+    std::map<size_t, Request> requests;
+};
+
+}
+
+#endif // MESSAGESGAPTRACKER_H
@@ -7,6 +7,7 @@
 #include "Paths.h"
 #include "utils.h"
 #include "QRegister.h"
+#include "Sha256Hasher.h"
 
 #include "MessengerMessages.h"
 #include "MessengerJavascript.h"
@@ -14,6 +15,8 @@
 #include "MessengerDBStorage.h"
 
 #include <functional>
+#include <memory>
+#include <set>
 using namespace std::placeholders;
 
 #include <QJsonDocument>
@@ -29,6 +32,9 @@ SET_LOG_NAMESPACE("MSG");
 
 namespace messenger {
 
+// Если ответ на запрос пропущенных сообщений не пришел, перестаем его ждать
+static const milliseconds GAP_REQUEST_TIMEOUT = 10s;
+
 static QString createHashMessage(const QString &message) {
     return QString(QCryptographicHash::hash(message.toUtf8(), QCryptographicHash::Sha512).toHex());
 }
@@ -55,7 +61,10 @@ void Messenger::checkChannelTitle(const QString &title) {
 
 QString Messenger::getChannelSha(const QString &title) {
     checkChannelTitle(title);
-    return QString(QCryptographicHash::hash(title.toUtf8(), QCryptographicHash::Sha256).toHex());
+    const QByteArray titleUtf8 = title.toUtf8();
+    uint8_t hash[Sha256Hasher::DIGEST_SIZE];
+    Sha256Hasher::hash(titleUtf8.data(), titleUtf8.size(), hash);
+    return QString(QByteArray(reinterpret_cast<const char*>(hash), sizeof(hash)).toHex());
 }
 
 std::vector<QString> Messenger::stringsForSign() {
@@ -134,9 +143,11 @@ Messenger::Messenger(MessengerJavascript &javascriptWrapper, MessengerDBStorage
     CHECK(connect(this, &Messenger::getSavedsPos, this, &Messenger::onGetSavedsPos), "not connect onGetSavedsPos");
     CHECK(connect(this, &Messenger::savePos, this, &Messenger::onSavePos), "not connect onGetSavedPos");
     CHECK(connect(this, &Messenger::getCountMessages, this, &Messenger::onGetCountMessages), "not connect onGetCountMessages");
+    CHECK(connect(this, &Messenger::getUnreadCounters, this, &Messenger::onGetUnreadCounters), "not connect onGetUnreadCounters");
     CHECK(connect(this, &Messenger::getHistoryAddress, this, &Messenger::onGetHistoryAddress), "not connect onGetHistoryAddress");
     CHECK(connect(this, &Messenger::getHistoryAddressAddress, this, &Messenger::onGetHistoryAddressAddress), "not connect onGetHistoryAddressAddress");
     CHECK(connect(this, &Messenger::getHistoryAddressAddressCount, this, &Messenger::onGetHistoryAddressAddressCount), "not connect onGetHistoryAddressAddressCount");
+    CHECK(connect(this, &Messenger::searchMessages, this, &Messenger::onSearchMessages), "not connect onSearchMessages");
     CHECK(connect(this, &Messenger::createChannel, this, &Messenger::onCreateChannel), "not connect onCreateChannel");
     CHECK(connect(this, &Messenger::addWriterToChannel, this, &Messenger::onAddWriterToChannel), "not connect onAddWriterToChannel");
     CHECK(connect(this, &Messenger::delWriterFromChannel, this, &Messenger::onDelWriterFromChannel), "not connect onDelWriterFromChannel");
@@ -161,6 +172,7 @@ Messenger::Messenger(MessengerJavascript &javascriptWrapper, MessengerDBStorage
     Q_REG(GetPubkeyAddressCallback, "GetPubkeyAddressCallback");
     Q_REG(SendMessageCallback, "SendMessageCallback");
     Q_REG(GetCountMessagesCallback, "GetCountMessagesCallback");
+    Q_REG(GetUnreadCountersCallback, "GetUnreadCountersCallback");
     Q_REG(CreateChannelCallback, "CreateChannelCallback");
     Q_REG(AddWriterToChannelCallback, "AddWriterToChannelCallback");
     Q_REG(DelWriterToChannelCallback, "DelWriterToChannelCallback");
@@ -206,20 +218,57 @@ std::vector<QString> Messenger::getMonitoredAddresses() const {
     return result;
 }
 
-void Messenger::getMessagesFromAddressFromWss(const QString &fromAddress, Message::Counter from, Message::Counter to) {
+size_t Messenger::getMessagesFromAddressFromWss(const QString &fromAddress, Message::Counter from, Message::Counter to) {
     const QString pubkeyHex = db.getUserPublicKey(fromAddress);
     CHECK_TYPED(!pubkeyHex.isEmpty(), TypeErrors::INCOMPLETE_USER_INFO, "user pubkey not found " + fromAddress.toStdString());
     const QString signHex = getSignFromMethod(fromAddress, makeTextForGetMyMessagesRequest());
-    const QString message = makeGetMyMessagesRequest(pubkeyHex, signHex, from, to, id.get());
+    const size_t requestId = id.get();
+    const QString message = makeGetMyMessagesRequest(pubkeyHex, signHex, from, to, requestId);
     emit wssClient.sendMessage(message);
+    return requestId;
 }
 
-void Messenger::getMessagesFromChannelFromWss(const QString &fromAddress, const QString &channelSha, Message::Counter from, Message::Counter to) {
+size_t Messenger::getMessagesFromChannelFromWss(const QString &fromAddress, const QString &channelSha, Message::Counter from, Message::Counter to) {
     const QString pubkeyHex = db.getUserPublicKey(fromAddress);
     CHECK_TYPED(!pubkeyHex.isEmpty(), TypeErrors::INCOMPLETE_USER_INFO, "user pubkey not found " + fromAddress.toStdString());
     const QString signHex = getSignFromMethod(fromAddress, makeTextForGetChannelRequest());
-    const QString message = makeGetChannelRequest(channelSha, from, to, pubkeyHex, signHex, id.get());
+    const size_t requestId = id.get();
+    const QString message = makeGetChannelRequest(channelSha, from, to, pubkeyHex, signHex, requestId);
     emit wssClient.sendMessage(message);
+    return requestId;
+}
+
+void Messenger::requestGaps(const MessagesGapTracker::Key &key) {
+    const QString &address = key.first;
+    const QString &channel = key.second;
+    for (const MessagesGapTracker::Range &range: gapTracker.getNotRequested(key)) {
+        LOG << "Request missing messages " << address << " " << channel << " " << range.from << " " << range.to;
+        size_t requestId;
+        if (channel.isEmpty()) {
+            requestId = getMessagesFromAddressFromWss(address, range.from, range.to);
+        } else {
+            requestId = getMessagesFromChannelFromWss(address, channel, range.from, range.to);
+        }
+        gapTracker.addRequest(requestId, key, range, ::now());
+    }
+}
+
+void Messenger::finishGapRequest(size_t requestId) {
+    if (!gapTracker.isRequest(requestId)) {
+        return;
+    }
+    const MessagesGapTracker::Key key = gapTracker.finishRequest(requestId);
+    if (!gapTracker.isGap(key)) {
+        emitNewMessages(key.first, key.second, db.getMessageMaxCounter(key.first, key.second));
+    }
+}
+
+void Messenger::emitNewMessages(const QString &address, const QString &channel, Message::Counter lastCnt) {
+    if (channel.isEmpty()) {
+        emit javascriptWrapper.newMessegesSig(address, lastCnt);
+    } else {
+        emit javascriptWrapper.newMessegesChannelSig(address, channel, lastCnt);
+    }
 }
 
 void Messenger::clearAddressesToMonitored() {
@@ -354,25 +403,18 @@ END_SLOT_WRAPPER
 
 void Messenger::onTimerEvent() {
 BEGIN_SLOT_WRAPPER
-    for (auto &pairDeferred: deferredMessages) {
-        const QString &address = pairDeferred.first.first;
-        const QString &channel = pairDeferred.first.second;
-        DeferredMessage &deferred = pairDeferred.second;
-        if (deferred.check()) {
-            deferred.resetDeferred();
-            const Message::Counter lastCnt = db.getMessageMaxCounter(address, "");
-            LOG << "Defferred process message " << address << " " << channel << " " << lastCnt;
-            if (channel.isEmpty()) {
-                emit javascriptWrapper.newMessegesSig(address, lastCnt);
-            } else {
-                emit javascriptWrapper.newMessegesChannelSig(address, channel, lastCnt);
-            }
+    for (const MessagesGapTracker::Key &key: gapTracker.finishExpiredRequests(::now(), GAP_REQUEST_TIMEOUT)) {
+        const QString &address = key.first;
+        const QString &channel = key.second;
+        LOG << "Missing messages request timeout " << address << " " << channel;
+        if (!gapTracker.isGap(key)) {
+            emitNewMessages(address, channel, db.getMessageMaxCounter(address, channel));
         }
     }
 END_SLOT_WRAPPER
 }
 
-void Messenger::processMessages(const QString &address, const std::vector<NewMessageResponse> &messages, bool isChannel) {
+void Messenger::processMessages(const QString &address, const std::vector<NewMessageResponse> &messages, bool isChannel, size_t requestId) {
     CHECK(!messages.empty(), "Empty messages");
 
     std::vector<Message> msgs;
@@ -398,7 +440,7 @@ void Messenger::processMessages(const QString &address, const std::vector<NewMes
         return message;
     });
 
-    const auto nextProcess = [this, isChannel, address](const std::vector<Message> &messages) {
+    const auto nextProcess = [this, isChannel, address, requestId](const std::vector<Message> &messages) {
         CHECK(!messages.empty(), "Empty messages");
         const QString channel = isChannel ? messages.front().channel : "";
 
@@ -407,7 +449,10 @@ void Messenger::processMessages(const QString &address, const std::vector<NewMes
         const Message::Counter minCounterInServer = messages.front().counter;
         const Message::Counter maxCounterInServer = messages.back().counter;
 
-        bool deffer = false;
+        const auto gapKey = std::make_pair(address, channel);
+        const bool wasGap = gapTracker.isGap(gapKey);
+        std::vector<Message> newMessages;
+        std::set<QString> newOutputHashes;
         for (const Message &m: messages) {
             if (!isChannel) {
                 CHECK(!m.isChannel, "Message is channel");
@@ -419,12 +464,7 @@ void Messenger::processMessages(const QString &address, const std::vector<NewMes
 
             if (m.isInput) {
                 LOG << "Add message " << m.username << " " << channel << " " << m.collocutor << " " << m.counter;
-                db.addMessage(m);
-                const QString collocutorOrChannel = isChannel ? channel : m.collocutor;
-                const Message::Counter savedPos = db.getLastReadCounterForUserContact(m.username, collocutorOrChannel, isChannel); // TODO вместо метода get сделать метод is
-                if (savedPos == -1) {
-                    db.setLastReadCounterForUserContact(m.username, collocutorOrChannel, -1, isChannel); // TODO подумать нужен ли этот вызов
-                }
+                newMessages.emplace_back(m);
             } else {
                 const auto idPair = db.findFirstNotConfirmedMessageWithHash(m.username, m.hash, channel);
                 const auto idDb = idPair.first;
@@ -433,52 +473,43 @@ void Messenger::processMessages(const QString &address, const std::vector<NewMes
                     LOG << "Update message " << m.username << " " << channel << " " << m.counter;
                     db.updateMessage(idDb, m.counter, true);
                     if (counter != m.counter && !db.hasMessageWithCounter(m.username, counter, channel)) {
-                        if (!isChannel) {
-                            getMessagesFromAddressFromWss(m.username, counter, counter);
-                        } else {
-                            getMessagesFromChannelFromWss(m.username, channel, counter, counter);
-                        }
-                        deffer = true;
+                        LOG << "Gap message0 " << address << " " << channel << " " << counter;
+                        gapTracker.addGap(gapKey, counter, counter);
                     }
                 } else {
                     const auto idPair2 = db.findFirstMessageWithHash(m.username, m.hash, channel);
-                    if (idPair2.first == -1) {
+                    if (idPair2.first == -1 && newOutputHashes.insert(m.hash).second) {
                         LOG << "Insert new output message " << m.username << " " << channel << " " << m.counter << " " << m.hash;
-                        db.addMessage(m);
+                        newMessages.emplace_back(m);
                     }
                 }
             }
         }
+        db.addMessages(newMessages);
 
-        const auto deferrPair = std::make_pair(address, channel);
-        if (deffer) {
-            LOG << "Deffer message0 " << address << " " << channel;
-            deferredMessages[deferrPair].setDeferred(2s);
-        } else if (minCounterInServer > currConfirmedCounter + 1) {
-            LOG << "Deffer message " << address << " " << channel << " " << minCounterInServer << " " << currConfirmedCounter << " " << maxCounterInServer;
-            deferredMessages[deferrPair].setDeferred(2s);
-            if (!isChannel) {
-                getMessagesFromAddressFromWss(address, currConfirmedCounter + 1, minCounterInServer);
-            } else {
-                getMessagesFromChannelFromWss(address, channel, currConfirmedCounter + 1, minCounterInServer);
-            }
+        for (const Message &m: messages) {
+            gapTracker.removeCounter(gapKey, m.counter);
+        }
+        if (gapTracker.isRequest(requestId)) {
+            gapTracker.finishRequest(requestId);
+        }
+        if (minCounterInServer > currConfirmedCounter + 1) {
+            LOG << "Gap message " << address << " " << channel << " " << minCounterInServer << " " << currConfirmedCounter << " " << maxCounterInServer;
+            gapTracker.addGap(gapKey, currConfirmedCounter + 1, minCounterInServer - 1);
+        }
+        requestGaps(gapKey);
+
+        if (!gapTracker.isGap(gapKey)) {
+            emitNewMessages(address, channel, wasGap ? db.getMessageMaxCounter(address, channel) : maxCounterInServer);
         } else {
-            if (!deferredMessages[deferrPair].isDeferred()) {
-                if (!isChannel) {
-                    emit javascriptWrapper.newMessegesSig(address, maxCounterInServer);
-                } else {
-                    emit javascriptWrapper.newMessegesChannelSig(address, channel, maxCounterInServer);
-                }
-            } else {
-                LOG << "Deffer message2 " << address << " " << channel << " " << minCounterInServer << " " << currConfirmedCounter << " " << maxCounterInServer;
-            }
+            LOG << "Wait missing messages " << address << " " << channel << " " << minCounterInServer << " " << currConfirmedCounter << " " << maxCounterInServer;
         }
     };
 
     if (!isDecryptDataSave) {
         nextProcess(msgs);
     } else {
-        emit cryptManager.tryDecryptMessages(msgs, address, CryptographicManager::DecryptMessagesCallback(nextProcess, [](const TypedException &exception) {
+        emit cryptManager.tryDecryptMessages(msgs, address, CryptographicManager::DecryptMessagesProgressCallback(), CryptographicManager::DecryptMessagesCallback(nextProcess, [](const TypedException &exception) {
             LOG << "Error " << exception.numError << " " << exception.description;
         }, std::bind(&Messenger::callbackCall, this, _1), false));
     }
@@ -486,11 +517,17 @@ void Messenger::processMessages(const QString &address, const std::vector<NewMes
 
 void Messenger::onWssMessageReceived(QString message) {
 BEGIN_SLOT_WRAPPER
-    const QJsonDocument messageJson = QJsonDocument::fromJson(message.toUtf8());
-    const ResponseType responseType = getMethodAndAddressResponse(messageJson);
+    const ParsedResponse parsedResponse = parseResponse(message);
+    const ResponseType &responseType = parsedResponse.type;
+    // Сообщения уже разобраны, дерево json нужно только остальным методам
+    const QJsonDocument messageJson = (parsedResponse.isMessagesParsed || responseType.isError) ? QJsonDocument() : QJsonDocument::fromJson(message.toUtf8());
 
     if (responseType.isError) {
         LOG << "Messenger response error " << responseType.id << " " << responseType.method << " " << responseType.address << " " << responseType.error;
+        if (gapTracker.isRequest(responseType.id)) {
+            finishGapRequest(responseType.id);
+            return;
+        }
         if (responseType.id != size_t(-1)) {
             TypedException exception;
             if (responseType.errorType == ResponseType::ERROR_TYPE::ADDRESS_EXIST) {
@@ -535,17 +572,25 @@ BEGIN_SLOT_WRAPPER
         db.setContactPublicKey(publicKeyResult.addr, publicKeyResult.publicKey, publicKeyResult.txHash, publicKeyResult.blockchain_name);
         invokeCallback(responseType.id, TypedException());
     } else if (responseType.method == METHOD::NEW_MSG) {
-        const NewMessageResponse messages = parseNewMessageResponse(messageJson);
+        const NewMessageResponse &messages = parsedResponse.messages.at(0);
         LOG << "New msg " << responseType.address << " " << messages.collocutor << " " << messages.counter;
-        processMessages(responseType.address, {messages}, messages.isChannel);
+        processMessages(responseType.address, {messages}, messages.isChannel, responseType.id);
     } else if (responseType.method == METHOD::NEW_MSGS) {
-        const std::vector<NewMessageResponse> messages = parseNewMessagesResponse(messageJson);
+        const std::vector<NewMessageResponse> &messages = parsedResponse.messages;
         LOG << "New msgs " << responseType.address << " " << messages.size();
-        processMessages(responseType.address, messages, false);
+        if (messages.empty()) {
+            finishGapRequest(responseType.id);
+            return;
+        }
+        processMessages(responseType.address, messages, false, responseType.id);
     } else if (responseType.method == METHOD::GET_CHANNEL) {
-        const std::vector<NewMessageResponse> messages = parseGetChannelResponse(messageJson);
+        const std::vector<NewMessageResponse> &messages = parsedResponse.messages;
         LOG << "New msgs " << responseType.address << " " << messages.size();
-        processMessages(responseType.address, messages, true);
+        if (messages.empty()) {
+            finishGapRequest(responseType.id);
+            return;
+        }
+        processMessages(responseType.address, messages, true, responseType.id);
     } else if (responseType.method == METHOD::SEND_TO_ADDR) {
         LOG << "Send to addr ok " << responseType.address;
         invokeCallback(responseType.id, TypedException());
@@ -829,6 +874,16 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void Messenger::onGetUnreadCounters(const QString &address, const GetUnreadCountersCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    std::vector<UnreadCounter> counters;
+    const TypedException exception = apiVrapper2([&, this] {
+        counters = db.getUnreadCounters(address);
+    });
+    callback.emitFunc(exception, counters);
+END_SLOT_WRAPPER
+}
+
 void Messenger::onGetHistoryAddress(QString address, Message::Counter from, Message::Counter to, const GetMessagesCallback &callback) {
 BEGIN_SLOT_WRAPPER
     std::vector<Message> messages;
@@ -859,6 +914,17 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void Messenger::onSearchMessages(QString address, bool isChannel, const QString &collocutorOrChannel, const QString &text, qint64 offset, qint64 count, const GetMessagesCallback &callback) {
+BEGIN_SLOT_WRAPPER
+    std::vector<Message> messages;
+    const TypedException exception = apiVrapper2([&, this] {
+        CHECK_TYPED(db.isSearchEnabled(), TypeErrors::MESSENGER_SEARCH_NOT_SUPPORTED, "Full text search not supported");
+        messages = db.searchMessages(address, collocutorOrChannel, isChannel, text, offset, count);
+    });
+    callback.emitFunc(exception, messages);
+END_SLOT_WRAPPER
+}
+
 void Messenger::onCreateChannel(const QString &address, const QString &title, const QString &titleSha, const QString &pubkeyHex, const QString &signHex, uint64_t fee, const CreateChannelCallback &callback) {
 BEGIN_SLOT_WRAPPER
     const TypedException exception = apiVrapper2([&, this] {
@@ -930,21 +996,32 @@ BEGIN_SLOT_WRAPPER
         const auto notDecryptedMessagesPair = db.getNotDecryptedMessage(address);
         CHECK(notDecryptedMessagesPair.first.size() == notDecryptedMessagesPair.second.size(), "Incorrect db.getNotDecryptedMessage");
         const std::vector<Message> &notDecryptedMessages = notDecryptedMessagesPair.second;
-        cryptManager.tryDecryptMessages(notDecryptedMessages, address, CryptographicManager::DecryptMessagesCallback([this, ids=notDecryptedMessagesPair.first, callback](const std::vector<Message> &answer) {
-            CHECK(ids.size() == answer.size(), "Incorrect tryDecryptMessages");
+        // Расшифрованные блоки сохраняются сразу, чтобы первые страницы можно было показать до окончания расшифровки
+        const auto countSaved = std::make_shared<size_t>(0);
+        const auto saveDecrypted = [this, ids=notDecryptedMessagesPair.first, countSaved](const std::vector<Message> &decrypted, size_t from) {
+            CHECK(from == *countSaved && from + decrypted.size() <= ids.size(), "Incorrect tryDecryptMessages");
             std::vector<std::tuple<MessengerDBStorage::DbId, bool, QString>> result;
-            result.reserve(ids.size());
-            for (size_t i = 0; i < ids.size(); i++) {
-                result.emplace_back(ids[i], answer[i].isDecrypted, answer[i].decryptedDataHex);
+            result.reserve(decrypted.size());
+            for (size_t i = 0; i < decrypted.size(); i++) {
+                result.emplace_back(ids[from + i], decrypted[i].isDecrypted, decrypted[i].decryptedDataHex);
             }
             db.updateDecryptedMessage(result);
+            *countSaved += decrypted.size();
+        };
+        const auto errorCallback = [callback](const TypedException &exception) {
+            callback.emitException(exception);
+        };
+        cryptManager.tryDecryptMessages(notDecryptedMessages, address, CryptographicManager::DecryptMessagesProgressCallback([saveDecrypted](const std::vector<Message> &decrypted, size_t from, size_t countAll) {
+            saveDecrypted(decrypted, from);
+            LOG << "Decrypted " << from + decrypted.size() << "/" << countAll << " messages";
+        }, errorCallback, std::bind(&Messenger::callbackCall, this, _1), true), CryptographicManager::DecryptMessagesCallback([saveDecrypted, countSaved, callback, countAll=notDecryptedMessages.size()](const std::vector<Message> &answer) {
+            CHECK(answer.size() == countAll, "Incorrect tryDecryptMessages");
+            saveDecrypted(std::vector<Message>(answer.begin() + *countSaved, answer.end()), *countSaved);
 
-            LOG << "Decrypted " << result.size() << " messages";
+            LOG << "Decrypted " << answer.size() << " messages";
 
             callback.emitCallback();
-        }, [callback](const TypedException &exception) {
-            callback.emitException(exception);
-        }, std::bind(&Messenger::callbackCall, this, _1), true));
+        }, errorCallback, std::bind(&Messenger::callbackCall, this, _1), true));
     });
     if (exception.isSet()) {
         callback.emitException(exception);
@@ -9,6 +9,7 @@
 
 #include "RequestId.h"
 #include "Message.h"
+#include "MessagesGapTracker.h"
 
 #include "CallbackWrapper.h"
 
@@ -101,42 +102,6 @@ public:
 
     using Callback = std::function<void()>;
 
-private:
-
-    class DeferredMessage {
-    public:
-
-        bool check() const {
-            if (!isDeferred_) {
-                return false;
-            }
-            const time_point now = ::now();
-            const milliseconds duration = std::chrono::duration_cast<milliseconds>(now - begin_);
-            return duration >= elapse_;
-        }
-
-        bool isDeferred() const {
-            return isDeferred_;
-        }
-
-        void setDeferred(const milliseconds &elapse) {
-            isDeferred_ = true;
-            begin_ = ::now();
-            elapse_ = elapse;
-        }
-
-        void resetDeferred() {
-            isDeferred_ = false;
-        }
-
-    private:
-        bool isDeferred_ = false;
-        time_point begin_;
-        milliseconds elapse_;
-    };
-
-public:
-
     using GetMessagesCallback = CallbackWrapper<void(const std::vector<Message> &messages)>;
 
     using SavePosCallback = CallbackWrapper<void()>;
@@ -159,6 +124,8 @@ public:
 
     using GetCountMessagesCallback = CallbackWrapper<void(const Message::Counter &count)>;
 
+    using GetUnreadCountersCallback = CallbackWrapper<void(const std::vector<UnreadCounter> &counters)>;
+
     using CreateChannelCallback = CallbackWrapper<void()>;
 
     using AddWriterToChannelCallback = CallbackWrapper<void()>;
@@ -245,12 +212,16 @@ signals:
 
     void getCountMessages(const QString &address, const QString &collocutor, Message::Counter from, const GetCountMessagesCallback &callback);
 
+    void getUnreadCounters(const QString &address, const GetUnreadCountersCallback &callback);
+
     void getHistoryAddress(QString address, Message::Counter from, Message::Counter to, const GetMessagesCallback &callback);
 
     void getHistoryAddressAddress(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter from, Message::Counter to, const GetMessagesCallback &callback);
 
     void getHistoryAddressAddressCount(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter count, Message::Counter to, const GetMessagesCallback &callback);
 
+    void searchMessages(QString address, bool isChannel, const QString &collocutorOrChannel, const QString &text, qint64 offset, qint64 count, const GetMessagesCallback &callback);
+
 
     void createChannel(const QString &address, const QString &title, const QString &titleSha, const QString &pubkeyHex, const QString &signHex, uint64_t fee, const CreateChannelCallback &callback);
 
@@ -302,12 +273,16 @@ private slots:
 
     void onGetCountMessages(const QString &address, const QString &collocutor, Message::Counter from, const GetCountMessagesCallback &callback);
 
+    void onGetUnreadCounters(const QString &address, const GetUnreadCountersCallback &callback);
+
     void onGetHistoryAddress(QString address, Message::Counter from, Message::Counter to, const GetMessagesCallback &callback);
 
     void onGetHistoryAddressAddress(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter from, Message::Counter to, const GetMessagesCallback &callback);
 
     void onGetHistoryAddressAddressCount(QString address, bool isChannel, const QString &collocutorOrChannel, Message::Counter count, Message::Counter to, const GetMessagesCallback &callback);
 
+    void onSearchMessages(QString address, bool isChannel, const QString &collocutorOrChannel, const QString &text, qint64 offset, qint64 count, const GetMessagesCallback &callback);
+
 
     void onCreateChannel(const QString &address, const QString &title, const QString &titleSha, const QString &pubkeyHex, const QString &signHex, uint64_t fee, const CreateChannelCallback &callback);
 
@@ -340,15 +315,21 @@ private slots:
 
 private:
 
-    void getMessagesFromAddressFromWss(const QString &fromAddress, Message::Counter from, Message::Counter to);
+    size_t getMessagesFromAddressFromWss(const QString &fromAddress, Message::Counter from, Message::Counter to);
+
+    size_t getMessagesFromChannelFromWss(const QString &fromAddress, const QString &channelSha, Message::Counter from, Message::Counter to);
+
+    void requestGaps(const MessagesGapTracker::Key &key);
+
+    void finishGapRequest(size_t requestId);
 
-    void getMessagesFromChannelFromWss(const QString &fromAddress, const QString &channelSha, Message::Counter from, Message::Counter to);
+    void emitNewMessages(const QString &address, const QString &channel, Message::Counter lastCnt);
 
     void clearAddressesToMonitored();
 
     void addAddressToMonitored(const QString &address);
 
-    void processMessages(const QString &address, const std::vector<NewMessageResponse> &messages, bool isChannel);
+    void processMessages(const QString &address, const std::vector<NewMessageResponse> &messages, bool isChannel, size_t requestId);
 
     bool checkSignsAddress(const QString &address) const;
 
@@ -374,7 +355,7 @@ private:
 
     WebSocketClient wssClient;
 
-    std::map<std::pair<QString, QString>, DeferredMessage> deferredMessages;
+    MessagesGapTracker gapTracker;
 
     RequestId id;
 
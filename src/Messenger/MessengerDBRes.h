@@ -7,7 +7,7 @@ namespace messenger {
 
 static const QString databaseName = "messenger";
 static const QString databaseFileName = "messenger.db";
-static const int databaseVersion = 1;
+static const int databaseVersion = 3;
 
 static const QString createMsgUsersTable = "CREATE TABLE users ( "
                                            "id INTEGER PRIMARY KEY NOT NULL, "
@@ -78,7 +78,15 @@ static const QString createMsgMessageUniqueIndex2 = "CREATE UNIQUE INDEX message
                                                     "userid, channelid, morder, dt, isIncoming, "
                                                     "isConfirmed, hash, fee)";
 
-static const QString createMsgMessageCounterIndex = "CREATE INDEX messagesCounterIdx ON messages(morder)";
+// Индексы под запросы истории, счетчиков и поиска по хешу. Запросы без текста сообщений читают только индекс
+static const QString createMsgMessageUserCounterIndex = "CREATE INDEX messagesUserCounterIdx ON messages(userid, morder)";
+
+static const QString createMsgMessageUserConfirmedIndex = "CREATE INDEX messagesUserConfirmedIdx ON messages(userid, isConfirmed, morder)";
+
+static const QString createMsgMessageUserHashIndex = "CREATE INDEX messagesUserHashIdx ON messages(userid, hash, channelid, morder, isConfirmed)";
+
+static const QString createMsgMessageNotDecryptedIndex = "CREATE INDEX messagesNotDecryptedIdx ON messages(userid, morder) "
+                                                         "WHERE isDecrypted = 0 AND canDecrypted = 1";
 
 static const QString createMsgLastReadMessageTable = "CREATE TABLE lastreadmessage ( "
                                                         "id INTEGER PRIMARY KEY NOT NULL, "
@@ -86,6 +94,7 @@ static const QString createMsgLastReadMessageTable = "CREATE TABLE lastreadmessa
                                                         "contactid  INTEGER, "
                                                         "channelid  INTEGER, "
                                                         "lastcounter INT8, "
+                                                        "unreadcount INT8 NOT NULL DEFAULT 0, "
                                                         "FOREIGN KEY (userid) REFERENCES users(id), "
                                                         "FOREIGN KEY (contactid) REFERENCES contacts(id), "
                                                         "FOREIGN KEY (channelid) REFERENCES channels(id) "
@@ -109,59 +118,57 @@ static const QString insertMsgMessages = "INSERT OR IGNORE INTO messages "
 
 static const QString selectMsgMaxCounter = "SELECT IFNULL(MAX(m.morder), -1) AS max "
                                            "FROM messages m "
-                                           "INNER JOIN users u ON u.id = m.userid %1 "
-                                           "WHERE u.username = :user %2";
+                                           "WHERE m.userid = :userid %1";
 
 static const QString selectMsgMaxConfirmedCounter = "SELECT IFNULL(MAX(m.morder), -1) AS max "
                                                     "FROM messages m "
-                                                    "INNER JOIN users u ON u.id = m.userid "
                                                     "WHERE m.isConfirmed = 1 "
-                                                    "AND u.username = :user";
+                                                    "AND m.userid = :userid";
 
-static QString selectMsgMessagesForUser = "SELECT u.username AS user, du.username AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
+static QString selectMsgMessagesForUser = "SELECT m.id, u.username AS user, du.username AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
                                                 "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
                                                 "FROM messages m "
                                                 "INNER JOIN users u ON u.id = m.userid "
                                                 "INNER JOIN contacts du ON du.id = m.contactid "
                                                 "WHERE m.morder >= :ob AND m.morder <= :oe "
-                                                "AND u.username = :user "
+                                                "AND m.userid = :userid "
                                                 "ORDER BY m.morder";
 
-static const QString selectMsgMessagesForUserAndDest = "SELECT u.username AS user, c.username AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
+static const QString selectMsgMessagesForUserAndDest = "SELECT m.id, u.username AS user, c.username AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
                                                        "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
                                                        "FROM messages m "
                                                        "INNER JOIN users u ON u.id = m.userid "
                                                        "INNER JOIN contacts c ON c.id = m.contactid "
                                                        "WHERE m.morder >= :ob AND m.morder <= :oe "
-                                                       "AND u.username = :user AND c.username = :duser "
+                                                       "AND m.userid = :userid AND m.contactid = :contactid "
                                                        "ORDER BY m.morder";
 
-static const QString selectMsgMessagesForUserAndChannel = "SELECT u.username AS user, c.shaName AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
+static const QString selectMsgMessagesForUserAndChannel = "SELECT m.id, u.username AS user, c.shaName AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
                                                              "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
                                                              "FROM messages m "
                                                              "INNER JOIN users u ON u.id = m.userid "
                                                              "INNER JOIN channels c ON c.id = m.channelid "
                                                              "WHERE m.morder >= :ob AND m.morder <= :oe "
-                                                             "AND u.username = :user AND c.shaName = :shaName "
+                                                             "AND m.userid = :userid AND m.channelid = :channelid "
                                                              "ORDER BY m.morder";
 
-static const QString selectMsgMessagesForUserAndDestNum = "SELECT u.username AS user, c.username AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
+static const QString selectMsgMessagesForUserAndDestNum = "SELECT m.id, u.username AS user, c.username AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
                                                           "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
                                                           "FROM messages m "
                                                           "INNER JOIN users u ON u.id = m.userid "
                                                           "INNER JOIN contacts c ON c.id = m.contactid "
                                                           "WHERE m.morder <= :oe "
-                                                          "AND u.username = :user AND c.username = :duser "
+                                                          "AND m.userid = :userid AND m.contactid = :contactid "
                                                           "ORDER BY m.morder DESC "
                                                           "LIMIT :num";
 
-static const QString selectMsgMessagesForUserAndChannelNum = "SELECT u.username AS user, c.shaName AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
+static const QString selectMsgMessagesForUserAndChannelNum = "SELECT m.id, u.username AS user, c.shaName AS dest, m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
                                                           "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
                                                           "FROM messages m "
                                                           "INNER JOIN users u ON u.id = m.userid "
                                                           "INNER JOIN channels c ON c.id = m.channelid "
                                                           "WHERE m.morder <= :oe "
-                                                          "AND u.username = :user AND c.shaName = :shaName "
+                                                          "AND m.userid = :userid AND m.channelid = :channelid "
                                                           "ORDER BY m.morder DESC "
                                                           "LIMIT :num";
 
@@ -180,48 +187,41 @@ static const QString updateMsgContactsPublicKey = "UPDATE contacts SET publickey
 
 static const QString selectMsgCountMessagesForUserAndDest = "SELECT COUNT(*) AS count "
                                                        "FROM messages m "
-                                                       "INNER JOIN users u ON u.id = m.userid "
-                                                       "INNER JOIN contacts du ON du.id = m.contactid "
                                                        "WHERE m.morder >= :ob "
-                                                       "AND u.username = :user AND du.username = :duser";
+                                                       "AND m.userid = :userid AND m.contactid = :contactid";
 
 
 static const QString selectCountNotConfirmedMessagesWithHash = "SELECT (COUNT(*) > 0) AS res "
                                                         "FROM messages m "
-                                                        "INNER JOIN users u ON u.id = m.userid "
                                                         "WHERE m.isConfirmed = 0 "
                                                         "AND m.hash = :hash "
-                                                        "AND u.username = :user";
+                                                        "AND m.userid = :userid";
 
 static const QString selectCountMessagesWithCounter = "SELECT (COUNT(*) > 0) AS res "
                                                         "FROM messages m "
-                                                        "INNER JOIN users u ON u.id = m.userid %1 "
                                                         "WHERE m.morder = :counter "
-                                                        "AND u.username = :user %2 ";
+                                                        "AND m.userid = :userid %1 ";
 
 
 static const QString selectFirstNotConfirmedMessage = "SELECT m.id, m.morder "
                                                         "FROM messages m "
-                                                        "INNER JOIN users u ON u.id = m.userid "
                                                         "WHERE m.isConfirmed = 0 "
-                                                        "AND u.username = :user "
+                                                        "AND m.userid = :userid "
                                                         "ORDER BY m.morder "
                                                         "LIMIT 1";
 
 static const QString selectFirstNotConfirmedMessageWithHash = "SELECT m.id, m.morder "
                                                         "FROM messages m "
-                                                        "INNER JOIN users u ON u.id = m.userid %1 "
                                                         "WHERE m.isConfirmed = 0 "
                                                         "AND m.hash = :hash "
-                                                        "AND u.username = :user %2 "
+                                                        "AND m.userid = :userid %1 "
                                                         "ORDER BY m.morder "
                                                         "LIMIT 1";
 
 static const QString selectFirstMessageWithHash = "SELECT m.id, m.morder "
                                                         "FROM messages m "
-                                                        "INNER JOIN users u ON u.id = m.userid %1 "
                                                         "WHERE m.hash = :hash "
-                                                        "AND u.username = :user %2 "
+                                                        "AND m.userid = :userid %1 "
                                                         "ORDER BY m.morder "
                                                         "LIMIT 1";
 
@@ -239,19 +239,54 @@ static const QString selectLastReadCounterForUserChannel = "SELECT l.lastcounter
                                                             "INNER JOIN channels c ON c.id = l.channelid "
                                                             "WHERE u.username = :user AND c.shaName = :shaName";
 
+// unreadcount - количество сообщений диалога с morder больше lastcounter.
+// При вставке сообщения увеличивается на 1, при изменении lastcounter или morder пересчитывается по индексу messagesUniqueIdx1/2
+static const QString countUnreadForContact = "(SELECT COUNT(*) FROM messages m "
+                                                "WHERE m.userid = lastreadmessage.userid AND m.contactid = lastreadmessage.contactid "
+                                                "AND m.morder > lastreadmessage.lastcounter)";
+
+static const QString countUnreadForChannel = "(SELECT COUNT(*) FROM messages m "
+                                                "WHERE m.userid = lastreadmessage.userid AND m.channelid = lastreadmessage.channelid "
+                                                "AND m.morder > lastreadmessage.lastcounter)";
+
+// В SET подзапрос видит старое значение lastcounter, поэтому новое передается явно
 static const QString updateLastReadCounterForUserContact = "UPDATE lastreadmessage "
-                                                            "SET lastcounter = :counter "
-                                                            "WHERE id = (SELECT l.id FROM lastreadmessage l "
-                                                            "INNER JOIN users u ON u.id = l.userid "
-                                                            "INNER JOIN contacts c ON c.id = l.contactid "
-                                                            "WHERE u.username = :user AND c.username = :contact)";
+                                                            "SET lastcounter = :counter, unreadcount = (SELECT COUNT(*) FROM messages m "
+                                                            "WHERE m.userid = :userid AND m.contactid = :contactid AND m.morder > :counter) "
+                                                            "WHERE userid = :userid AND contactid = :contactid";
 
 static const QString updateLastReadCounterForUserChannel = "UPDATE lastreadmessage "
-                                                            "SET lastcounter = :counter "
-                                                            "WHERE id = (SELECT l.id FROM lastreadmessage l "
-                                                            "INNER JOIN users u ON u.id = l.userid "
-                                                            "INNER JOIN channels c ON c.id = l.channelid "
-                                                            "WHERE u.username = :user AND c.shaName = :shaName)";
+                                                            "SET lastcounter = :counter, unreadcount = (SELECT COUNT(*) FROM messages m "
+                                                            "WHERE m.userid = :userid AND m.channelid = :channelid AND m.morder > :counter) "
+                                                            "WHERE userid = :userid AND channelid = :channelid";
+
+static const QString updateUnreadCountForUserContact = "UPDATE lastreadmessage "
+                                                        "SET unreadcount = " + countUnreadForContact + " "
+                                                        "WHERE userid = :userid AND contactid = :contactid";
+
+static const QString updateUnreadCountForUserChannel = "UPDATE lastreadmessage "
+                                                        "SET unreadcount = " + countUnreadForChannel + " "
+                                                        "WHERE userid = :userid AND channelid = :channelid";
+
+static const QString incrementUnreadCountForUserContact = "UPDATE lastreadmessage "
+                                                            "SET unreadcount = unreadcount + 1 "
+                                                            "WHERE userid = :userid AND contactid = :contactid AND lastcounter < :counter";
+
+static const QString incrementUnreadCountForUserChannel = "UPDATE lastreadmessage "
+                                                            "SET unreadcount = unreadcount + 1 "
+                                                            "WHERE userid = :userid AND channelid = :channelid AND lastcounter < :counter";
+
+static const QString selectMessageDialog = "SELECT userid, contactid, channelid FROM messages WHERE id = :id";
+
+static const QString selectUnreadCounters = "SELECT c.username AS name, 0 AS isChannel, l.lastcounter, l.unreadcount "
+                                            "FROM lastreadmessage l "
+                                            "INNER JOIN contacts c ON c.id = l.contactid "
+                                            "WHERE l.userid = :userid "
+                                            "UNION ALL "
+                                            "SELECT c.shaName AS name, 1 AS isChannel, l.lastcounter, l.unreadcount "
+                                            "FROM lastreadmessage l "
+                                            "INNER JOIN channels c ON c.id = l.channelid "
+                                            "WHERE l.userid = :userid";
 
 static const QString selectLastReadMessageCount = "SELECT (COUNT(*) > 0) AS res FROM lastreadmessage "
                                                     "WHERE userid = :userid AND contactid = :contactid";
@@ -272,7 +307,7 @@ static const QString selectLastReadCountersForChannels = "SELECT c.shaName, l.la
                                                             "INNER JOIN channels c ON c.id = l.channelid "
                                                             "WHERE u.username = :user";
 
-static const QString selectChannelsWithLastReadCounters = "SELECT c.channel, c.shaName, c.adminName, c.isWriter, l.lastcounter "
+static const QString selectChannelsWithLastReadCounters = "SELECT c.channel, c.shaName, c.adminName, c.isWriter, l.lastcounter, l.unreadcount "
                                                             "FROM channels c "
                                                             "LEFT JOIN lastreadmessage l ON l.channelid = c.id "
                                                             "INNER JOIN users u ON u.id = c.userid "
@@ -317,7 +352,7 @@ static const QString updateChannelIsWriterForUserShaName = "UPDATE channels "
 
 //static const QString selectWhereIsChannel = "AND m.channelid IS NOT NULL";
 static const QString selectWhereIsNotChannel = "AND m.channelid IS NULL";
-static const QString selectJoinChannel = "INNER JOIN channels c ON c.id = m.channelid AND c.shaName = :channelSha";
+static const QString selectWhereChannel = "AND m.channelid = :channelid";
 
 static const QString removeDecryptedDataQuery = "UPDATE messages "
                                         "SET isDecrypted = 0, decryptedText = \'\' "
@@ -347,6 +382,35 @@ static const QString updateDecryptedMessageQuery = "UPDATE messages "
                                         "SET isDecrypted = :isDecrypted, decryptedText = :decryptedText "
                                         "WHERE id = :id";
 
+static const QString selectMsgSearchTableExist = "SELECT COUNT(*) AS count FROM sqlite_master "
+                                                    "WHERE type = 'table' AND name = 'messagesSearch'";
+
+static const QString createMsgSearchTable = "CREATE VIRTUAL TABLE messagesSearch USING fts5(text, tokenize = 'unicode61')";
+
+static const QString selectDecryptedMessagesForSearch = "SELECT id, decryptedText FROM messages "
+                                                        "WHERE isDecrypted = 1";
+
+static const QString insertMsgSearch = "INSERT INTO messagesSearch (rowid, text) VALUES (:id, :text)";
+
+static const QString deleteMsgSearch = "DELETE FROM messagesSearch WHERE rowid = :id";
+
+static const QString deleteAllMsgSearch = "DELETE FROM messagesSearch";
+
+static const QString selectMsgSearch = "SELECT m.id, u.username AS user, IFNULL(c.username, ch.shaName) AS dest, (m.channelid IS NOT NULL) AS isChannel, "
+                                        "m.isIncoming, m.text, m.decryptedText, m.isDecrypted, "
+                                        "m.morder, m.dt, m.fee, m.canDecrypted, m.isConfirmed, m.hash "
+                                        "FROM messagesSearch "
+                                        "INNER JOIN messages m ON m.id = messagesSearch.rowid "
+                                        "INNER JOIN users u ON u.id = m.userid "
+                                        "LEFT JOIN contacts c ON c.id = m.contactid "
+                                        "LEFT JOIN channels ch ON ch.id = m.channelid "
+                                        "WHERE messagesSearch MATCH :query "
+                                        "AND m.userid = :userid %1 "
+                                        "ORDER BY messagesSearch.rank "
+                                        "LIMIT :num OFFSET :offset";
+
+static const QString selectWhereContact = "AND m.contactid = :contactid";
+
 
 }
 
@@ -2,11 +2,15 @@
 
 #include "MessengerDBRes.h"
 #include <QtSql>
+#include <QRegExp>
 
 #include "check.h"
 #include "Log.h"
+#include "HexBase64.h"
 
 #include <iostream>
+#include <set>
+#include <tuple>
 
 SET_LOG_NAMESPACE("MSG");
 
@@ -29,83 +33,117 @@ void MessengerDBStorage::addMessage(const QString &user, const QString &duser, c
                                     bool canDecrypted, bool isConfirmed, const QString &hash,
                                     qint64 fee, const QString &channelSha)
 {
-    DbId userid = getUserId(user);
-    CHECK(userid != not_found, "User not created: " + user.toStdString());
-    DbId contactid = -1;
-    DbId channelid = -1;
-    if (channelSha.isEmpty()) {
-        CHECK(!duser.isEmpty(), "No contact or channel");
-        contactid = getContactIdOrCreate(duser);
-    } else {
-        channelid = getChannelForUserShaName(user, channelSha);
+    Message message;
+    message.username = user;
+    message.collocutor = duser;
+    message.dataHex = text;
+    message.decryptedDataHex = decryptedText;
+    message.isDecrypted = isDecrypted;
+    message.timestamp = timestamp;
+    message.counter = counter;
+    message.isInput = isIncoming;
+    message.isCanDecrypted = canDecrypted;
+    message.isConfirmed = isConfirmed;
+    message.hash = hash;
+    message.fee = fee;
+    message.channel = channelSha;
+    addMessage(message);
+}
+
+void MessengerDBStorage::addMessage(const Message &message) {
+    LastReadRecords lastReadRecords;
+    QSqlQuery query(database());
+    CHECK(query.prepare(insertMsgMessages), query.lastError().text().toStdString());
+    insertMessage(query, message, lastReadRecords);
+}
+
+void MessengerDBStorage::addMessages(const std::vector<Message> &messages) {
+    if (messages.empty()) {
+        return;
     }
 
+    LastReadRecords lastReadRecords;
+    auto transactionGuard = beginTransaction();
     QSqlQuery query(database());
     CHECK(query.prepare(insertMsgMessages), query.lastError().text().toStdString());
+    for (const Message &message: messages) {
+        insertMessage(query, message, lastReadRecords);
+    }
+    transactionGuard.commit();
+}
+
+void MessengerDBStorage::insertMessage(QSqlQuery &query, const Message &message, LastReadRecords &lastReadRecords) {
+    const DbId userid = getUserId(message.username);
+    CHECK(userid != not_found, "User not created: " + message.username.toStdString());
+
+    DbId contactid = -1;
+    DbId channelid = -1;
     query.bindValue(":userid", userid);
-    if (channelSha.isEmpty()) {
+    if (message.channel.isEmpty()) {
+        CHECK(!message.collocutor.isEmpty(), "No contact or channel");
+        contactid = getContactIdOrCreate(message.collocutor);
         CHECK(contactid != not_found, "Contact not created");
         query.bindValue(":contactid", contactid);
         query.bindValue(":channelid", QVariant());
     } else {
-        CHECK(channelid != not_found, "Channel not found " + channelSha.toStdString());
+        channelid = getChannelForUserShaName(message.username, message.channel);
+        CHECK(channelid != not_found, "Channel not found " + message.channel.toStdString());
         query.bindValue(":channelid", channelid);
         query.bindValue(":contactid", QVariant());
     }
-    query.bindValue(":order", counter);
-    query.bindValue(":dt", static_cast<qint64>(timestamp));
-    query.bindValue(":text", text);
-    query.bindValue(":decryptedText", decryptedText);
-    query.bindValue(":isDecrypted", isDecrypted);
-    query.bindValue(":isIncoming", isIncoming);
-    query.bindValue(":canDecrypted", canDecrypted);
-    query.bindValue(":isConfirmed", isConfirmed);
-    query.bindValue(":hash", hash);
-    query.bindValue(":fee", fee);
-    CHECK(query.exec(), query.lastError().text().toStdString());
-    addLastReadRecord(userid, contactid, channelid);
-}
-
-void MessengerDBStorage::addMessage(const Message &message) {
-    addMessage(message.username, message.collocutor, message.dataHex, message.decryptedDataHex, message.isDecrypted,
-               message.timestamp, message.counter, message.isInput,
-               message.isCanDecrypted, message.isConfirmed, message.hash,
-               message.fee, message.channel);
-}
-
-void MessengerDBStorage::addMessages(const std::vector<Message> &messages) {
-    auto transactionGuard = beginTransaction();
-    for (const Message &message: messages) {
-        addMessage(message);
+    // Запись lastreadmessage добавляется один раз на диалог, до первого сообщения, чтобы в ней считались непрочитанные
+    if (lastReadRecords.emplace(userid, contactid, channelid).second) {
+        addLastReadRecord(userid, contactid, channelid);
+    }
+    query.bindValue(":order", message.counter);
+    query.bindValue(":dt", static_cast<qint64>(message.timestamp));
+    query.bindValue(":text", message.dataHex);
+    query.bindValue(":decryptedText", message.decryptedDataHex);
+    query.bindValue(":isDecrypted", message.isDecrypted);
+    query.bindValue(":isIncoming", message.isInput);
+    query.bindValue(":canDecrypted", message.isCanDecrypted);
+    query.bindValue(":isConfirmed", message.isConfirmed);
+    query.bindValue(":hash", message.hash);
+    query.bindValue(":fee", static_cast<qint64>(message.fee));
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    if (query.numRowsAffected() > 0) {
+        if (message.isDecrypted) {
+            addToSearchIndex(query.lastInsertId().toLongLong(), message.decryptedDataHex);
+        }
+        incrementUnreadCount(userid, contactid, channelid, message.counter);
     }
-    transactionGuard.commit();
 }
 
 DBStorage::DbId MessengerDBStorage::getUserId(const QString &username) {
+    const auto found = cacheUserIds.find(username);
+    if (found != cacheUserIds.end()) {
+        return found->second;
+    }
     QSqlQuery query(database());
     CHECK(query.prepare(selectMsgUsersForName), query.lastError().text().toStdString());
     query.bindValue(":username", username);
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
-        return query.value("id").toLongLong();
+        const DbId id = query.value("id").toLongLong();
+        cacheUserIds[username] = id;
+        return id;
     } else {
         return not_found;
     }
 }
 
 DBStorage::DbId MessengerDBStorage::getUserIdOrCreate(const QString &username) {
+    const DbId id = getUserId(username);
+    if (id != not_found) {
+        return id;
+    }
     QSqlQuery query(database());
-    CHECK(query.prepare(selectMsgUsersForName), query.lastError().text().toStdString());
+    CHECK(query.prepare(insertMsgUsers), query.lastError().text().toStdString());
     query.bindValue(":username", username);
     CHECK(query.exec(), query.lastError().text().toStdString());
-    if (query.next()) {
-        return query.value("id").toLongLong();
-    } else {
-        CHECK(query.prepare(insertMsgUsers), query.lastError().text().toStdString());
-        query.bindValue(":username", username);
-        CHECK(query.exec(), query.lastError().text().toStdString());
-        return query.lastInsertId().toLongLong();
-    }
+    const DbId newId = query.lastInsertId().toLongLong();
+    cacheUserIds[username] = newId;
+    return newId;
 }
 
 QStringList MessengerDBStorage::getUsersList() {
@@ -119,21 +157,38 @@ QStringList MessengerDBStorage::getUsersList() {
     return res;
 }
 
-DBStorage::DbId MessengerDBStorage::getContactIdOrCreate(const QString &username) {
+DBStorage::DbId MessengerDBStorage::getContactId(const QString &username) {
+    const auto found = cacheContactIds.find(username);
+    if (found != cacheContactIds.end()) {
+        return found->second;
+    }
     QSqlQuery query(database());
     CHECK(query.prepare(selectMsgContactsForName), query.lastError().text().toStdString());
     query.bindValue(":username", username);
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
-        return query.value("id").toLongLong();
+        const DbId id = query.value("id").toLongLong();
+        cacheContactIds[username] = id;
+        return id;
     } else {
-        CHECK(query.prepare(insertMsgContacts), query.lastError().text().toStdString());
-        query.bindValue(":username", username);
-        CHECK(query.exec(), query.lastError().text().toStdString());
-        return query.lastInsertId().toLongLong();
+        return not_found;
     }
 }
 
+DBStorage::DbId MessengerDBStorage::getContactIdOrCreate(const QString &username) {
+    const DbId id = getContactId(username);
+    if (id != not_found) {
+        return id;
+    }
+    QSqlQuery query(database());
+    CHECK(query.prepare(insertMsgContacts), query.lastError().text().toStdString());
+    query.bindValue(":username", username);
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    const DbId newId = query.lastInsertId().toLongLong();
+    cacheContactIds[username] = newId;
+    return newId;
+}
+
 QString MessengerDBStorage::getUserPublicKey(const QString &username) {
     QSqlQuery query(database());
     CHECK(query.prepare(selectMsgUserPublicKey), query.lastError().text().toStdString());
@@ -230,12 +285,11 @@ void MessengerDBStorage::setContactPublicKey(const QString &username, const QStr
 Message::Counter MessengerDBStorage::getMessageMaxCounter(const QString &user, const QString &channelSha) {
     QSqlQuery query(database());
     const QString sql = selectMsgMaxCounter
-            .arg(channelSha.isEmpty() ? QStringLiteral("") : selectJoinChannel)
-            .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : QStringLiteral(""));
+            .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : selectWhereChannel);
     CHECK(query.prepare(sql), query.lastError().text().toStdString());
-    query.bindValue(":user", user);
+    query.bindValue(":userid", getUserId(user));
     if (!channelSha.isEmpty())
-        query.bindValue(":channelSha", channelSha);
+        query.bindValue(":channelid", getChannelForUserShaName(user, channelSha));
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
         return query.value("max").toLongLong();
@@ -246,7 +300,7 @@ Message::Counter MessengerDBStorage::getMessageMaxCounter(const QString &user, c
 Message::Counter MessengerDBStorage::getMessageMaxConfirmedCounter(const QString &user) {
     QSqlQuery query(database());
     CHECK(query.prepare(selectMsgMaxConfirmedCounter), query.lastError().text().toStdString());
-    query.bindValue(":user", user);
+    query.bindValue(":userid", getUserId(user));
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
         return query.value("max").toLongLong();
@@ -258,7 +312,7 @@ std::vector<Message> MessengerDBStorage::getMessagesForUser(const QString &user,
     std::vector<Message> res;
     QSqlQuery query(database());
     CHECK(query.prepare(selectMsgMessagesForUser), query.lastError().text().toStdString());
-    query.bindValue(":user", user);
+    query.bindValue(":userid", getUserId(user));
     query.bindValue(":ob", from);
     query.bindValue(":oe", to);
     CHECK(query.exec(), query.lastError().text().toStdString());
@@ -275,11 +329,11 @@ std::vector<Message> MessengerDBStorage::getMessagesForUserAndDest(const QString
     } else {
         CHECK(query.prepare(selectMsgMessagesForUserAndDest), query.lastError().text().toStdString());
     }
-    query.bindValue(":user", user);
+    query.bindValue(":userid", getUserId(user));
     if (isChannel)
-        query.bindValue(":shaName", channelOrContact);
+        query.bindValue(":channelid", getChannelForUserShaName(user, channelOrContact));
     else
-        query.bindValue(":duser", channelOrContact);
+        query.bindValue(":contactid", getContactId(channelOrContact));
     query.bindValue(":ob", from);
     query.bindValue(":oe", to);
     CHECK(query.exec(), query.lastError().text().toStdString());
@@ -296,11 +350,11 @@ std::vector<Message> MessengerDBStorage::getMessagesForUserAndDestNum(const QStr
     } else {
         CHECK(query.prepare(selectMsgMessagesForUserAndDestNum), query.lastError().text().toStdString());
     }
-    query.bindValue(":user", user);
+    query.bindValue(":userid", getUserId(user));
     if (isChannel) {
-        query.bindValue(":shaName", channelOrContact);
+        query.bindValue(":channelid", getChannelForUserShaName(user, channelOrContact));
     } else {
-        query.bindValue(":duser", channelOrContact);
+        query.bindValue(":contactid", getContactId(channelOrContact));
     }
     query.bindValue(":oe", to);
     query.bindValue(":num", num);
@@ -313,8 +367,8 @@ std::vector<Message> MessengerDBStorage::getMessagesForUserAndDestNum(const QStr
 qint64 MessengerDBStorage::getMessagesCountForUserAndDest(const QString &user, const QString &duser, qint64 from) {
     QSqlQuery query(database());
     CHECK(query.prepare(selectMsgCountMessagesForUserAndDest), query.lastError().text().toStdString());
-    query.bindValue(":user", user);
-    query.bindValue(":duser", duser);
+    query.bindValue(":userid", getUserId(user));
+    query.bindValue(":contactid", getContactId(duser));
     query.bindValue(":ob", from);
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
@@ -326,13 +380,12 @@ qint64 MessengerDBStorage::getMessagesCountForUserAndDest(const QString &user, c
 bool MessengerDBStorage::hasMessageWithCounter(const QString &username, Message::Counter counter, const QString &channelSha) {
     QSqlQuery query(database());
     const QString sql = selectCountMessagesWithCounter
-            .arg(channelSha.isEmpty() ? QStringLiteral("") : selectJoinChannel)
-            .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : QStringLiteral(""));
+            .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : selectWhereChannel);
     CHECK(query.prepare(sql), query.lastError().text().toStdString());
-    query.bindValue(":user", username);
+    query.bindValue(":userid", getUserId(username));
     query.bindValue(":counter", counter);
     if (!channelSha.isEmpty())
-        query.bindValue(":channelSha", channelSha);
+        query.bindValue(":channelid", getChannelForUserShaName(username, channelSha));
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
         return query.value("res").toBool();
@@ -343,7 +396,7 @@ bool MessengerDBStorage::hasMessageWithCounter(const QString &username, Message:
 bool MessengerDBStorage::hasUnconfirmedMessageWithHash(const QString &username, const QString &hash) {
     QSqlQuery query(database());
     CHECK(query.prepare(selectCountNotConfirmedMessagesWithHash), query.lastError().text().toStdString());
-    query.bindValue(":user", username);
+    query.bindValue(":userid", getUserId(username));
     query.bindValue(":hash", hash);
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
@@ -355,13 +408,12 @@ bool MessengerDBStorage::hasUnconfirmedMessageWithHash(const QString &username,
 MessengerDBStorage::IdCounterPair MessengerDBStorage::findFirstNotConfirmedMessageWithHash(const QString &username, const QString &hash, const QString &channelSha) {
     QSqlQuery query(database());
     const QString sql = selectFirstNotConfirmedMessageWithHash
-    .arg(channelSha.isEmpty() ? QStringLiteral("") : selectJoinChannel)
-    .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : QStringLiteral(""));
+    .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : selectWhereChannel);
     CHECK(query.prepare(sql), query.lastError().text().toStdString());
-    query.bindValue(":user", username);
+    query.bindValue(":userid", getUserId(username));
     query.bindValue(":hash", hash);
     if (!channelSha.isEmpty())
-        query.bindValue(":channelSha", channelSha);
+        query.bindValue(":channelid", getChannelForUserShaName(username, channelSha));
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
         return MessengerDBStorage::IdCounterPair(query.value("id").toLongLong(),
@@ -373,13 +425,12 @@ MessengerDBStorage::IdCounterPair MessengerDBStorage::findFirstNotConfirmedMessa
 MessengerDBStorage::IdCounterPair MessengerDBStorage::findFirstMessageWithHash(const QString &username, const QString &hash, const QString &channelSha) {
     QSqlQuery query(database());
     const QString sql = selectFirstMessageWithHash
-    .arg(channelSha.isEmpty() ? QStringLiteral("") : selectJoinChannel)
-    .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : QStringLiteral(""));
+    .arg(channelSha.isEmpty() ? selectWhereIsNotChannel : selectWhereChannel);
     CHECK(query.prepare(sql), query.lastError().text().toStdString());
-    query.bindValue(":user", username);
+    query.bindValue(":userid", getUserId(username));
     query.bindValue(":hash", hash);
     if (!channelSha.isEmpty())
-        query.bindValue(":channelSha", channelSha);
+        query.bindValue(":channelid", getChannelForUserShaName(username, channelSha));
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
         return MessengerDBStorage::IdCounterPair(query.value("id").toLongLong(),
@@ -391,7 +442,7 @@ MessengerDBStorage::IdCounterPair MessengerDBStorage::findFirstMessageWithHash(c
 DBStorage::DbId MessengerDBStorage::findFirstNotConfirmedMessage(const QString &username) {
     QSqlQuery query(database());
     CHECK(query.prepare(selectFirstNotConfirmedMessage), query.lastError().text().toStdString());
-    query.bindValue(":user", username);
+    query.bindValue(":userid", getUserId(username));
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
         return query.value("id").toLongLong();
@@ -405,8 +456,21 @@ void MessengerDBStorage::updateMessage(DbId id, Message::Counter newCounter, boo
     query.bindValue(":id", id);
     query.bindValue(":counter", newCounter);
     query.bindValue(":isConfirmed", confirmed);
-    query.exec();
+    if (!query.exec()) {
+        return;
+    }
     //CHECK(query.exec(), query.lastError().text().toStdString());
+
+    // morder изменился, поэтому непрочитанные диалога пересчитываются
+    QSqlQuery dialogQuery(database());
+    CHECK(dialogQuery.prepare(selectMessageDialog), dialogQuery.lastError().text().toStdString());
+    dialogQuery.bindValue(":id", id);
+    CHECK(dialogQuery.exec(), dialogQuery.lastError().text().toStdString());
+    if (dialogQuery.next()) {
+        const QVariant contactid = dialogQuery.value("contactid");
+        const QVariant channelid = dialogQuery.value("channelid");
+        updateUnreadCount(dialogQuery.value("userid").toLongLong(), contactid.isNull() ? -1 : contactid.toLongLong(), channelid.isNull() ? -1 : channelid.toLongLong());
+    }
 }
 
 Message::Counter MessengerDBStorage::getLastReadCounterForUserContact(const QString &username, const QString &channelOrContact, bool isChannel) {
@@ -436,11 +500,11 @@ void MessengerDBStorage::setLastReadCounterForUserContact(const QString &usernam
         CHECK(query.prepare(updateLastReadCounterForUserContact), query.lastError().text().toStdString());
     }
     query.bindValue(":counter", counter);
-    query.bindValue(":user", username);
+    query.bindValue(":userid", getUserId(username));
     if (isChannel)
-        query.bindValue(":shaName", channelOrContact);
+        query.bindValue(":channelid", getChannelForUserShaName(username, channelOrContact));
     else
-        query.bindValue(":contact", channelOrContact);
+        query.bindValue(":contactid", getContactId(channelOrContact));
     CHECK(query.exec(), query.lastError().text().toStdString());
 }
 
@@ -482,12 +546,30 @@ std::vector<messenger::ChannelInfo> messenger::MessengerDBStorage::getChannelsWi
         info.titleSha = query.value("shaName").toString();
         info.admin = query.value("adminName").toString();
         info.counter = query.value("lastcounter").toLongLong();
+        info.unreadCount = query.value("unreadcount").toLongLong();
         info.isWriter = query.value("isWriter").toBool();
         res.push_back(info);
     }
     return res;
 }
 
+std::vector<UnreadCounter> MessengerDBStorage::getUnreadCounters(const QString &username) {
+    std::vector<UnreadCounter> res;
+    QSqlQuery query(database());
+    CHECK(query.prepare(selectUnreadCounters), query.lastError().text().toStdString());
+    query.bindValue(":userid", getUserId(username));
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    while (query.next()) {
+        UnreadCounter counter;
+        counter.name = query.value("name").toString();
+        counter.isChannel = query.value("isChannel").toBool();
+        counter.lastCounter = query.value("lastcounter").toLongLong();
+        counter.unreadCount = query.value("unreadcount").toLongLong();
+        res.push_back(counter);
+    }
+    return res;
+}
+
 void MessengerDBStorage::addChannel(DBStorage::DbId userid, const QString &channel, const QString &shaName, bool isAdmin, const QString &adminName, bool isBanned, bool isWriter, bool isVisited) {
     QSqlQuery query(database());
     CHECK(query.prepare(insertMsgChannels), query.lastError().text().toStdString());
@@ -502,6 +584,13 @@ void MessengerDBStorage::addChannel(DBStorage::DbId userid, const QString &chann
     CHECK(query.exec(), query.lastError().text().toStdString());
     DBStorage::DbId id = query.lastInsertId().toLongLong();
     addLastReadRecord(userid, -1, id);
+    for (auto it = cacheChannelIds.begin(); it != cacheChannelIds.end();) {
+        if (it->first.second == shaName) {
+            it = cacheChannelIds.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 void MessengerDBStorage::setChannelsNotVisited(const QString &user) {
@@ -512,13 +601,20 @@ void MessengerDBStorage::setChannelsNotVisited(const QString &user) {
 }
 
 DBStorage::DbId MessengerDBStorage::getChannelForUserShaName(const QString &user, const QString &shaName) {
+    const auto key = std::make_pair(user, shaName);
+    const auto found = cacheChannelIds.find(key);
+    if (found != cacheChannelIds.end()) {
+        return found->second;
+    }
     QSqlQuery query(database());
     CHECK(query.prepare(selectChannelForUserShaName), query.lastError().text().toStdString());
     query.bindValue(":user", user);
     query.bindValue(":shaName", shaName);
     CHECK(query.exec(), query.lastError().text().toStdString());
     if (query.next()) {
-        return query.value("id").toLongLong();
+        const DbId id = query.value("id").toLongLong();
+        cacheChannelIds[key] = id;
+        return id;
     }
     return -1;
 }
@@ -568,6 +664,10 @@ void MessengerDBStorage::removeDecryptedData() {
     QSqlQuery query(database());
     CHECK(query.prepare(removeDecryptedDataQuery), query.lastError().text().toStdString());
     CHECK(query.exec(), query.lastError().text().toStdString());
+    if (isSearchEnabled_) {
+        CHECK(query.prepare(deleteAllMsgSearch), query.lastError().text().toStdString());
+        CHECK(query.exec(), query.lastError().text().toStdString());
+    }
 }
 
 std::pair<std::vector<MessengerDBStorage::DbId>, std::vector<Message>> MessengerDBStorage::getNotDecryptedMessage(const QString &user) {
@@ -611,8 +711,111 @@ void MessengerDBStorage::updateDecryptedMessage(const std::vector<std::tuple<DbI
         query.bindValue(":isDecrypted", std::get<1>(messageTuple));
         query.bindValue(":decryptedText", std::get<2>(messageTuple));
         query.exec();
+
+        removeFromSearchIndex(std::get<0>(messageTuple));
+        if (std::get<1>(messageTuple)) {
+            addToSearchIndex(std::get<0>(messageTuple), std::get<2>(messageTuple));
+        }
+    }
+    transactionGuard.commit();
+}
+
+static QString makeSearchQuery(const QString &text) {
+    // Каждое слово превращаем в строку fts5, чтобы пользовательский ввод не разбирался как синтаксис запроса
+    QStringList words;
+    for (const QString &word: text.split(QRegExp("\\s+"), QString::SkipEmptyParts)) {
+        words.append("\"" + QString(word).replace("\"", "\"\"") + "\"");
+    }
+    return words.join(" ");
+}
+
+std::vector<Message> MessengerDBStorage::searchMessages(const QString &user, const QString &channelOrContact, bool isChannel, const QString &text, qint64 offset, qint64 num) {
+    CHECK(isSearchEnabled_, "Full text search not supported");
+    const QString searchQuery = makeSearchQuery(text);
+    std::vector<Message> res;
+    if (searchQuery.isEmpty()) {
+        return res;
+    }
+
+    QString where;
+    if (!channelOrContact.isEmpty()) {
+        where = isChannel ? selectWhereChannel : selectWhereContact;
+    }
+    QSqlQuery query(database());
+    CHECK(query.prepare(selectMsgSearch.arg(where)), query.lastError().text().toStdString());
+    query.bindValue(":query", searchQuery);
+    query.bindValue(":userid", getUserId(user));
+    if (!channelOrContact.isEmpty()) {
+        if (isChannel) {
+            query.bindValue(":channelid", getChannelForUserShaName(user, channelOrContact));
+        } else {
+            query.bindValue(":contactid", getContactId(channelOrContact));
+        }
+    }
+    query.bindValue(":num", num);
+    query.bindValue(":offset", offset);
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    while (query.next()) {
+        res.emplace_back(readMessage(query, query.value("isChannel").toBool()));
+    }
+    return res;
+}
+
+static QString decryptedTextToSearchText(const QString &decryptedText) {
+    const QByteArray hex = decryptedText.toLatin1();
+    std::string text;
+    appendFromHex(hex.constData(), hex.size(), text);
+    return QString::fromUtf8(text.data(), (int)text.size());
+}
+
+void MessengerDBStorage::addToSearchIndex(DbId id, const QString &decryptedText) {
+    if (!isSearchEnabled_ || decryptedText.isEmpty()) {
+        return;
+    }
+    QSqlQuery query(database());
+    CHECK(query.prepare(insertMsgSearch), query.lastError().text().toStdString());
+    query.bindValue(":id", id);
+    query.bindValue(":text", decryptedTextToSearchText(decryptedText));
+    CHECK(query.exec(), query.lastError().text().toStdString());
+}
+
+void MessengerDBStorage::removeFromSearchIndex(DbId id) {
+    if (!isSearchEnabled_) {
+        return;
+    }
+    QSqlQuery query(database());
+    CHECK(query.prepare(deleteMsgSearch), query.lastError().text().toStdString());
+    query.bindValue(":id", id);
+    CHECK(query.exec(), query.lastError().text().toStdString());
+}
+
+void MessengerDBStorage::onInitialized() {
+    QSqlQuery query(database());
+    CHECK(query.prepare(selectMsgSearchTableExist), query.lastError().text().toStdString());
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    CHECK(query.next(), "Incorrect query");
+    if (query.value("count").toLongLong() > 0) {
+        isSearchEnabled_ = true;
+        return;
+    }
+
+    if (!query.prepare(createMsgSearchTable) || !query.exec()) {
+        LOG << "Full text search not supported: " << query.lastError().text();
+        return;
+    }
+
+    // Индекс появился в уже существующей базе, заполняем его сохраненными сообщениями
+    isSearchEnabled_ = true;
+    auto transactionGuard = beginTransaction();
+    CHECK(query.prepare(selectDecryptedMessagesForSearch), query.lastError().text().toStdString());
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    size_t count = 0;
+    while (query.next()) {
+        addToSearchIndex(query.value("id").toLongLong(), query.value("decryptedText").toString());
+        count++;
     }
     transactionGuard.commit();
+    LOG << "Messages search index created " << count;
 }
 
 void messenger::MessengerDBStorage::createDatabase() {
@@ -628,36 +831,44 @@ void messenger::MessengerDBStorage::createDatabase() {
     createIndex(createContactsUniqueIndex);
     createIndex(createMsgMessageUniqueIndex1);
     createIndex(createMsgMessageUniqueIndex2);
-    createIndex(createMsgMessageCounterIndex);
+    createIndex(createMsgMessageUserCounterIndex);
+    createIndex(createMsgMessageUserConfirmedIndex);
+    createIndex(createMsgMessageUserHashIndex);
+    createIndex(createMsgMessageNotDecryptedIndex);
     createIndex(createChannelsUniqueIndex);
 
     createIndex(createLastReadMessageUniqueIndex1);
     createIndex(createLastReadMessageUniqueIndex2);
 }
 
+Message MessengerDBStorage::readMessage(const QSqlQuery &query, bool isChannel) {
+    Message msg;
+    msg.username = query.value("user").toString();
+    msg.isChannel = isChannel;
+    if (msg.isChannel) {
+        msg.channel = query.value("dest").toString();
+        msg.collocutor = QString("");
+    } else {
+        msg.collocutor = query.value("dest").toString();
+        msg.channel = QString("");
+    }
+    msg.isInput = query.value("isIncoming").toBool();
+    msg.dataHex = query.value("text").toString();
+    msg.decryptedDataHex = query.value("decryptedText").toString();
+    msg.isDecrypted = query.value("isDecrypted").toBool();
+    msg.counter = query.value("morder").toLongLong();
+    msg.timestamp = static_cast<quint64>(query.value("dt").toLongLong());
+    msg.fee = query.value("fee").toLongLong();
+    msg.isCanDecrypted = query.value("canDecrypted").toBool();
+    msg.isConfirmed = query.value("isConfirmed").toBool();
+    msg.hash = query.value("hash").toString();
+    msg.dbId = query.value("id").toLongLong();
+    return msg;
+}
+
 void MessengerDBStorage::createMessagesList(QSqlQuery &query, std::vector<Message> &messages, std::vector<DbId> &ids, bool isIds, bool isChannel, bool reverse) {
     while (query.next()) {
-        Message msg;
-        msg.username = query.value("user").toString();
-        msg.isChannel = isChannel;
-        if (msg.isChannel) {
-            msg.channel = query.value("dest").toString();
-            msg.collocutor = QString("");
-        } else {
-            msg.collocutor = query.value("dest").toString();
-            msg.channel = QString("");
-        }
-        msg.isInput = query.value("isIncoming").toBool();
-        msg.dataHex = query.value("text").toString();
-        msg.decryptedDataHex = query.value("decryptedText").toString();
-        msg.isDecrypted = query.value("isDecrypted").toBool();
-        msg.counter = query.value("morder").toLongLong();
-        msg.timestamp = static_cast<quint64>(query.value("dt").toLongLong());
-        msg.fee = query.value("fee").toLongLong();
-        msg.isCanDecrypted = query.value("canDecrypted").toBool();
-        msg.isConfirmed = query.value("isConfirmed").toBool();
-        msg.hash = query.value("hash").toString();
-        messages.push_back(msg);
+        messages.push_back(readMessage(query, isChannel));
 
         if (isIds) {
             ids.emplace_back(query.value("id").toLongLong());
@@ -669,6 +880,13 @@ void MessengerDBStorage::createMessagesList(QSqlQuery &query, std::vector<Messag
     }
 }
 
+void MessengerDBStorage::onTransactionRollback() {
+    // Идентификаторы, созданные внутри откаченной транзакции, больше не существуют
+    cacheUserIds.clear();
+    cacheContactIds.clear();
+    cacheChannelIds.clear();
+}
+
 void MessengerDBStorage::addLastReadRecord(DBStorage::DbId userid, DBStorage::DbId contactid, DBStorage::DbId channelid) {
     QSqlQuery query(database());
     CHECK(query.prepare(insertLastReadMessageRecord), query.lastError().text().toStdString());
@@ -686,4 +904,31 @@ void MessengerDBStorage::addLastReadRecord(DBStorage::DbId userid, DBStorage::Db
     CHECK(query.exec(), query.lastError().text().toStdString());
 }
 
+void MessengerDBStorage::incrementUnreadCount(DBStorage::DbId userid, DBStorage::DbId contactid, DBStorage::DbId channelid, Message::Counter counter) {
+    QSqlQuery query(database());
+    if (channelid == -1) {
+        CHECK(query.prepare(incrementUnreadCountForUserContact), query.lastError().text().toStdString());
+        query.bindValue(":contactid", contactid);
+    } else {
+        CHECK(query.prepare(incrementUnreadCountForUserChannel), query.lastError().text().toStdString());
+        query.bindValue(":channelid", channelid);
+    }
+    query.bindValue(":userid", userid);
+    query.bindValue(":counter", counter);
+    CHECK(query.exec(), query.lastError().text().toStdString());
+}
+
+void MessengerDBStorage::updateUnreadCount(DBStorage::DbId userid, DBStorage::DbId contactid, DBStorage::DbId channelid) {
+    QSqlQuery query(database());
+    if (channelid == -1) {
+        CHECK(query.prepare(updateUnreadCountForUserContact), query.lastError().text().toStdString());
+        query.bindValue(":contactid", contactid);
+    } else {
+        CHECK(query.prepare(updateUnreadCountForUserChannel), query.lastError().text().toStdString());
+        query.bindValue(":channelid", channelid);
+    }
+    query.bindValue(":userid", userid);
+    CHECK(query.exec(), query.lastError().text().toStdString());
+}
+
 }
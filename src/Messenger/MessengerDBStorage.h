@@ -5,6 +5,10 @@
 
 #include "Message.h"
 
+#include <map>
+#include <set>
+#include <tuple>
+
 namespace messenger {
 
 class MessengerDBStorage : public DBStorage
@@ -24,12 +28,14 @@ public:
 
     void addMessage(const Message &message);
 
+    // Добавляет пачку сообщений в одной транзакции
     void addMessages(const std::vector<Message> &messages);
 
     DbId getUserId(const QString &username);
     DbId getUserIdOrCreate(const QString &username);
     QStringList getUsersList();
 
+    DbId getContactId(const QString &username);
     DbId getContactIdOrCreate(const QString &username);
 
     QString getUserPublicKey(const QString &username);
@@ -64,6 +70,8 @@ public:
     std::vector<NameCounterPair> getLastReadCountersForContacts(const QString &username);
     std::vector<NameCounterPair> getLastReadCountersForChannels(const QString &username);
     std::vector<ChannelInfo> getChannelsWithLastReadCounters(const QString &username);
+    // Счетчики непрочитанных для всех контактов и каналов пользователя одним запросом
+    std::vector<UnreadCounter> getUnreadCounters(const QString &username);
 
     void addChannel(DbId userid, const QString &channel, const QString &shaName, bool isAdmin, const QString &adminName, bool isBanned, bool isWriter, bool isVisited);
     void setChannelsNotVisited(const QString &user);
@@ -80,12 +88,43 @@ public:
 
     void updateDecryptedMessage(const std::vector<std::tuple<DbId, bool, QString>> &messages);
 
+    bool isSearchEnabled() const {
+        return isSearchEnabled_;
+    }
+
+    // Полнотекстовый поиск по расшифрованным сообщениям, результаты отсортированы по релевантности.
+    // Если channelOrContact пустой, поиск идет по всем диалогам пользователя
+    std::vector<Message> searchMessages(const QString &user, const QString &channelOrContact, bool isChannel, const QString &text, qint64 offset, qint64 num);
+
 protected:
     virtual void createDatabase() final;
+    virtual void onTransactionRollback() final;
+    virtual void onInitialized() final;
+
+private:
+    // Пользователь, контакт и канал диалогов, для которых уже добавлена запись lastreadmessage
+    using LastReadRecords = std::set<std::tuple<DbId, DbId, DbId>>;
 
 private:
+    static Message readMessage(const QSqlQuery &query, bool isChannel);
+    // Привязывает поля сообщения к подготовленному insertMsgMessages и выполняет его
+    void insertMessage(QSqlQuery &query, const Message &message, LastReadRecords &lastReadRecords);
     void createMessagesList(QSqlQuery &query, std::vector<Message> &messages, std::vector<DbId> &ids, bool isIDs, bool isChannel, bool reverse);
     void addLastReadRecord(DbId userid, DbId contactid, DBStorage::DbId channelid);
+    void incrementUnreadCount(DbId userid, DbId contactid, DbId channelid, Message::Counter counter);
+    void updateUnreadCount(DbId userid, DbId contactid, DbId channelid);
+
+    void addToSearchIndex(DbId id, const QString &decryptedText);
+    void removeFromSearchIndex(DbId id);
+
+private:
+    // Идентификаторы не меняются после вставки, поэтому кешируются только найденные значения
+    std::map<QString, DbId> cacheUserIds;
+    std::map<QString, DbId> cacheContactIds;
+    std::map<std::pair<QString, QString>, DbId> cacheChannelIds;
+
+    // Индекс fts5 создается, только если его поддерживает sqlite
+    bool isSearchEnabled_ = false;
 };
 
 }
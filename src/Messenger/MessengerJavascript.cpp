@@ -114,6 +114,7 @@ static QJsonDocument channelListToJson(const std::vector<ChannelInfo> &channels)
         messageJson.insert("admin", channel.admin);
         messageJson.insert("isWriter", channel.isWriter);
         messageJson.insert("saved_pos", QString::fromStdString(std::to_string(channel.counter)));
+        messageJson.insert("unread_count", QString::fromStdString(std::to_string(channel.unreadCount)));
         messageJson.insert("fee", QString::fromStdString(std::to_string(channel.fee)));
         messagesArrJson.push_back(messageJson);
     }
@@ -131,6 +132,19 @@ static QJsonDocument allPosToJson(const std::vector<std::pair<QString, Message::
     return QJsonDocument(messagesArrJson);
 }
 
+static QJsonDocument unreadCountersToJson(const std::vector<UnreadCounter> &counters) {
+    QJsonArray countersArrJson;
+    for (const UnreadCounter &counter: counters) {
+        QJsonObject counterJson;
+        counterJson.insert("address", counter.name);
+        counterJson.insert("isChannel", counter.isChannel);
+        counterJson.insert("saved_pos", QString::fromStdString(std::to_string(counter.lastCounter)));
+        counterJson.insert("unread_count", QString::fromStdString(std::to_string(counter.unreadCount)));
+        countersArrJson.push_back(counterJson);
+    }
+    return QJsonDocument(countersArrJson);
+}
+
 void MessengerJavascript::getHistoryAddress(QString address, QString from, QString to) {
 BEGIN_SLOT_WRAPPER
     CHECK(messenger != nullptr, "Messenger not set");
@@ -242,6 +256,41 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void MessengerJavascript::searchMessages(QString address, QString collocutorOrChannel, bool isChannel, QString text, QString offset, QString count) {
+BEGIN_SLOT_WRAPPER
+    CHECK(messenger != nullptr, "Messenger not set");
+
+    const QString JS_NAME_RESULT = "msgSearchMessagesJs";
+
+    const auto makeFunc = [JS_NAME_RESULT, this](const TypedException &exception, const QString &address, const QString &text, const QJsonDocument &result) {
+        makeAndRunJsFuncParams(JS_NAME_RESULT, exception, address, text, result);
+    };
+
+    const auto errorFunc = [address, text, makeFunc](const TypedException &exception) {
+        makeFunc(exception, address, text, QJsonDocument());
+    };
+
+    LOG << "search messages " << address << " " << collocutorOrChannel << " " << isChannel << " " << offset << " " << count;
+
+    const TypedException exception = apiVrapper2([&, this](){
+        bool isValid;
+        const qint64 offsetI = offset.toLongLong(&isValid);
+        CHECK(isValid, "offset field incorrect");
+        const qint64 countI = count.toLongLong(&isValid);
+        CHECK(isValid, "count field incorrect");
+
+        emit messenger->searchMessages(address, isChannel, collocutorOrChannel, text, offsetI, countI, Messenger::GetMessagesCallback([address, text, makeFunc](const std::vector<Message> &messages) {
+            LOG << "search messages ok " << address << " " << messages.size();
+            makeFunc(TypedException(), address, text, messagesToJson(messages));
+        }, errorFunc, signalFunc));
+    });
+
+    if (exception.isSet()) {
+        makeFunc(exception, address, text, QJsonDocument());
+    }
+END_SLOT_WRAPPER
+}
+
 void MessengerJavascript::sendPubkeyAddressToBlockchain(QString address, QString feeStr, QString paramsJson) {
 BEGIN_SLOT_WRAPPER
     CHECK(messenger != nullptr, "Messenger not set");
@@ -655,6 +704,35 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void MessengerJavascript::getUnreadCounters(QString address) {
+BEGIN_SLOT_WRAPPER
+    CHECK(messenger != nullptr, "Messenger not set");
+
+    const QString JS_NAME_RESULT = "msgUnreadCountersJs";
+
+    const auto makeFunc = [JS_NAME_RESULT, this](const TypedException &exception, const QString &address, const QJsonDocument &result) {
+        makeAndRunJsFuncParams(JS_NAME_RESULT, exception, address, result);
+    };
+
+    const auto errorFunc = [address, makeFunc](const TypedException &exception) {
+        makeFunc(exception, address, QJsonDocument());
+    };
+
+    LOG << "getUnreadCounters " << address;
+
+    const TypedException exception = apiVrapper2([&, this](){
+        emit messenger->getUnreadCounters(address, Messenger::GetUnreadCountersCallback([this, makeFunc, address](const std::vector<UnreadCounter> &counters) {
+            LOG << "getUnreadCounters ok " << address << " " << counters.size();
+            makeFunc(TypedException(), address, unreadCountersToJson(counters));
+        }, errorFunc, signalFunc));
+    });
+
+    if (exception.isSet()) {
+        makeFunc(exception, address, QJsonDocument());
+    }
+END_SLOT_WRAPPER
+}
+
 void MessengerJavascript::createChannel(QString address, QString channelTitle, QString fee) {
 BEGIN_SLOT_WRAPPER
     CHECK(messenger != nullptr, "Messenger not set");
@@ -1137,6 +1215,36 @@ BEGIN_SLOT_WRAPPER
 END_SLOT_WRAPPER
 }
 
+void MessengerJavascript::getDecryptedCacheInfo() {
+BEGIN_SLOT_WRAPPER
+    const QString JS_NAME_RESULT = "msgDecryptedCacheInfoResultJs";
+
+    const auto errorFunc = [this, JS_NAME_RESULT](const TypedException &exception) {
+        makeAndRunJsFuncParams(JS_NAME_RESULT, exception, QJsonDocument());
+    };
+
+    LOG << "Decrypted cache info";
+    const TypedException exception = apiVrapper2([&, this](){
+        emit cryptoManager.getDecryptedCacheInfo(CryptographicManager::DecryptedCacheInfoCallback([this, JS_NAME_RESULT](const DecryptedMessagesCache::Info &info) {
+            QJsonObject result;
+            result.insert("enabled", info.maxMemorySize != 0);
+            result.insert("count", (int)info.countElements);
+            result.insert("memory", (qint64)info.memorySize);
+            result.insert("maxMemory", (qint64)info.maxMemorySize);
+            result.insert("hits", (qint64)info.countHits);
+            result.insert("misses", (qint64)info.countMisses);
+            const size_t countRequests = info.countHits + info.countMisses;
+            result.insert("hitRate", countRequests == 0 ? 0. : double(info.countHits) / countRequests);
+            makeAndRunJsFuncParams(JS_NAME_RESULT, TypedException(), QJsonDocument(result));
+        }, errorFunc, signalFunc));
+    });
+
+    if (exception.isSet()) {
+        errorFunc(exception);
+    }
+END_SLOT_WRAPPER
+}
+
 void MessengerJavascript::reEmit() {
 BEGIN_SLOT_WRAPPER
     LOG << "Messenger Reemit";
@@ -87,6 +87,8 @@ public slots:
 
     Q_INVOKABLE void getHistoryAddressAddressCount(QString address, QString collocutor, QString count, QString to);
 
+    Q_INVOKABLE void searchMessages(QString address, QString collocutorOrChannel, bool isChannel, QString text, QString offset, QString count);
+
     Q_INVOKABLE void sendPubkeyAddressToBlockchain(QString address, QString feeStr, QString paramsJson);
 
     Q_INVOKABLE void registerAddress(bool isForcibly, QString address, QString feeStr);
@@ -111,6 +113,8 @@ public slots:
 
     Q_INVOKABLE void getCountMessages(QString address, const QString &collocutor, QString from);
 
+    Q_INVOKABLE void getUnreadCounters(QString address);
+
 
     Q_INVOKABLE void createChannel(QString address, QString channelTitle, QString fee);
 
@@ -141,6 +145,8 @@ public slots:
 
     Q_INVOKABLE void remainingTime();
 
+    Q_INVOKABLE void getDecryptedCacheInfo();
+
 
     Q_INVOKABLE void reEmit();
 
@@ -5,8 +5,14 @@
 #include <QJsonValue>
 #include <QJsonObject>
 
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
 #include "check.h"
 #include "Log.h"
+#include "JsonReader.h"
+#include "PerfectHash.h"
 
 SET_LOG_NAMESPACE("MSG");
 
@@ -18,30 +24,70 @@ const static QString MSG_GET_CHANNELS_REQUEST = "msg_get_channels";
 const static QString MSG_GET_MY_CHANNELS_REQUEST = "msg_get_my_channels";
 const static QString MSG_APPEND_KEY_ONLINE_REQUEST = "msg_append_key_online";
 
-const static QString APPEND_KEY_TO_ADDR_RESPONSE = "msg_append_key_to_addr";
-const static QString APPEND_KEY_TO_ADDR_BLOCKCHAIN_RESPONSE = "msg_append_key_to_addr_blockchain";
-const static QString GET_KEY_BY_ADDR_RESPONSE = "msg_get_key_by_addr";
-const static QString SEND_TO_ADDR_RESPONSE = "msg_send_to_addr";
-const static QString NEW_MSGS_RESPONSE = "msg_get_my";
-const static QString NEW_MSG_RESPONSE = "new_msg";
-const static QString COUNT_MESSAGES_RESPONSE = "msg_append_key_online";
-
-const static QString CHANNEL_CREATE_RESPONSE = "msg_channel_create";
-const static QString CHANNEL_ADD_WRITER_RESPONSE = "msg_channel_add_writer";
-const static QString CHANNEL_DEL_WRITER_RESPONSE = "msg_channel_del_writer";
-const static QString SEND_TO_CHANNEL_RESPONSE = "msg_send_to_channel";
-const static QString GET_CHANNEL_RESPONSE = "msg_get_channel";
-const static QString GET_CHANNELS_RESPONSE = "msg_get_channels";
-const static QString GET_MY_CHANNELS_RESPONSE = "msg_get_my_channels";
-const static QString ADD_TO_CHANNEL_RESPONSE = "add_to_channel";
-const static QString DEL_FROM_CHANNEL_RESPONSE = "del_from_channel";
-
 const static QString ADD_ALL_WALLETS_REQUEST = "msg_append_key_online_list";
-const static QString ADD_ALL_WALLETS_RESPONSE = "msg_append_key_online_list";
 const static QString WANT_TO_TALK_REQUEST = "msg_send_request";
-const static QString WANT_TO_TALK_RESPONSE = "msg_send_request";
-const static QString REQUIRES_PUBKEY_RESPONSE = "msg_request_pubkey";
-const static QString COLLOCUTOR_ADDED_PUBKEY_RESPONSE = "msg_new_pubkey";
+
+static constexpr PerfectHashItem<METHOD> RESPONSE_METHODS[] = {
+    {"msg_append_key_to_addr", METHOD::APPEND_KEY_TO_ADDR},
+    {"msg_append_key_to_addr_blockchain", METHOD::APPEND_KEY_TO_ADDR},
+    {"msg_get_key_by_addr", METHOD::GET_KEY_BY_ADDR},
+    {"msg_send_to_addr", METHOD::SEND_TO_ADDR},
+    {"msg_get_my", METHOD::NEW_MSGS},
+    {"new_msg", METHOD::NEW_MSG},
+    {"msg_append_key_online", METHOD::COUNT_MESSAGES},
+    {"msg_channel_create", METHOD::CHANNEL_CREATE},
+    {"msg_channel_add_writer", METHOD::CHANNEL_ADD_WRITER},
+    {"msg_channel_del_writer", METHOD::CHANNEL_DEL_WRITER},
+    {"msg_send_to_channel", METHOD::SEND_TO_CHANNEL},
+    {"msg_get_channel", METHOD::GET_CHANNEL},
+    {"msg_get_channels", METHOD::GET_CHANNELS},
+    {"msg_get_my_channels", METHOD::GET_MY_CHANNELS},
+    {"add_to_channel", METHOD::ADD_TO_CHANNEL},
+    {"del_from_channel", METHOD::DEL_FROM_CHANNEL},
+    {"msg_append_key_online_list", METHOD::ALL_KEYS_ADDED},
+    {"msg_send_request", METHOD::WANT_TO_TALK},
+    {"msg_request_pubkey", METHOD::REQUIRES_PUBKEY},
+    {"msg_new_pubkey", METHOD::COLLOCUTOR_ADDED_PUBKEY}
+};
+
+static constexpr auto RESPONSE_METHODS_TABLE = makePerfectHashTable<64>(RESPONSE_METHODS);
+static_assert(RESPONSE_METHODS_TABLE.isPerfect(), "Response methods hash not perfect");
+
+static constexpr PerfectHashItem<ResponseType::ERROR_TYPE> RESPONSE_ERRORS[] = {
+    {"KEY_EXIST", ResponseType::ERROR_TYPE::ADDRESS_EXIST},
+    {"RSA_PUB_KEY_EXIST", ResponseType::ERROR_TYPE::ADDRESS_EXIST},
+    {"INVALID_SIGN", ResponseType::ERROR_TYPE::SIGN_OR_ADDRESS_INVALID},
+    {"INVALID_ADDR_OR_PUBKEY", ResponseType::ERROR_TYPE::SIGN_OR_ADDRESS_INVALID},
+    {"NO_REQ_FIELD", ResponseType::ERROR_TYPE::INCORRECT_JSON},
+    {"UNSUPPORTED_METHOD", ResponseType::ERROR_TYPE::INCORRECT_JSON},
+    {"NO_METHOD_OR_PARAMS", ResponseType::ERROR_TYPE::INCORRECT_JSON},
+    {"JSON_PARSE_ERROR", ResponseType::ERROR_TYPE::INCORRECT_JSON},
+    {"NOT_FOUND", ResponseType::ERROR_TYPE::ADDRESS_NOT_FOUND},
+    {"ADDR_NOT_FOUND", ResponseType::ERROR_TYPE::ADDRESS_NOT_FOUND},
+    {"TITLE_IS_BUSY", ResponseType::ERROR_TYPE::CHANNEL_EXIST},
+    {"NO_PERMISSION", ResponseType::ERROR_TYPE::CHANNEL_NOT_PERMISSION},
+    {"CHANNEL_NOT_FOUND", ResponseType::ERROR_TYPE::CHANNEL_NOT_FOUND},
+    {"INVALID_ADDR", ResponseType::ERROR_TYPE::INVALID_ADDRESS}
+};
+
+static constexpr auto RESPONSE_ERRORS_TABLE = makePerfectHashTable<32>(RESPONSE_ERRORS);
+static_assert(RESPONSE_ERRORS_TABLE.isPerfect(), "Response errors hash not perfect");
+
+template<typename Char>
+static METHOD methodFromName(const Char *begin, const Char *end) {
+    METHOD method;
+    CHECK(RESPONSE_METHODS_TABLE.find(begin, end, method), "Incorrect response: " + QString(reinterpret_cast<const QChar*>(begin), int(end - begin)).toStdString());
+    return method;
+}
+
+template<typename Char>
+static ResponseType::ERROR_TYPE errorTypeFromName(const Char *begin, const Char *end) {
+    ResponseType::ERROR_TYPE errorType;
+    if (!RESPONSE_ERRORS_TABLE.find(begin, end, errorType)) {
+        return ResponseType::ERROR_TYPE::OTHER;
+    }
+    return errorType;
+}
 
 QString makeTextForSignRegisterRequest(const QString &address, const QString &rsaPubkeyHex, uint64_t fee) {
     return address + QString::fromStdString(std::to_string(fee)) + rsaPubkeyHex;
@@ -329,25 +375,7 @@ ResponseType getMethodAndAddressResponse(const QJsonDocument &response) {
     if (root.contains("error") && root.value("error").isString()) {
         result.error = root.value("error").toString();
         result.isError = true;
-        if (result.error == "KEY_EXIST" || result.error == "RSA_PUB_KEY_EXIST") {
-            result.errorType = ResponseType::ERROR_TYPE::ADDRESS_EXIST;
-        } else if (result.error == "INVALID_SIGN" || result.error == "INVALID_ADDR_OR_PUBKEY") {
-            result.errorType = ResponseType::ERROR_TYPE::SIGN_OR_ADDRESS_INVALID;
-        } else if (result.error == "NO_REQ_FIELD" || result.error == "UNSUPPORTED_METHOD" || result.error == "NO_METHOD_OR_PARAMS" || result.error == "JSON_PARSE_ERROR") {
-            result.errorType = ResponseType::ERROR_TYPE::INCORRECT_JSON;
-        } else if (result.error == "NOT_FOUND" || result.error == "ADDR_NOT_FOUND") {
-            result.errorType = ResponseType::ERROR_TYPE::ADDRESS_NOT_FOUND;
-        } else if (result.error == "TITLE_IS_BUSY") {
-            result.errorType = ResponseType::ERROR_TYPE::CHANNEL_EXIST;
-        } else if (result.error == "NO_PERMISSION") {
-            result.errorType = ResponseType::ERROR_TYPE::CHANNEL_NOT_PERMISSION;
-        } else if (result.error == "CHANNEL_NOT_FOUND") {
-            result.errorType = ResponseType::ERROR_TYPE::CHANNEL_NOT_FOUND;
-        } else if (result.error == "INVALID_ADDR") {
-            result.errorType = ResponseType::ERROR_TYPE::INVALID_ADDRESS;
-        } else {
-            result.errorType = ResponseType::ERROR_TYPE::OTHER;
-        }
+        result.errorType = errorTypeFromName(result.error.utf16(), result.error.utf16() + result.error.size());
         if (root.contains("data")) {
             QJsonObject obj;
             obj.insert("data", root.value("data"));
@@ -358,48 +386,8 @@ ResponseType getMethodAndAddressResponse(const QJsonDocument &response) {
         result.id = std::stoull(root.value("request_id").toString().toStdString());
     }
 
-    if (type == APPEND_KEY_TO_ADDR_RESPONSE || type == APPEND_KEY_TO_ADDR_BLOCKCHAIN_RESPONSE) {
-        result.method = METHOD::APPEND_KEY_TO_ADDR;
-    } else if (type == GET_KEY_BY_ADDR_RESPONSE) {
-        result.method = METHOD::GET_KEY_BY_ADDR;
-    } else if (type == SEND_TO_ADDR_RESPONSE) {
-        result.method = METHOD::SEND_TO_ADDR;
-    } else if (type == NEW_MSGS_RESPONSE) {
-        result.method = METHOD::NEW_MSGS;
-    } else if (type == NEW_MSG_RESPONSE) {
-        result.method = METHOD::NEW_MSG;
-    } else if (type == COUNT_MESSAGES_RESPONSE) {
-        result.method = METHOD::COUNT_MESSAGES;
-    } else if (type == CHANNEL_CREATE_RESPONSE) {
-        result.method = METHOD::CHANNEL_CREATE;
-    } else if (type == CHANNEL_ADD_WRITER_RESPONSE) {
-        result.method = METHOD::CHANNEL_ADD_WRITER;
-    } else if (type == CHANNEL_DEL_WRITER_RESPONSE) {
-        result.method = METHOD::CHANNEL_DEL_WRITER;
-    } else if (type == SEND_TO_CHANNEL_RESPONSE) {
-        result.method = METHOD::SEND_TO_CHANNEL;
-    } else if (type == GET_CHANNEL_RESPONSE) {
-        result.method = METHOD::GET_CHANNEL;
-    } else if (type == GET_CHANNELS_RESPONSE) {
-        result.method = METHOD::GET_CHANNELS;
-    } else if (type == GET_MY_CHANNELS_RESPONSE) {
-        result.method = METHOD::GET_MY_CHANNELS;
-    } else if (type == ADD_TO_CHANNEL_RESPONSE) {
-        result.method = METHOD::ADD_TO_CHANNEL;
-    } else if (type == DEL_FROM_CHANNEL_RESPONSE) {
-        result.method = METHOD::DEL_FROM_CHANNEL;
-    } else if (type == ADD_ALL_WALLETS_RESPONSE) {
-        result.method = METHOD::ALL_KEYS_ADDED;
-    } else if (type == WANT_TO_TALK_RESPONSE) {
-        result.method = METHOD::WANT_TO_TALK;
-    } else if (type == REQUIRES_PUBKEY_RESPONSE) {
-        result.method = METHOD::REQUIRES_PUBKEY;
-    } else if (type == COLLOCUTOR_ADDED_PUBKEY_RESPONSE) {
-        result.method = METHOD::COLLOCUTOR_ADDED_PUBKEY;
-    } else if (type.isEmpty()) {
-        // ignore
-    } else {
-        throwErr(("Incorrect response: " + type).toStdString());
+    if (!type.isEmpty()) {
+        result.method = methodFromName(type.utf16(), type.utf16() + type.size());
     }
     return result;
 }
@@ -476,6 +464,225 @@ std::vector<NewMessageResponse> parseGetChannelResponse(const QJsonDocument &res
     return result;
 }
 
+using ResponseReader = JsonReader<ushort>;
+
+enum class ROOT_FIELD {
+    METHOD_NAME, ADDR, ERROR_TEXT, REQUEST_ID, DATA, PARAMS
+};
+
+static constexpr PerfectHashItem<ROOT_FIELD> ROOT_FIELDS[] = {
+    {"method", ROOT_FIELD::METHOD_NAME},
+    {"addr", ROOT_FIELD::ADDR},
+    {"error", ROOT_FIELD::ERROR_TEXT},
+    {"request_id", ROOT_FIELD::REQUEST_ID},
+    {"data", ROOT_FIELD::DATA},
+    {"params", ROOT_FIELD::PARAMS}
+};
+
+static constexpr auto ROOT_FIELDS_TABLE = makePerfectHashTable<16>(ROOT_FIELDS);
+static_assert(ROOT_FIELDS_TABLE.isPerfect(), "Root fields hash not perfect");
+
+enum class MESSAGE_FIELD {
+    FROM = 0, DATA = 1, FEE = 2, CNT = 3, TIMESTAMP = 4, TYPE = 5, CHANNEL = 6
+};
+
+static constexpr PerfectHashItem<MESSAGE_FIELD> MESSAGE_FIELDS[] = {
+    {"from", MESSAGE_FIELD::FROM},
+    {"data", MESSAGE_FIELD::DATA},
+    {"fee", MESSAGE_FIELD::FEE},
+    {"cnt", MESSAGE_FIELD::CNT},
+    {"timestamp", MESSAGE_FIELD::TIMESTAMP},
+    {"type", MESSAGE_FIELD::TYPE},
+    {"channel", MESSAGE_FIELD::CHANNEL}
+};
+
+static constexpr auto MESSAGE_FIELDS_TABLE = makePerfectHashTable<16>(MESSAGE_FIELDS);
+static_assert(MESSAGE_FIELDS_TABLE.isPerfect(), "Message fields hash not perfect");
+
+static QString spanToString(const ResponseReader::Span &span) {
+    return QString(reinterpret_cast<const QChar*>(span.begin), int(span.size()));
+}
+
+static QString readString(ResponseReader &reader, const char *field) {
+    CHECK(reader.isString(), std::string(field) + " field not found");
+    ResponseReader::Span raw;
+    std::vector<ushort> decoded;
+    if (reader.readString(raw, decoded)) {
+        return spanToString(raw);
+    } else {
+        return QString(reinterpret_cast<const QChar*>(decoded.data()), int(decoded.size()));
+    }
+}
+
+// Числа в ответах сервера передаются строками
+template<typename T>
+static T readNumber(ResponseReader &reader, const char *field) {
+    CHECK(reader.isString(), std::string(field) + " field not found");
+    ResponseReader::Span raw;
+    std::vector<ushort> decoded;
+    CHECK(reader.readString(raw, decoded), std::string("Incorrect number in field ") + field);
+    const ushort *c = raw.begin;
+    const bool isNegative = c != raw.end && *c == '-';
+    if (isNegative) {
+        CHECK(std::is_signed<T>::value, std::string("Incorrect number in field ") + field);
+        c++;
+    }
+    CHECK(c != raw.end, std::string("Incorrect number in field ") + field);
+    using UnsignedT = typename std::make_unsigned<T>::type;
+    // Модуль отрицательного числа может быть на единицу больше максимума
+    const UnsignedT limit = UnsignedT(std::numeric_limits<T>::max()) + (isNegative ? 1 : 0);
+    UnsignedT result = 0;
+    for (; c != raw.end; c++) {
+        CHECK(*c >= '0' && *c <= '9', std::string("Incorrect number in field ") + field);
+        const UnsignedT digit = *c - '0';
+        CHECK(result <= (limit - digit) / 10, std::string("Number overflow in field ") + field);
+        result = result * 10 + digit;
+    }
+    return isNegative ? T(UnsignedT(0) - result) : T(result);
+}
+
+static NewMessageResponse parseOneMessage(ResponseReader &reader) {
+    NewMessageResponse result;
+    CHECK(reader.isObject(), "from field not found");
+    reader.beginObject();
+
+    bool found[7] = {};
+    QString type;
+    ResponseReader::Span key;
+    while (reader.nextKey(key)) {
+        MESSAGE_FIELD field;
+        if (!MESSAGE_FIELDS_TABLE.find(key.begin, key.end, field)) {
+            reader.skipValue();
+            continue;
+        }
+        found[static_cast<int>(field)] = true;
+        switch (field) {
+        case MESSAGE_FIELD::FROM: result.collocutor = readString(reader, "from"); break;
+        case MESSAGE_FIELD::DATA: result.data = readString(reader, "data"); break;
+        case MESSAGE_FIELD::FEE: result.fee = readNumber<uint64_t>(reader, "fee"); break;
+        case MESSAGE_FIELD::CNT: result.counter = readNumber<Message::Counter>(reader, "cnt"); break;
+        case MESSAGE_FIELD::TIMESTAMP: result.timestamp = readNumber<uint64_t>(reader, "timestamp"); break;
+        case MESSAGE_FIELD::TYPE: type = readString(reader, "type"); break;
+        case MESSAGE_FIELD::CHANNEL: result.channelName = readString(reader, "channel"); break;
+        }
+    }
+
+    CHECK(found[static_cast<int>(MESSAGE_FIELD::FROM)], "from field not found");
+    CHECK(found[static_cast<int>(MESSAGE_FIELD::DATA)], "data field not found");
+    CHECK(found[static_cast<int>(MESSAGE_FIELD::FEE)], "fee field not found");
+    CHECK(found[static_cast<int>(MESSAGE_FIELD::CNT)], "cnt field not found");
+    CHECK(found[static_cast<int>(MESSAGE_FIELD::TIMESTAMP)], "timestamp field not found");
+    CHECK(found[static_cast<int>(MESSAGE_FIELD::TYPE)], "type field not found");
+    CHECK(type == "in" || type == "out" || type == "channel", "type field incorrect");
+    if (type != "channel") {
+        result.isInput = type == "in";
+        result.isChannel = false;
+        result.channelName.clear();
+    } else {
+        CHECK(found[static_cast<int>(MESSAGE_FIELD::CHANNEL)], "channel field not found");
+        result.isChannel = true;
+    }
+    return result;
+}
+
+static std::vector<NewMessageResponse> parseMessagesData(ResponseReader &reader) {
+    CHECK(reader.isObject(), "data field not found");
+    reader.beginObject();
+    std::vector<NewMessageResponse> result;
+    bool isMessagesFound = false;
+    ResponseReader::Span key;
+    while (reader.nextKey(key)) {
+        if (!(key == "messages")) {
+            reader.skipValue();
+            continue;
+        }
+        CHECK(reader.isArray(), "messages field not found");
+        isMessagesFound = true;
+        reader.beginArray();
+        while (reader.nextElement()) {
+            result.emplace_back(parseOneMessage(reader));
+        }
+    }
+    CHECK(isMessagesFound, "messages field not found");
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+ParsedResponse parseResponse(const QString &response) {
+    ParsedResponse result;
+    ResponseType &type = result.type;
+
+    const ushort *begin = response.utf16();
+    ResponseReader reader(begin, begin + response.size());
+    CHECK(reader.isObject(), "Response field not found");
+    reader.beginObject();
+
+    QString method;
+    bool isData = false;
+    bool isParams = false;
+    ResponseReader::Span data;
+    ResponseReader::Span params;
+
+    ResponseReader::Span key;
+    while (reader.nextKey(key)) {
+        ROOT_FIELD field;
+        if (!ROOT_FIELDS_TABLE.find(key.begin, key.end, field)) {
+            reader.skipValue();
+            continue;
+        }
+        // Поля data и params только запоминаются, так как method может прийти после них
+        if (field == ROOT_FIELD::DATA) {
+            data = reader.skipValue();
+            isData = true;
+        } else if (field == ROOT_FIELD::PARAMS) {
+            params = reader.skipValue();
+            isParams = true;
+        } else if (!reader.isString()) {
+            reader.skipValue();
+        } else if (field == ROOT_FIELD::METHOD_NAME) {
+            method = readString(reader, "method");
+        } else if (field == ROOT_FIELD::ADDR) {
+            type.address = readString(reader, "addr");
+        } else if (field == ROOT_FIELD::ERROR_TEXT) {
+            type.error = readString(reader, "error");
+            type.isError = true;
+        } else if (field == ROOT_FIELD::REQUEST_ID) {
+            type.id = readNumber<size_t>(reader, "request_id");
+        }
+    }
+    reader.finish();
+
+    if (type.isError) {
+        type.errorType = errorTypeFromName(type.error.utf16(), type.error.utf16() + type.error.size());
+        if (isData) {
+            // Ошибки редкие, поэтому текст собирается так же, как раньше
+            const QJsonDocument dataJson = QJsonDocument::fromJson(("{\"data\":" + spanToString(data) + "}").toUtf8());
+            type.error += ". " + dataJson.toJson(QJsonDocument::JsonFormat::Compact);
+        }
+    }
+    if (!method.isEmpty()) {
+        type.method = methodFromName(method.utf16(), method.utf16() + method.size());
+    }
+
+    if (type.isError) {
+        return result;
+    }
+    if (type.method == METHOD::NEW_MSG) {
+        CHECK(isParams, "params field not found");
+        ResponseReader paramsReader(params.begin, params.end);
+        CHECK(paramsReader.isObject(), "params field not found");
+        result.messages.emplace_back(parseOneMessage(paramsReader));
+        result.isMessagesParsed = true;
+    } else if (type.method == METHOD::NEW_MSGS || type.method == METHOD::GET_CHANNEL) {
+        CHECK(isData, "data field not found");
+        ResponseReader dataReader(data.begin, data.end);
+        result.messages = parseMessagesData(dataReader);
+        result.isMessagesParsed = true;
+    }
+    return result;
+}
+
 static ChannelInfo parseChannel(const QJsonObject &channelJson) {
     ChannelInfo info;
     CHECK(channelJson.contains("title") && channelJson.value("title").isString(), "title field not found");
@@ -122,6 +122,19 @@ struct CollocutorAddedPubkeyResponse {
     QString collocutor;
 };
 
+struct ParsedResponse {
+    ResponseType type;
+    // Сообщения разбираются сразу для NEW_MSG, NEW_MSGS и GET_CHANNEL. Для остальных методов нужен QJsonDocument
+    bool isMessagesParsed = false;
+    std::vector<NewMessageResponse> messages;
+};
+
+/*
+   Разбирает ответ за один проход по строке без построения QJsonDocument.
+   Массивы сообщений сразу читаются в NewMessageResponse
+ */
+ParsedResponse parseResponse(const QString &response);
+
 ResponseType getMethodAndAddressResponse(const QJsonDocument &response);
 
 NewMessageResponse parseNewMessageResponse(const QJsonDocument &response);
@@ -0,0 +1,226 @@
+#include "NodesFile.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <cstring>
+#include <sstream>
+#include <map>
+
+#include "check.h"
+#include "utils.h"
+
+namespace nodes_file {
+
+const static std::string CURRENT_VERSION_TEXT = "v3";
+
+const static char MAGIC[4] = {'M', 'H', 'N', 'C'};
+
+const static uint32_t CURRENT_VERSION_BINARY = 1;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    char hashNodes[32];
+    uint64_t timestamp;
+    uint32_t countSections;
+    uint32_t reserved;
+};
+
+struct SectionHeader {
+    char type[32];
+    uint32_t countRecords;
+    uint32_t reserved;
+};
+
+struct BinaryRecord {
+    char address[64];
+    uint64_t ping;
+    uint32_t isTimeout;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 56, "Incorrect FileHeader size");
+static_assert(sizeof(SectionHeader) == 40, "Incorrect SectionHeader size");
+static_assert(sizeof(BinaryRecord) == 80, "Incorrect BinaryRecord size");
+
+template<size_t N>
+static void copyToField(char (&field)[N], const std::string &value) {
+    CHECK(value.size() < N, "Too long value " + value);
+    std::memset(field, 0, N);
+    std::memcpy(field, value.data(), value.size());
+}
+
+template<size_t N>
+static QString fieldToString(const char (&field)[N]) {
+    return QString::fromLatin1(field, int(strnlen(field, N)));
+}
+
+bool readBinary(const QString &file, const std::string &hashNodes, NodesFileContent &content) {
+    QFile inputFile(file);
+    if (!inputFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 fileSize = inputFile.size();
+    if (fileSize < qint64(sizeof(FileHeader))) {
+        return false;
+    }
+    const uchar *data = inputFile.map(0, fileSize);
+    if (data == nullptr) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != CURRENT_VERSION_BINARY) {
+        return false;
+    }
+    if (hashNodes.size() != sizeof(header.hashNodes) || std::memcmp(header.hashNodes, hashNodes.data(), sizeof(header.hashNodes)) != 0) {
+        return false;
+    }
+
+    std::vector<NodeRecord> records;
+    size_t pos = sizeof(FileHeader);
+    for (uint32_t i = 0; i < header.countSections; i++) {
+        // pos не превышает размер файла, поэтому проверки записаны через вычитание, без переполнения на 32-битных сборках
+        if (sizeof(SectionHeader) > size_t(fileSize) - pos) {
+            return false;
+        }
+        SectionHeader section;
+        std::memcpy(&section, data + pos, sizeof(section));
+        pos += sizeof(section);
+
+        if (pos > size_t(fileSize) || section.countRecords > (size_t(fileSize) - pos) / sizeof(BinaryRecord)) {
+            return false;
+        }
+        const QString type = fieldToString(section.type);
+        for (uint32_t j = 0; j < section.countRecords; j++) {
+            BinaryRecord binRecord;
+            std::memcpy(&binRecord, data + pos, sizeof(binRecord));
+            pos += sizeof(binRecord);
+
+            NodeRecord record;
+            record.type = type;
+            record.address = fieldToString(binRecord.address);
+            record.ping = binRecord.ping;
+            record.isTimeout = binRecord.isTimeout == 1;
+            records.emplace_back(record);
+        }
+    }
+
+    content.timePoint = intToSystemTimePoint(header.timestamp);
+    content.records.swap(records);
+    return true;
+}
+
+void writeBinary(const QString &file, const std::string &hashNodes, const NodesFileContent &content) {
+    std::vector<QString> types;
+    std::map<QString, std::vector<const NodeRecord*>> sections;
+    for (const NodeRecord &record: content.records) {
+        auto &section = sections[record.type];
+        if (section.empty()) {
+            types.emplace_back(record.type);
+        }
+        section.emplace_back(&record);
+    }
+
+    std::string result;
+    result.reserve(sizeof(FileHeader) + types.size() * sizeof(SectionHeader) + content.records.size() * sizeof(BinaryRecord));
+
+    FileHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = CURRENT_VERSION_BINARY;
+    CHECK(hashNodes.size() == sizeof(header.hashNodes), "Incorrect hash nodes");
+    std::memcpy(header.hashNodes, hashNodes.data(), sizeof(header.hashNodes));
+    header.timestamp = systemTimePointToInt(content.timePoint);
+    header.countSections = uint32_t(types.size());
+    header.reserved = 0;
+    result.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const QString &type: types) {
+        const auto &section = sections[type];
+
+        SectionHeader sectionHeader;
+        copyToField(sectionHeader.type, type.toStdString());
+        sectionHeader.countRecords = uint32_t(section.size());
+        sectionHeader.reserved = 0;
+        result.append(reinterpret_cast<const char*>(&sectionHeader), sizeof(sectionHeader));
+
+        for (const NodeRecord *record: section) {
+            BinaryRecord binRecord;
+            copyToField(binRecord.address, record->address.toStdString());
+            binRecord.ping = record->ping;
+            binRecord.isTimeout = record->isTimeout ? 1 : 0;
+            binRecord.reserved = 0;
+            result.append(reinterpret_cast<const char*>(&binRecord), sizeof(binRecord));
+        }
+    }
+
+    QSaveFile outputFile(file);
+    CHECK(outputFile.open(QIODevice::WriteOnly), "Not open file " + file.toStdString());
+    CHECK(outputFile.write(result.data(), result.size()) == qint64(result.size()), "Not write file " + file.toStdString());
+    CHECK(outputFile.commit(), "Not commit file " + file.toStdString());
+}
+
+bool readText(const QString &file, const std::string &hashNodes, NodesFileContent &content) {
+    QFile inputFile(file);
+    if(!inputFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QTextStream in(&inputFile);
+    CHECK(!in.atEnd(), "Incorrect file " + file.toStdString());
+    const std::string versionStr = in.readLine().toStdString();
+    if (versionStr != CURRENT_VERSION_TEXT) {
+        return false;
+    }
+
+    const std::string hashNodesStr = in.readLine().toStdString();
+    if (hashNodes != hashNodesStr) {
+        return false;
+    }
+
+    const std::string timePointStr = in.readLine().toStdString();
+    content.timePoint = intToSystemTimePoint(std::stoull(timePointStr));
+    content.records.clear();
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        if (!line.isNull() && !line.isEmpty()) {
+            std::istringstream ss(line.toStdString());
+            NodeRecord record;
+            std::string type;
+            std::string address;
+            int isTimeout;
+            ss >> type >> address >> record.ping >> isTimeout;
+            CHECK(!ss.fail(), "Incorrect file " + file.toStdString());
+
+            record.type = QString::fromStdString(type);
+            record.address = QString::fromStdString(address);
+            if (!record.address.startsWith("http")) {
+                record.address = "http://" + record.address;
+            }
+            record.isTimeout = isTimeout == 1;
+
+            content.records.emplace_back(record);
+        }
+    }
+    return true;
+}
+
+void writeText(const QString &file, const std::string &hashNodes, const NodesFileContent &content) {
+    std::string result;
+    result += CURRENT_VERSION_TEXT + "\n";
+    result += hashNodes + "\n";
+    result += std::to_string(systemTimePointToInt(content.timePoint)) + "\n";
+    for (const NodeRecord &record: content.records) {
+        result += record.type.toStdString() + " ";
+        result += record.address.toStdString() + " ";
+        result += std::to_string(record.ping) + " ";
+        result += (record.isTimeout ? "1" : "0") + std::string(" ");
+        result += "\n";
+    }
+
+    writeToFile(file, result, false);
+}
+
+}
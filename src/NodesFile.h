@@ -0,0 +1,42 @@
+#ifndef NODESFILE_H
+#define NODESFILE_H
+
+#include <QString>
+
+#include <string>
+#include <vector>
+
+#include "duration.h"
+
+namespace nodes_file {
+
+struct NodeRecord {
+    QString type;
+    QString address;
+    size_t ping = 0;
+    bool isTimeout = false;
+};
+
+struct NodesFileContent {
+    system_time_point timePoint;
+    std::vector<NodeRecord> records;
+};
+
+/*
+   Бинарный формат: заголовок, затем секции по типам нод с записями фиксированного размера.
+   Числа записываются в порядке байт текущей машины, файл не переносится между платформами.
+   Файл читается через mmap без разбора строк.
+ */
+bool readBinary(const QString &file, const std::string &hashNodes, NodesFileContent &content);
+
+// Запись через временный файл с последующим переименованием
+void writeBinary(const QString &file, const std::string &hashNodes, const NodesFileContent &content);
+
+// Старый текстовый формат. Оставлен для миграции уже сохраненных файлов
+bool readText(const QString &file, const std::string &hashNodes, NodesFileContent &content);
+
+void writeText(const QString &file, const std::string &hashNodes, const NodesFileContent &content);
+
+}
+
+#endif // NODESFILE_H
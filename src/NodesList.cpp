@@ -0,0 +1,70 @@
+#include "NodesList.h"
+
+#include <algorithm>
+
+namespace nodes_list {
+
+MergeResult mergeAddresses(std::vector<NodeInfo> &infos, const std::vector<QString> &addresses, size_t maxPing) {
+    MergeResult result;
+
+    const auto removeIter = std::remove_if(infos.begin(), infos.end(), [&addresses](const NodeInfo &info) {
+        return std::find(addresses.begin(), addresses.end(), info.address) == addresses.end();
+    });
+    result.countRetired = std::distance(removeIter, infos.end());
+    infos.erase(removeIter, infos.end());
+
+    for (const QString &address: addresses) {
+        const auto found = std::find_if(infos.begin(), infos.end(), [&address](const NodeInfo &info) {
+            return info.address == address;
+        });
+        if (found == infos.end()) {
+            NodeInfo info;
+            info.address = address;
+            info.ping = maxPing;
+            infos.emplace_back(info);
+            result.added.emplace_back(address);
+        }
+    }
+    return result;
+}
+
+bool applyProbe(std::vector<NodeInfo> &infos, const NodeInfo &result, size_t retireCountFails, size_t ewmaWeight, size_t maxPing) {
+    const auto found = std::find_if(infos.begin(), infos.end(), [&result](const NodeInfo &info) {
+        return info.address == result.address;
+    });
+    if (found == infos.end()) {
+        return false;
+    }
+
+    NodeInfo &info = *found;
+    if (result.isTimeout) {
+        info.isTimeout = true;
+        info.isChecked = true;
+        info.countFails++;
+        if (info.countFails >= retireCountFails) {
+            // Вернется при следующем обновлении dns, если все еще в списке
+            infos.erase(found);
+        }
+    } else {
+        if (!info.isChecked || info.isTimeout || info.ping >= maxPing) {
+            info.ping = result.ping;
+        } else {
+            info.ping = (info.ping * (10 - ewmaWeight) + result.ping * ewmaWeight) / 10;
+        }
+        info.isChecked = true;
+        info.isTimeout = false;
+        info.countFails = 0;
+    }
+    std::sort(infos.begin(), infos.end(), std::less<NodeInfo>{});
+    return true;
+}
+
+size_t countProbesForTick(size_t probesPerMinute, const milliseconds &period, milliseconds &credit) {
+    const milliseconds minute = 1min;
+    credit += period * probesPerMinute;
+    const size_t countProbes = credit / minute;
+    credit -= minute * countProbes;
+    return countProbes;
+}
+
+}
@@ -0,0 +1,53 @@
+#ifndef NODESLIST_H
+#define NODESLIST_H
+
+#include <QString>
+
+#include <vector>
+
+#include "duration.h"
+
+struct NodeInfo {
+    QString address;
+
+    size_t ping;
+
+    bool isChecked = false;
+    bool isTimeout = false;
+
+    size_t countFails = 0;
+
+    bool operator< (const NodeInfo &second) const {
+        if (this->isTimeout) {
+            return false;
+        } else if (second.isTimeout) {
+            return true;
+        } else if (this->isChecked && !second.isChecked) {
+            return true;
+        } else if (!this->isChecked && second.isChecked) {
+            return false;
+        } else {
+            return this->ping < second.ping;
+        }
+    }
+};
+
+namespace nodes_list {
+
+struct MergeResult {
+    std::vector<QString> added;
+    size_t countRetired = 0;
+};
+
+// Оставляет в списке только адреса из addresses, новые адреса добавляются непроверенными с пингом maxPing
+MergeResult mergeAddresses(std::vector<NodeInfo> &infos, const std::vector<QString> &addresses, size_t maxPing);
+
+// Возвращает false, если адреса уже нет в списке
+bool applyProbe(std::vector<NodeInfo> &infos, const NodeInfo &result, size_t retireCountFails, size_t ewmaWeight, size_t maxPing);
+
+// Количество проб на очередной тик. Остаток от деления копится в credit, поэтому малые значения probesPerMinute не округляются ни вверх, ни до нуля
+size_t countProbesForTick(size_t probesPerMinute, const milliseconds &period, milliseconds &credit);
+
+}
+
+#endif // NODESLIST_H
@@ -2,6 +2,7 @@
 
 #include <QApplication>
 #include <QCryptographicHash>
+#include <QFile>
 
 #include <QJsonDocument>
 #include <QJsonArray>
@@ -10,7 +11,10 @@
 
 #include <QSettings>
 
+#include <limits>
+
 #include "dns/dnspacket.h"
+#include "NodesFile.h"
 #include "check.h"
 #include "utils.h"
 #include "duration.h"
@@ -22,14 +26,26 @@
 
 SET_LOG_NAMESPACE("NSL");
 
-const static QString FILL_NODES_PATH = "fill_nodes.txt";
+const static QString FILL_NODES_PATH = "fill_nodes.bin";
+
+const static QString FILL_NODES_PATH_OLD = "fill_nodes.txt";
 
-const static std::string CURRENT_VERSION = "v3";
+const static QString DNS_CACHE_PATH = "dns_cache.json";
 
 const static milliseconds MAX_PING = 100s;
 
 const static milliseconds UPDATE_PERIOD = days(1);
 
+const static milliseconds REFRESH_PERIOD = 1h;
+
+const static milliseconds PROBE_PERIOD = 10s;
+
+const static milliseconds MIN_DNS_EXPIRE_PERIOD = 1min;
+
+const static size_t PROBE_EWMA_WEIGHT = 3; // из 10
+
+const static size_t RETIRE_COUNT_FAILS = 5;
+
 const static size_t ACCEPTABLE_COUNT_ADDRESSES = 3;
 
 static QString makeAddress(const QString &ipAndPort) {
@@ -79,6 +95,12 @@ NsLookup::NsLookup(QObject *parent)
     dnsServerPort = settings.value("ns_lookup/dns_server_port").toInt();
     CHECK(settings.contains("ns_lookup/use_users_servers"), "settings ns_lookup/use_users_servers field not found");
     useUsersServers = settings.value("ns_lookup/use_users_servers").toBool();
+    CHECK(settings.contains("ns_lookup/probes_per_minute"), "settings ns_lookup/probes_per_minute field not found");
+    probesPerMinute = settings.value("ns_lookup/probes_per_minute").toUInt();
+
+    savedDnsCachePath = makePath(getNsLookupPath(), DNS_CACHE_PATH);
+    cacheDns = dns_cache::readFile(savedDnsCachePath);
+    LOG << "Filled dns cache: " << cacheDns.size();
 
     savedNodesPath = makePath(getNsLookupPath(), FILL_NODES_PATH);
     const system_time_point lastFill = fillNodesFromFile(savedNodesPath, nodes);
@@ -106,6 +128,16 @@ NsLookup::NsLookup(QObject *parent)
     CHECK(connect(&thread1, &QThread::started, &qtimer, QOverload<>::of(&QTimer::start)), "not connect start");
     CHECK(connect(&thread1, &QThread::finished, &qtimer, &QTimer::stop), "not connect stop");
 
+    probeTimer.moveToThread(&thread1);
+    probeTimer.setInterval(milliseconds(PROBE_PERIOD).count());
+    CHECK(connect(&probeTimer, &QTimer::timeout, this, &NsLookup::probeEvent), "not connect probeEvent");
+    CHECK(connect(&thread1, &QThread::finished, &probeTimer, &QTimer::stop), "not connect stop");
+
+    dnsExpireTimer.moveToThread(&thread1);
+    dnsExpireTimer.setSingleShot(true);
+    CHECK(connect(&dnsExpireTimer, &QTimer::timeout, this, &NsLookup::dnsExpireEvent), "not connect dnsExpireEvent");
+    CHECK(connect(&thread1, &QThread::finished, &dnsExpireTimer, &QTimer::stop), "not connect stop");
+
     CHECK(connect(&udpClient, &UdpSocketClient::callbackCall, this, &NsLookup::callbackCall), "not connect callbackCall");
 
     client.setParent(this);
@@ -128,6 +160,8 @@ NsLookup::~NsLookup() {
 
     if (isResetFilledFile.load()) {
         removeFile(savedNodesPath);
+        removeFile(makePath(getNsLookupPath(), FILL_NODES_PATH_OLD));
+        removeFile(savedDnsCachePath);
     }
 }
 
@@ -152,20 +186,23 @@ BEGIN_SLOT_WRAPPER
 
     startScanTime = ::now();
 
-    allNodesForTypesNew.clear();
-
-    LOG << "Dns scan start";
-    continueResolve(nodes.begin());
+    isRefresh = isIncrementalMode;
+    if (isRefresh) {
+        LOG << "Dns refresh start";
+    } else {
+        allNodesForTypesNew.clear();
+        LOG << "Dns scan start";
+    }
+    resolveAll();
 END_SLOT_WRAPPER
 }
 
 void NsLookup::finalizeLookup() {
-    std::unique_lock<std::mutex> lock(nodeMutex);
     if (!isSafeCheck) {
         allNodesForTypes.swap(allNodesForTypesNew);
     }
     sortAll();
-    lock.unlock();
+    publishSnapshot();
     if (!isSafeCheck) {
         saveToFile(savedNodesPath, system_now(), nodes);
     }
@@ -191,17 +228,23 @@ void NsLookup::finalizeLookup() {
         }
         if (isSuccess) {
             LOG << "Dns safe check success";
-            msTimer = UPDATE_PERIOD - passedTime;
             isSuccessFl = true;
         } else {
             LOG << "Dns safe check not success. Start full scan";
             msTimer = 1ms;
         }
     } else {
-        msTimer = UPDATE_PERIOD;
         isSuccessFl = true;
     }
     if (isSuccessFl) {
+        // Дальше список поддерживается пробами и инкрементальным обновлением dns
+        msTimer = REFRESH_PERIOD;
+        isIncrementalMode = true;
+        if (probesPerMinute != 0) {
+            probeTimer.start();
+        }
+        scheduleDnsExpire();
+
         emit serversFlushed(TypedException());
 
         if (useUsersServers) {
@@ -214,102 +257,288 @@ void NsLookup::finalizeLookup() {
     qtimer.setSingleShot(true);
 }
 
-bool NsLookup::repeatResolveDns(
-    const QString &dnsServerName,
-    int dnsServerPort,
-    const QByteArray &byteArray,
-    std::map<QString, NodeType>::const_iterator node,
-    time_point now,
-    size_t countRepeat
-) {
-    if (countRepeat == 0) {
-        return false;
+static NodeInfo parseNodeInfo(const QString &address, const milliseconds &time, const std::string &message) {
+    NodeInfo info;
+    info.address = address;
+    info.ping = time.count();
+    info.isChecked = true;
+
+    if (message.empty()) {
+        info.ping = MAX_PING.count();
+        info.isTimeout = true;
+    } else {
+        QJsonParseError parseError;
+        QJsonDocument::fromJson(QString::fromStdString(message).toUtf8(), &parseError);
+        if (parseError.error != QJsonParseError::NoError) {
+            info.ping = MAX_PING.count();
+            info.isTimeout = true;
+        }
+    }
+
+    return info;
+}
+
+void NsLookup::resolveAll() {
+    if (isStopped.load()) {
+        return;
+    }
+
+    std::set<QString> names;
+    std::set<QString> staleNames;
+    dns_cache::splitNames(cacheDns, getDnsNames(), system_now(), names, staleNames);
+
+    // Устаревшие записи используются, пока обновляются в фоне
+    refreshStaleDns(staleNames);
+
+    isResolveDnsFailed = false;
+    if (names.empty()) {
+        finalizeResolveAll();
+        return;
+    }
+
+    // Все имена резолвятся параллельно, пинги начинаются после получения всех ответов
+    countResolveDnsPending = names.size();
+    for (const QString &name: names) {
+        LOG << "Dns " << name << ".";
+        resolveDns(name, 3, false);
+    }
+}
+
+void NsLookup::resolveDns(const QString &name, size_t countRepeat, bool isBackground) {
+    while (udpClient.isRequestRunning(nextDnsRequestId)) {
+        nextDnsRequestId++;
     }
-    udpClient.sendRequest(QHostAddress(dnsServerName), dnsServerPort, std::vector<char>(byteArray.begin(), byteArray.end()), [this, node, now, dnsServerName, dnsServerPort, byteArray, countRepeat](const std::vector<char> &response, const UdpSocketClient::SocketException &exception) {
+
+    DnsPacket requestPacket;
+    requestPacket.setId(nextDnsRequestId++);
+    requestPacket.addQuestion(DnsQuestion::getIp(name));
+    requestPacket.setFlags(DnsFlag::MyFlag);
+    const auto byteArray = requestPacket.toByteArray();
+
+    udpClient.sendRequest(QHostAddress(dnsServerName), dnsServerPort, std::vector<char>(byteArray.begin(), byteArray.end()), [this, name, countRepeat, isBackground](const std::vector<char> &response, const UdpSocketClient::SocketException &exception) {
         DnsPacket packet;
         const TypedException except = apiVrapper2([&](){
             CHECK(!exception.isSet(), "Dns exception: " + exception.toString());
-            CHECK(response.size() > 0, "Incorrect response dns " + node->second.type.toStdString());
+            CHECK(response.size() > 0, "Incorrect response dns " + name.toStdString());
             packet = DnsPacket::fromBytesArary(QByteArray(response.data(), response.size()));
 
-            LOG << "Dns ok " << node->second.type << ". " << packet.answers().size();
+            LOG << "Dns ok " << name << ". " << packet.answers().size();
             CHECK(!packet.answers().empty(), "Empty dns response " + toHex(std::string(response.begin(), response.end())));
         });
 
         if (except.isSet()) {
-            LOG << "Dns repeat number " << countRepeat - 1;
-            const bool res = repeatResolveDns(dnsServerName, dnsServerPort, byteArray, node, now, countRepeat - 1);
-            if (!res) {
-                throw except;
-            } else {
+            if (countRepeat > 1) {
+                LOG << "Dns repeat number " << countRepeat - 1;
+                resolveDns(name, countRepeat - 1, isBackground);
+                return;
+            }
+            LOG << "Dns resolve failed " << name;
+            if (isBackground) {
+                refreshingDnsNames.erase(name);
+                scheduleDnsExpire();
+                return;
+            }
+            isResolveDnsFailed = true;
+        } else {
+            dns_cache::Record &cacheRecord = cacheDns[name];
+            const std::vector<QString> oldIps = cacheRecord.ips;
+            cacheRecord.ips.clear();
+            quint32 ttl = std::numeric_limits<quint32>::max();
+            for (const auto &record : packet.answers()) {
+                cacheRecord.ips.emplace_back(record.toString());
+                ttl = std::min(ttl, record.ttl());
+            }
+            cacheRecord.expire = dns_cache::calcExpire(ttl, system_now());
+
+            saveDnsCacheToFile(savedDnsCachePath);
+
+            if (isBackground) {
+                refreshingDnsNames.erase(name);
+                if (isIncrementalMode && oldIps != cacheRecord.ips) {
+                    mergeResolved();
+                }
+                scheduleDnsExpire();
                 return;
             }
         }
 
-        ipsTemp.clear();
-        for (const auto &record : packet.answers()) {
-            ipsTemp.emplace_back(::makeAddress(record.toString(), node->second.port));
+        CHECK(countResolveDnsPending != 0, "Incorrect count resolve dns");
+        countResolveDnsPending--;
+        if (countResolveDnsPending == 0) {
+            finalizeResolveAll();
         }
+    }, timeoutRequestNodes);
+}
 
-        cacheDns.cache[node->second.node.str()] = ipsTemp;
-        cacheDns.lastUpdate = now;
+void NsLookup::finalizeResolveAll() {
+    if (isResolveDnsFailed) {
+        // Повторная попытка произойдет по таймеру
+        LOG << "Dns scan not success";
+        return;
+    }
+    if (isRefresh) {
+        mergeResolved();
+        qtimer.setInterval(milliseconds(REFRESH_PERIOD).count());
+        qtimer.setSingleShot(true);
+    } else {
+        continueResolve(nodes.begin());
+    }
+}
 
-        continuePing(std::begin(ipsTemp), node);
-    }, timeoutRequestNodes);
+std::set<QString> NsLookup::getDnsNames() const {
+    std::set<QString> names;
+    for (const auto &node: nodes) {
+        names.insert(node.second.node.str());
+    }
+    return names;
+}
 
-    return true;
+void NsLookup::refreshStaleDns(const std::set<QString> &staleNames) {
+    for (const QString &name: staleNames) {
+        if (refreshingDnsNames.insert(name).second) {
+            LOG << "Dns background " << name << ".";
+            resolveDns(name, 3, true);
+        }
+    }
 }
 
-void NsLookup::continueResolve(std::map<QString, NodeType>::const_iterator node) {
+void NsLookup::scheduleDnsExpire() {
+    if (!isIncrementalMode) {
+        return;
+    }
+    const system_time_point expire = dns_cache::nearestExpire(cacheDns, getDnsNames());
+    if (expire == system_time_point::max()) {
+        dnsExpireTimer.stop();
+        return;
+    }
+    // Неудачное обновление оставляет запись устаревшей, поэтому повтор не чаще MIN_DNS_EXPIRE_PERIOD
+    const milliseconds timeout = std::max(std::chrono::duration_cast<milliseconds>(expire - system_now()), MIN_DNS_EXPIRE_PERIOD);
+    dnsExpireTimer.start(timeout.count());
+}
+
+void NsLookup::dnsExpireEvent() {
+BEGIN_SLOT_WRAPPER
     if (isStopped.load()) {
         return;
     }
-    if (node == nodes.end()) {
-        finalizeLookup();
+    std::set<QString> missing;
+    std::set<QString> staleNames;
+    dns_cache::splitNames(cacheDns, getDnsNames(), system_now(), missing, staleNames);
+    if (staleNames.empty()) {
+        scheduleDnsExpire();
         return;
     }
+    refreshStaleDns(staleNames);
+END_SLOT_WRAPPER
+}
 
-    if (allNodesForTypesNew.find(node->second.node) != allNodesForTypesNew.end()) {
-        continueResolve(std::next(node));
+void NsLookup::mergeResolved() {
+    size_t countAdded = 0;
+    size_t countRetired = 0;
+    std::set<NodeType::Node> processed;
+    for (const auto &nodeTypeIter: nodes) {
+        const NodeType &nodeType = nodeTypeIter.second;
+        if (!processed.insert(nodeType.node).second) {
+            continue;
+        }
+        std::vector<QString> addresses;
+        for (const QString &ip: cacheDns[nodeType.node.str()].ips) {
+            addresses.emplace_back(::makeAddress(ip, nodeType.port));
+        }
+        if (addresses.empty()) {
+            continue;
+        }
+
+        const nodes_list::MergeResult merged = nodes_list::mergeAddresses(allNodesForTypes[nodeType.node], addresses, MAX_PING.count());
+        for (const QString &address: merged.added) {
+            probeQueue.emplace_front(nodeType.node, address);
+        }
+        countAdded += merged.added.size();
+        countRetired += merged.countRetired;
+    }
+    sortAll();
+    publishSnapshot();
+
+    saveToFile(savedNodesPath, system_now(), nodes);
+
+    LOG << "Dns refresh finished. Added " << countAdded << ". Retired " << countRetired;
+}
+
+void NsLookup::probeEvent() {
+BEGIN_SLOT_WRAPPER
+    if (isStopped.load() || countProbesPending != 0) {
         return;
     }
 
-    const time_point now = ::now();
-    if (now - cacheDns.lastUpdate >= 1h) {
-        cacheDns.cache.clear();
+    const size_t countProbes = nodes_list::countProbesForTick(probesPerMinute, PROBE_PERIOD, probesCredit);
+    if (countProbes == 0) {
+        return;
     }
-    ipsTemp = cacheDns.cache[node->second.node.str()];
-    if (ipsTemp.empty()) {
-        DnsPacket requestPacket;
-        requestPacket.addQuestion(DnsQuestion::getIp(node->second.node.str()));
-        requestPacket.setFlags(DnsFlag::MyFlag);
-        const auto byteArray = requestPacket.toByteArray();
-        LOG << "Dns " << node->second.type << ".";
-        repeatResolveDns(dnsServerName, dnsServerPort, byteArray, node, now, 3);
-    } else {
-        continuePing(std::begin(ipsTemp), node);
+
+    if (probeQueue.empty()) {
+        for (const auto &element: allNodesForTypes) {
+            for (const NodeInfo &info: element.second) {
+                probeQueue.emplace_back(element.first, info.address);
+            }
+        }
     }
-}
 
-static NodeInfo parseNodeInfo(const QString &address, const milliseconds &time, const std::string &message) {
-    NodeInfo info;
-    info.address = address;
-    info.ping = time.count();
-    info.isChecked = true;
+    std::map<NodeType::Node, std::vector<QString>> requests;
+    for (size_t i = 0; i < countProbes && !probeQueue.empty(); i++) {
+        requests[probeQueue.front().first].emplace_back(probeQueue.front().second);
+        probeQueue.pop_front();
+    }
 
-    if (message.empty()) {
-        info.ping = MAX_PING.count();
-        info.isTimeout = true;
-    } else {
-        QJsonParseError parseError;
-        QJsonDocument::fromJson(QString::fromStdString(message).toUtf8(), &parseError);
-        if (parseError.error != QJsonParseError::NoError) {
-            info.ping = MAX_PING.count();
-            info.isTimeout = true;
+    for (const auto &request: requests) {
+        const NodeType::Node node = request.first;
+        // Счетчик увеличивается до отправки, так как ответ может прийти сразу. Если отправка не удалась, ответа не будет
+        countProbesPending++;
+        const TypedException sendException = apiVrapper2([&]{
+            client.pings(node.str().toStdString(), request.second, [this, node, requestsSize=request.second.size()](const std::vector<std::tuple<QString, milliseconds, std::string>> &results) {
+                const TypedException exception = apiVrapper2([&]{
+                    CHECK(requestsSize == results.size(), "Incorrect results");
+                    for (const auto &result: results) {
+                        applyProbeResult(node, parseNodeInfo(std::get<0>(result), std::get<1>(result), std::get<2>(result)));
+                    }
+                });
+
+                if (exception.isSet()) {
+                    LOG << "Exception"; // Ошибка логгируется внутри apiVrapper2;
+                }
+                publishSnapshot();
+                countProbesPending--;
+            }, 2s);
+        });
+        if (sendException.isSet()) {
+            countProbesPending--;
         }
     }
+END_SLOT_WRAPPER
+}
 
-    return info;
+void NsLookup::applyProbeResult(const NodeType::Node &node, const NodeInfo &result) {
+    nodes_list::applyProbe(allNodesForTypes[node], result, RETIRE_COUNT_FAILS, PROBE_EWMA_WEIGHT, MAX_PING.count());
+}
+
+void NsLookup::continueResolve(std::map<QString, NodeType>::const_iterator node) {
+    if (isStopped.load()) {
+        return;
+    }
+    if (node == nodes.end()) {
+        finalizeLookup();
+        return;
+    }
+
+    if (allNodesForTypesNew.find(node->second.node) != allNodesForTypesNew.end()) {
+        continueResolve(std::next(node));
+        return;
+    }
+
+    ipsTemp.clear();
+    for (const QString &ip: cacheDns[node->second.node.str()].ips) {
+        ipsTemp.emplace_back(::makeAddress(ip, node->second.port));
+    }
+    continuePing(std::begin(ipsTemp), node);
 }
 
 void NsLookup::continuePing(std::vector<QString>::const_iterator ipsIter, std::map<QString, NodeType>::const_iterator node) {
@@ -401,12 +630,11 @@ void NsLookup::continuePing(std::vector<QString>::const_iterator ipsIter, std::m
 
 void NsLookup::finalizeLookupP2P() {
     size_t countAll = 0;
-    std::unique_lock<std::mutex> lock(nodeMutex);
     for (auto &element: allNodesForTypesP2P) {
         std::sort(element.second.begin(), element.second.end(), std::less<NodeInfo>{});
         countAll += element.second.size();
     }
-    lock.unlock();
+    publishSnapshot();
 
     const time_point stopScan = ::now();
     LOG << "Dns scan p2p time " << std::chrono::duration_cast<seconds>(stopScan - startScanTime).count() << " seconds. Count new nodes " << countAll;
@@ -539,7 +767,6 @@ void NsLookup::continuePingP2P(std::vector<std::pair<NodeType::SubType, QString>
                 const NodeType::SubType &type = types[i];
                 const NodeInfo info = parseNodeInfo(std::get<0>(result), std::get<1>(result), std::get<2>(result));
 
-                std::unique_lock<std::mutex> lock(nodeMutex);
                 if (type == NodeType::SubType::torrent) {
                     allNodesForTypesP2P[nodeTorrent.node].emplace_back(info); // TODO добавлять сразу к сортированному массиву
                 } else if (type == NodeType::SubType::proxy) {
@@ -551,6 +778,7 @@ void NsLookup::continuePingP2P(std::vector<std::pair<NodeType::SubType, QString>
         if (exception.isSet()) {
             LOG << "Exception"; // Ошибка логгируется внутри apiVrapper2;
         }
+        publishSnapshot();
         continuePingP2P(std::next(ipsIter, countSteps), node, nodeTorrent, nodeProxy);
     }, 2s);
 }
@@ -561,6 +789,33 @@ void NsLookup::sortAll() {
     }
 }
 
+void NsLookup::publishSnapshot() {
+    const auto isNotTimeout = [](const NodeInfo &node) {
+        return !node.isTimeout;
+    };
+
+    auto newSnapshot = std::make_shared<NodesSnapshot>();
+    for (const auto &nodeTypeIter: nodes) {
+        const NodeType &nodeType = nodeTypeIter.second;
+        const auto found = allNodesForTypes.find(nodeType.node);
+        if (found == allNodesForTypes.end()) {
+            continue;
+        }
+        std::vector<NodeInfo> &result = (*newSnapshot)[nodeType.type];
+        std::copy_if(found->second.begin(), found->second.end(), std::back_inserter(result), isNotTimeout);
+
+        if (useUsersServers) {
+            const auto foundP2P = allNodesForTypesP2P.find(nodeType.node);
+            if (foundP2P != allNodesForTypesP2P.end()) {
+                std::copy_if(foundP2P->second.begin(), foundP2P->second.end(), std::back_inserter(result), isNotTimeout);
+                std::sort(result.begin(), result.end(), std::less<NodeInfo>{});
+            }
+        }
+    }
+
+    std::atomic_store(&snapshot, std::shared_ptr<const NodesSnapshot>(std::move(newSnapshot)));
+}
+
 static void createSymlink(const QString &file) {
     const QString symlink = makePath(QApplication::applicationDirPath(), "fill_nodes_symlink.lnk");
     QFile::link(file, symlink);
@@ -574,76 +829,75 @@ static std::string calcHashNodes(const std::map<QString, NodeType> &expectedNode
 }
 
 system_time_point NsLookup::fillNodesFromFile(const QString &file, const std::map<QString, NodeType> &expectedNodes) {
-    QFile inputFile(file);
-    if(!inputFile.open(QIODevice::ReadOnly)) {
-        return intToSystemTimePoint(0);
-    }
-    QTextStream in(&inputFile);
-    CHECK(!in.atEnd(), "Incorrect file " + file.toStdString());
-    const std::string versionStr = in.readLine().toStdString();
-    if (versionStr != CURRENT_VERSION) {
-        return intToSystemTimePoint(0);
-    }
-
     const std::string hashNodes = calcHashNodes(expectedNodes);
-    const std::string hashNodesStr = in.readLine().toStdString();
-    if (hashNodes != hashNodesStr) {
-        return intToSystemTimePoint(0);
-    }
-
-    const std::string timePointStr = in.readLine().toStdString();
-    const system_time_point timePoint = intToSystemTimePoint(std::stoull(timePointStr));
-    size_t count = 0;
-    while (!in.atEnd()) {
-        const QString line = in.readLine();
-        if (!line.isNull() && !line.isEmpty()) {
-            std::istringstream ss(line.toStdString());
-            NodeInfo info;
-            std::string type;
-            std::string address;
-            int isTimeout;
-            ss >> type >> address >> info.ping >> isTimeout;
-            CHECK(!ss.fail(), "Incorrect file " + file.toStdString());
-
-            info.address = QString::fromStdString(address);
-            if (!info.address.startsWith("http")) {
-                info.address = "http://" + info.address;
-            }
-            info.isTimeout = isTimeout == 1;
-            info.isChecked = false;
+    const QString oldFile = makePath(getNsLookupPath(), FILL_NODES_PATH_OLD);
+    nodes_file::NodesFileContent content;
+    bool isMigrate = false;
+    if (!nodes_file::readBinary(file, hashNodes, content)) {
+        if (!nodes_file::readText(oldFile, hashNodes, content)) {
+            return intToSystemTimePoint(0);
+        }
+        LOG << "Nodes filled from old file";
+        isMigrate = true;
+    }
 
-            allNodesForTypes[nodes[QString::fromStdString(type)].node].emplace_back(info);
+    for (const nodes_file::NodeRecord &record: content.records) {
+        NodeInfo info;
+        info.address = record.address;
+        info.ping = record.ping;
+        info.isTimeout = record.isTimeout;
+        info.isChecked = false;
 
-            count++;
-        }
+        allNodesForTypes[nodes[record.type].node].emplace_back(info);
     }
 
-    LOG << "Filled nodes: " << count;
+    LOG << "Filled nodes: " << content.records.size();
 
     sortAll();
+    publishSnapshot();
 
-    createSymlink(file);
+    if (isMigrate) {
+        // Старый файл удаляется только после успешной записи нового, иначе останется для следующей попытки
+        const TypedException exception = apiVrapper2([&]{
+            saveToFile(file, content.timePoint, expectedNodes);
+            removeFile(oldFile);
+            LOG << "Nodes file migrated";
+        });
+        if (exception.isSet()) {
+            LOG << "Nodes file not migrated"; // Ошибка логгируется внутри apiVrapper2
+        }
+    } else {
+        createSymlink(file);
+    }
 
-    return timePoint;
+    return content.timePoint;
+}
+
+void NsLookup::saveDnsCacheToFile(const QString &file) const {
+    const TypedException exception = apiVrapper2([&]{
+        dns_cache::writeFile(file, cacheDns);
+    });
+    if (exception.isSet()) {
+        LOG << "Dns cache not saved"; // Ошибка логгируется внутри apiVrapper2
+    }
 }
 
 void NsLookup::saveToFile(const QString &file, const system_time_point &tp, const std::map<QString, NodeType> &expectedNodes) {
-    std::string content;
-    content += CURRENT_VERSION + "\n";
-    content += calcHashNodes(expectedNodes) + "\n";
-    content += std::to_string(systemTimePointToInt(tp)) + "\n";
+    nodes_file::NodesFileContent content;
+    content.timePoint = tp;
     for (const auto &nodeTypeIter: nodes) {
         const NodeType &nodeType = nodeTypeIter.second;
         for (const NodeInfo &node: allNodesForTypes[nodeType.node]) {
-            content += nodeType.type.toStdString() + " ";
-            content += node.address.toStdString() + " ";
-            content += std::to_string(node.ping) + " ";
-            content += (node.isTimeout ? "1" : "0") + std::string(" ");
-            content += "\n";
+            nodes_file::NodeRecord record;
+            record.type = nodeType.type;
+            record.address = node.address;
+            record.ping = node.ping;
+            record.isTimeout = node.isTimeout;
+            content.records.emplace_back(record);
         }
     }
 
-    writeToFile(file, content, false);
+    nodes_file::writeBinary(file, calcHashNodes(expectedNodes), content);
 
     createSymlink(file);
 }
@@ -659,32 +913,15 @@ std::vector<QString> NsLookup::getRandom(const QString &type, size_t limit, size
 std::vector<QString> NsLookup::getRandom(const QString &type, size_t limit, size_t count, const std::function<QString(const NodeInfo &node)> &process) const {
     CHECK(count <= limit, "Incorrect count value");
 
-    std::unique_lock<std::mutex> lock(nodeMutex);
-    const auto foundType = nodes.find(type);
-    if (foundType == nodes.end()) {
+    const std::shared_ptr<const NodesSnapshot> currentSnapshot = std::atomic_load(&snapshot);
+    if (currentSnapshot == nullptr) {
         return {};
     }
-    const auto found = allNodesForTypes.find(foundType->second.node);
-    if (found == allNodesForTypes.end()) {
+    const auto found = currentSnapshot->find(type);
+    if (found == currentSnapshot->end()) {
         return {};
     }
-    std::vector<NodeInfo> nodes = found->second;
-
-    if (useUsersServers) {
-        const auto foundP2P = allNodesForTypesP2P.find(foundType->second.node);
-        if (foundP2P != allNodesForTypesP2P.end()) {
-            nodes.insert(nodes.end(), foundP2P->second.begin(), foundP2P->second.end());
-        }
-    }
-    lock.unlock();
-
-    std::sort(nodes.begin(), nodes.end(), std::less<NodeInfo>{});
-
-    std::vector<NodeInfo> filterNodes;
-    std::copy_if(nodes.begin(), nodes.end(), std::back_inserter(filterNodes), [](const NodeInfo &node) {
-        return !node.isTimeout;
-    });
-    return ::getRandom<QString>(filterNodes, limit, count, process);
+    return ::getRandom<QString>(found->second, limit, count, process);
 }
 
 void NsLookup::resetFile() {
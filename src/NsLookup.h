@@ -7,8 +7,9 @@
 
 #include <vector>
 #include <map>
+#include <set>
 #include <deque>
-#include <mutex>
+#include <memory>
 #include <atomic>
 
 #include "duration.h"
@@ -17,6 +18,9 @@
 
 #include "UdpSocketClient.h"
 
+#include "NodesList.h"
+#include "DnsCache.h"
+
 struct TypedException;
 
 struct NodeType {
@@ -49,38 +53,13 @@ struct NodeType {
     SubType subtype = SubType::none;
 };
 
-struct NodeInfo {
-    QString address;
-
-    size_t ping;
-
-    bool isChecked = false;
-    bool isTimeout = false;
-
-    bool operator< (const NodeInfo &second) const {
-        if (this->isTimeout) {
-            return false;
-        } else if (second.isTimeout) {
-            return true;
-        } else if (this->isChecked && !second.isChecked) {
-            return true;
-        } else if (!this->isChecked && second.isChecked) {
-            return false;
-        } else {
-            return this->ping < second.ping;
-        }
-    }
-};
-
 class NsLookup : public QObject
 {
     Q_OBJECT
 private:
 
-    struct CacheDns {
-        std::map<QString, std::vector<QString>> cache;
-        time_point lastUpdate;
-    };
+    // Отсортированные ноды без таймаутов для каждого типа. После публикации не изменяются
+    using NodesSnapshot = std::map<QString, std::vector<NodeInfo>>;
 
 public:
     explicit NsLookup(QObject *parent = nullptr);
@@ -107,16 +86,40 @@ public slots:
 
     void uploadEvent();
 
+    void probeEvent();
+
+    void dnsExpireEvent();
+
     void callbackCall(SimpleClient::ReturnCallback callback);
 
 private:
 
     void sortAll();
 
+    void publishSnapshot();
+
     system_time_point fillNodesFromFile(const QString &file, const std::map<QString, NodeType> &expectedNodes);
 
     void saveToFile(const QString &file, const system_time_point &tp, const std::map<QString, NodeType> &expectedNodes);
 
+    void resolveAll();
+
+    void resolveDns(const QString &name, size_t countRepeat, bool isBackground);
+
+    std::set<QString> getDnsNames() const;
+
+    void refreshStaleDns(const std::set<QString> &staleNames);
+
+    void scheduleDnsExpire();
+
+    void saveDnsCacheToFile(const QString &file) const;
+
+    void finalizeResolveAll();
+
+    void mergeResolved();
+
+    void applyProbeResult(const NodeType::Node &node, const NodeInfo &result);
+
     void continueResolve(std::map<QString, NodeType>::const_iterator node);
 
     void continuePing(std::vector<QString>::const_iterator ipsIter, std::map<QString, NodeType>::const_iterator node);
@@ -131,21 +134,14 @@ private:
 
     std::vector<QString> getRandom(const QString &type, size_t limit, size_t count, const std::function<QString(const NodeInfo &node)> &process) const;
 
-    bool repeatResolveDns(
-        const QString &dnsServerName,
-        int dnsServerPort,
-        const QByteArray &byteArray,
-        std::map<QString, NodeType>::const_iterator node,
-        time_point now,
-        size_t countRepeat
-    );
-
 private:
 
     UdpSocketClient udpClient;
 
     QString savedNodesPath;
 
+    QString savedDnsCachePath;
+
     std::map<QString, NodeType> nodes;
 
     std::vector<QString> ipsTemp;
@@ -158,12 +154,28 @@ private:
 
     std::map<NodeType::Node, std::vector<NodeInfo>> allNodesForTypesP2P;
 
-    mutable std::mutex nodeMutex;
+    std::shared_ptr<const NodesSnapshot> snapshot; // Доступ только через std::atomic_load/std::atomic_store
 
     QThread thread1;
 
     QTimer qtimer;
 
+    QTimer probeTimer;
+
+    QTimer dnsExpireTimer;
+
+    std::deque<std::pair<NodeType::Node, QString>> probeQueue;
+
+    size_t countProbesPending = 0;
+
+    size_t probesPerMinute;
+
+    milliseconds probesCredit{0};
+
+    bool isIncrementalMode = false;
+
+    bool isRefresh = false;
+
     SimpleClient client;
 
     time_point startScanTime;
@@ -176,7 +188,15 @@ private:
 
     std::atomic<bool> isStopped{false};
 
-    CacheDns cacheDns;
+    dns_cache::Cache cacheDns;
+
+    std::set<QString> refreshingDnsNames;
+
+    size_t countResolveDnsPending = 0;
+
+    bool isResolveDnsFailed = false;
+
+    quint16 nextDnsRequestId = 0;
 
     int countSuccessTestsForP2PNodes = 0;
 
@@ -0,0 +1,156 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+   Выполняет func для индексов [from, to) на всех ядрах. Первое исключение из рабочих потоков пробрасывается наружу.
+   На каждый поток приходится не меньше minCountPerThread индексов, чтобы запуск потоков окупался,
+   поэтому короткие диапазоны выполняются в вызывающем потоке
+ */
+template<typename Func>
+void parallelFor(size_t from, size_t to, size_t minCountPerThread, const Func &func) {
+    const size_t countByWork = (to - from) / std::max(size_t(1), minCountPerThread);
+    const size_t countThreads = std::min(size_t(std::max(1u, std::thread::hardware_concurrency())), countByWork);
+    if (countThreads <= 1) {
+        for (size_t i = from; i < to; i++) {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(from);
+    std::exception_ptr exception;
+    std::mutex exceptionMut;
+    const auto worker = [&] {
+        while (true) {
+            const size_t i = next++;
+            if (i >= to) {
+                break;
+            }
+            try {
+                func(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(exceptionMut);
+                if (exception == nullptr) {
+                    exception = std::current_exception();
+                }
+                next = to;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(countThreads - 1);
+    for (size_t i = 1; i < countThreads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+    if (exception != nullptr) {
+        std::rethrow_exception(exception);
+    }
+}
+
+template<typename Func>
+void parallelFor(size_t from, size_t to, const Func &func) {
+    parallelFor(from, to, 1, func);
+}
+
+/*
+   То же, что parallelFor, но индексы разбиты на блоки по blockSize. После завершения каждого блока
+   в вызывающем потоке по порядку вызывается onBlock(blockFrom, blockTo).
+   Потоки запускаются один раз на весь диапазон, а не на каждый блок
+ */
+template<typename Func, typename OnBlock>
+void parallelForBlocks(size_t from, size_t to, size_t blockSize, const Func &func, const OnBlock &onBlock, size_t maxThreads = std::thread::hardware_concurrency()) {
+    blockSize = std::max(size_t(1), blockSize);
+    const size_t countThreads = std::min(std::max(size_t(1), maxThreads), to - from);
+    if (countThreads <= 1) {
+        for (size_t blockFrom = from; blockFrom < to; blockFrom += blockSize) {
+            const size_t blockTo = std::min(blockFrom + blockSize, to);
+            for (size_t i = blockFrom; i < blockTo; i++) {
+                func(i);
+            }
+            onBlock(blockFrom, blockTo);
+        }
+        return;
+    }
+
+    const size_t countBlocks = (to - from + blockSize - 1) / blockSize;
+    std::unique_ptr<std::atomic<size_t>[]> countDone(new std::atomic<size_t>[countBlocks]);
+    for (size_t i = 0; i < countBlocks; i++) {
+        countDone[i] = 0;
+    }
+
+    std::atomic<size_t> next(from);
+    std::exception_ptr exception;
+    std::mutex exceptionMut;
+    const auto setException = [&](std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(exceptionMut);
+        if (exception == nullptr) {
+            exception = e;
+        }
+        next = to;
+    };
+    const auto processNext = [&]() -> bool {
+        const size_t i = next++;
+        if (i >= to) {
+            return false;
+        }
+        try {
+            func(i);
+        } catch (...) {
+            setException(std::current_exception());
+            return false;
+        }
+        countDone[(i - from) / blockSize]++;
+        return true;
+    };
+
+    size_t nextBlock = 0;
+    const auto finishReadyBlocks = [&] {
+        while (nextBlock < countBlocks) {
+            const size_t blockFrom = from + nextBlock * blockSize;
+            const size_t blockTo = std::min(blockFrom + blockSize, to);
+            if (countDone[nextBlock].load() != blockTo - blockFrom) {
+                break;
+            }
+            nextBlock++;
+            onBlock(blockFrom, blockTo);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(countThreads - 1);
+    for (size_t i = 1; i < countThreads; i++) {
+        threads.emplace_back([&] {
+            while (processNext()) {}
+        });
+    }
+    try {
+        while (processNext()) {
+            finishReadyBlocks();
+        }
+    } catch (...) {
+        // Исключение из onBlock. Рабочие потоки нужно дождаться до выхода
+        setException(std::current_exception());
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+    if (exception != nullptr) {
+        std::rethrow_exception(exception);
+    }
+    finishReadyBlocks();
+}
+
+#endif // PARALLELFOR_H
@@ -0,0 +1,128 @@
+#ifndef PERFECTHASH_H
+#define PERFECTHASH_H
+
+#include <cstdint>
+#include <cstddef>
+
+/*
+   Таблица строка -> значение для небольшого заранее известного набора строк.
+   Seed хеша подбирается на этапе компиляции так, чтобы у всех строк были разные слоты,
+   поэтому поиск - это один хеш и одно сравнение строки.
+ */
+
+template<typename T>
+struct PerfectHashItem {
+    const char *name;
+    T value;
+};
+
+constexpr uint32_t perfectHashStep(uint32_t hash, uint32_t c) {
+    return (hash ^ c) * 16777619u;
+}
+
+// Младшие биты FNV зависят только от младших битов seed, поэтому в конце биты перемешиваются
+constexpr uint32_t perfectHashFinish(uint32_t hash) {
+    return ((hash ^ (hash >> 15)) * 0x2c1b3c6du) ^ (hash >> 13);
+}
+
+constexpr uint32_t perfectHash(const char *str, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; str[i] != 0; i++) {
+        hash = perfectHashStep(hash, static_cast<unsigned char>(str[i]));
+    }
+    return perfectHashFinish(hash);
+}
+
+template<typename Char>
+uint32_t perfectHash(const Char *begin, const Char *end, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (const Char *c = begin; c != end; c++) {
+        hash = perfectHashStep(hash, static_cast<uint32_t>(*c));
+    }
+    return perfectHashFinish(hash);
+}
+
+template<typename T, size_t N, size_t SIZE>
+class PerfectHashTable {
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be power of 2");
+    static_assert(N <= SIZE, "Too many items");
+public:
+
+    constexpr explicit PerfectHashTable(const PerfectHashItem<T> (&items_)[N])
+        : items{}
+        , slots{}
+    {
+        for (size_t i = 0; i < N; i++) {
+            items[i] = items_[i];
+        }
+        for (uint32_t s = 0; s < MAX_SEED; s++) {
+            if (fill(s)) {
+                seed = s;
+                perfect = true;
+                return;
+            }
+        }
+    }
+
+    constexpr bool isPerfect() const {
+        return perfect;
+    }
+
+    // Возвращает false, если строки нет в таблице
+    template<typename Char>
+    bool find(const Char *begin, const Char *end, T &value) const {
+        const int slot = slots[perfectHash(begin, end, seed) & (SIZE - 1)];
+        if (slot == 0) {
+            return false;
+        }
+        const PerfectHashItem<T> &item = items[slot - 1];
+        const Char *c = begin;
+        size_t i = 0;
+        for (; c != end && item.name[i] != 0; c++, i++) {
+            if (static_cast<uint32_t>(*c) != static_cast<unsigned char>(item.name[i])) {
+                return false;
+            }
+        }
+        if (c != end || item.name[i] != 0) {
+            return false;
+        }
+        value = item.value;
+        return true;
+    }
+
+private:
+
+    constexpr bool fill(uint32_t s) {
+        for (size_t i = 0; i < SIZE; i++) {
+            slots[i] = 0;
+        }
+        for (size_t i = 0; i < N; i++) {
+            const uint32_t slot = perfectHash(items[i].name, s) & (SIZE - 1);
+            if (slots[slot] != 0) {
+                return false;
+            }
+            // 0 - пустой слот
+            slots[slot] = static_cast<int>(i + 1);
+        }
+        return true;
+    }
+
+private:
+
+    static const uint32_t MAX_SEED = 1000;
+
+    PerfectHashItem<T> items[N];
+
+    int slots[SIZE];
+
+    uint32_t seed = 0;
+
+    bool perfect = false;
+};
+
+template<size_t SIZE, typename T, size_t N>
+constexpr PerfectHashTable<T, N, SIZE> makePerfectHashTable(const PerfectHashItem<T> (&items)[N]) {
+    return PerfectHashTable<T, N, SIZE>(items);
+}
+
+#endif // PERFECTHASH_H
@@ -0,0 +1,295 @@
+#include "Sha256Hasher.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SHA256_SHA_NI 1
+#endif
+
+#ifdef SHA256_SHA_NI
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// gcc и clang собирают SHA-NI код без глобальных -msha -msse4.1
+#if defined(SHA256_SHA_NI) && defined(__GNUC__)
+#define SHA_NI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#define SHA_NI_TARGET
+#endif
+
+alignas(16) static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t INITIAL_STATE[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t readBigEndian(const uint8_t *p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+static inline void writeBigEndian(uint8_t *p, uint32_t x) {
+    p[0] = uint8_t(x >> 24);
+    p[1] = uint8_t(x >> 16);
+    p[2] = uint8_t(x >> 8);
+    p[3] = uint8_t(x);
+}
+
+const size_t Sha256Hasher::DIGEST_SIZE;
+const size_t Sha256Hasher::BLOCK_SIZE;
+
+// Расписание сообщения зависит от хэшируемых данных (в scrypt это пароль), поэтому после сжатия стирается
+static void secureZero(void *data, size_t size) {
+    volatile uint8_t *p = static_cast<volatile uint8_t*>(data);
+    while (size-- != 0) {
+        *p++ = 0;
+    }
+}
+
+static void portableCompress(uint32_t *state, const uint8_t *blocks, size_t countBlocks) {
+    uint32_t w[64];
+    for (; countBlocks != 0; countBlocks--, blocks += Sha256Hasher::BLOCK_SIZE) {
+        for (size_t i = 0; i < 16; i++) {
+            w[i] = readBigEndian(blocks + i * 4);
+        }
+        for (size_t i = 16; i < 64; i++) {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (size_t i = 0; i < 64; i++) {
+            const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+    secureZero(w, sizeof(w));
+}
+
+#ifdef SHA256_SHA_NI
+
+static bool hasShaNi() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool sse = ((info[2] >> 19) & 1) != 0 && ((info[2] >> 9) & 1) != 0;
+    __cpuidex(info, 7, 0);
+    return sse && ((info[1] >> 29) & 1) != 0;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) < 7) {
+        return false;
+    }
+    __cpuid(1, eax, ebx, ecx, edx);
+    const bool sse = (ecx & bit_SSE4_1) != 0 && (ecx & bit_SSSE3) != 0;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return sse && ((ebx >> 29) & 1) != 0;
+#endif
+}
+
+/*
+   Состояние в SHA-NI хранится как ABEF и CDGH.
+   Расписание сообщения считается кольцом из 4 регистров по 4 слова
+ */
+SHA_NI_TARGET static void shaNiCompress(uint32_t *state, const uint8_t *blocks, size_t countBlocks) {
+    const __m128i SHUFFLE_MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    for (; countBlocks != 0; countBlocks--, blocks += Sha256Hasher::BLOCK_SIZE) {
+        const __m128i abefSave = state0;
+        const __m128i cdghSave = state1;
+
+        __m128i msg[4];
+        for (int i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + i * 16)), SHUFFLE_MASK);
+        }
+
+        for (int i = 0; i < 16; i++) {
+            if (i >= 4) {
+                __m128i &w = msg[i & 3];
+                w = _mm_sha256msg1_epu32(w, msg[(i + 1) & 3]);
+                w = _mm_add_epi32(w, _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+                w = _mm_sha256msg2_epu32(w, msg[(i + 3) & 3]);
+            }
+            __m128i rounds = _mm_add_epi32(msg[i & 3], _mm_load_si128(reinterpret_cast<const __m128i*>(&K[i * 4])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, rounds);
+            rounds = _mm_shuffle_epi32(rounds, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, rounds);
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+
+        secureZero(msg, sizeof(msg));
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+#endif // SHA256_SHA_NI
+
+using CompressFunc = void (*)(uint32_t *state, const uint8_t *blocks, size_t countBlocks);
+
+static CompressFunc selectCompress() {
+#ifdef SHA256_SHA_NI
+    if (hasShaNi()) {
+        return shaNiCompress;
+    }
+#endif
+    return portableCompress;
+}
+
+static CompressFunc getCompress() {
+    static const CompressFunc compress = selectCompress();
+    return compress;
+}
+
+void Sha256Hasher::compress(uint32_t *state, const uint8_t *blocks, size_t countBlocks) {
+    getCompress()(state, blocks, countBlocks);
+}
+
+bool Sha256Hasher::isHardwareAccelerated() {
+    return getCompress() != portableCompress;
+}
+
+void Sha256Hasher::compressPortable(uint32_t *state, const uint8_t *blocks, size_t countBlocks) {
+    portableCompress(state, blocks, countBlocks);
+}
+
+bool Sha256Hasher::compressShaNi(uint32_t *state, const uint8_t *blocks, size_t countBlocks) {
+#ifdef SHA256_SHA_NI
+    static const bool isSupported = hasShaNi();
+    if (isSupported) {
+        shaNiCompress(state, blocks, countBlocks);
+        return true;
+    }
+#else
+    (void)state;
+    (void)blocks;
+    (void)countBlocks;
+#endif
+    return false;
+}
+
+Sha256Hasher::Sha256Hasher() {
+    std::memcpy(state, INITIAL_STATE, sizeof(state));
+}
+
+void Sha256Hasher::update(const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    totalSize += size;
+    if (bufferSize != 0) {
+        const size_t toCopy = std::min(size, BLOCK_SIZE - bufferSize);
+        std::memcpy(buffer + bufferSize, bytes, toCopy);
+        bufferSize += toCopy;
+        bytes += toCopy;
+        size -= toCopy;
+        if (bufferSize != BLOCK_SIZE) {
+            return;
+        }
+        compress(state, buffer, 1);
+        bufferSize = 0;
+    }
+    const size_t countBlocks = size / BLOCK_SIZE;
+    if (countBlocks != 0) {
+        compress(state, bytes, countBlocks);
+        bytes += countBlocks * BLOCK_SIZE;
+        size -= countBlocks * BLOCK_SIZE;
+    }
+    std::memcpy(buffer, bytes, size);
+    bufferSize = size;
+}
+
+void Sha256Hasher::update(const std::string &data) {
+    update(data.data(), data.size());
+}
+
+void Sha256Hasher::finish(uint8_t *digest) {
+    const uint64_t bitSize = totalSize * 8;
+    buffer[bufferSize++] = 0x80;
+    if (bufferSize > BLOCK_SIZE - 8) {
+        std::memset(buffer + bufferSize, 0, BLOCK_SIZE - bufferSize);
+        compress(state, buffer, 1);
+        bufferSize = 0;
+    }
+    std::memset(buffer + bufferSize, 0, BLOCK_SIZE - 8 - bufferSize);
+    writeBigEndian(buffer + BLOCK_SIZE - 8, uint32_t(bitSize >> 32));
+    writeBigEndian(buffer + BLOCK_SIZE - 4, uint32_t(bitSize));
+    compress(state, buffer, 1);
+
+    for (size_t i = 0; i < 8; i++) {
+        writeBigEndian(digest + i * 4, state[i]);
+    }
+    std::memset(buffer, 0, sizeof(buffer));
+    bufferSize = 0;
+}
+
+void Sha256Hasher::hash(const void *data, size_t size, uint8_t *digest) {
+    Sha256Hasher hasher;
+    hasher.update(data, size);
+    hasher.finish(digest);
+}
+
+std::string Sha256Hasher::hash(const std::string &data) {
+    std::string result(DIGEST_SIZE, 0);
+    hash(data.data(), data.size(), reinterpret_cast<uint8_t*>(&result[0]));
+    return result;
+}
+
+std::string Sha256Hasher::doubleHash(const std::string &data) {
+    uint8_t first[DIGEST_SIZE];
+    hash(data.data(), data.size(), first);
+    std::string result(DIGEST_SIZE, 0);
+    hash(first, DIGEST_SIZE, reinterpret_cast<uint8_t*>(&result[0]));
+    return result;
+}
@@ -0,0 +1,58 @@
+#ifndef SHA256HASHER_H
+#define SHA256HASHER_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/*
+   Общий SHA-256 для всех мест, где он считается (адреса, подписи, btc, pbkdf2 в scrypt).
+   Функция сжатия блоков выбирается один раз по возможностям процессора:
+   SHA-NI, если есть, иначе переносимая реализация.
+ */
+class Sha256Hasher {
+public:
+
+    static const size_t DIGEST_SIZE = 32;
+
+    static const size_t BLOCK_SIZE = 64;
+
+public:
+
+    Sha256Hasher();
+
+    void update(const void *data, size_t size);
+
+    void update(const std::string &data);
+
+    void finish(uint8_t *digest);
+
+    static void hash(const void *data, size_t size, uint8_t *digest);
+
+    static std::string hash(const std::string &data);
+
+    static std::string doubleHash(const std::string &data);
+
+    // Сжимает countBlocks подряд идущих блоков по BLOCK_SIZE байт
+    static void compress(uint32_t *state, const uint8_t *blocks, size_t countBlocks);
+
+    static bool isHardwareAccelerated();
+
+    // Реализации по отдельности, чтобы тесты проверяли обе независимо от процессора
+    static void compressPortable(uint32_t *state, const uint8_t *blocks, size_t countBlocks);
+
+    // Возвращает false, если процессор не поддерживает SHA-NI
+    static bool compressShaNi(uint32_t *state, const uint8_t *blocks, size_t countBlocks);
+
+private:
+
+    uint32_t state[8];
+
+    uint8_t buffer[BLOCK_SIZE];
+
+    size_t bufferSize = 0;
+
+    uint64_t totalSize = 0;
+};
+
+#endif // SHA256HASHER_H
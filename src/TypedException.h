@@ -33,6 +33,7 @@ enum TypeErrors {
     INCOMPLETE_USER_INFO = 110,
     CHANNEL_TITLE_INCORRECT = 111,
     MESSENGER_NOT_CONFIGURED = 112,
+    MESSENGER_SEARCH_NOT_SUPPORTED = 113,
 
     TRANSACTIONS_SERVER_SEND_ERROR = 200,
     TRANSACTIONS_SENDED_NOT_FOUND = 201,
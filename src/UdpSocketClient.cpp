@@ -39,60 +39,87 @@ void UdpSocketClient::startTm() {
     isTimerStarted = true;
 }
 
+quint16 UdpSocketClient::getRequestId(const char *data, size_t size) {
+    CHECK(size >= 2, "Incorrect udp packet");
+    return (quint16(static_cast<unsigned char>(data[0])) << 8) | quint16(static_cast<unsigned char>(data[1]));
+}
+
 void UdpSocketClient::onTimerEvent() {
 BEGIN_SLOT_WRAPPER
-    if (isCurrentRequest) {
-        const time_point now = ::now();
-        if (now - beginTime >= timeout) {
-            socket.abort();
-            processResponse(std::vector<char>(), SocketException(1000, "Timeout"));
+    const time_point now = ::now();
+    std::vector<quint16> timeouted;
+    for (const auto &pair: requests) {
+        if (now - pair.second.beginTime >= pair.second.timeout) {
+            timeouted.emplace_back(pair.first);
         }
     }
+    for (const quint16 requestId: timeouted) {
+        processResponse(requestId, std::vector<char>(), SocketException(1000, "Timeout"));
+    }
 END_SLOT_WRAPPER
 }
 
 void UdpSocketClient::sendRequest(const QHostAddress &address, int port, const std::vector<char> &request, const UdpSocketCallback &responseCallback, milliseconds timeout) {
     CHECK(isTimerStarted, "Timer not started");
-    CHECK(!isCurrentRequest, "Request already running");
+    const quint16 requestId = getRequestId(request.data(), request.size());
+    CHECK(!isRequestRunning(requestId), "Request " + std::to_string(requestId) + " already running");
 
-    beginTime = ::now();
-    this->timeout = timeout;
+    Request &req = requests[requestId];
+    req.beginTime = ::now();
+    req.timeout = timeout;
+    req.callback = responseCallback;
 
-    currentCallback = responseCallback;
-    isCurrentRequest = true;
     const auto result = socket.writeDatagram(request.data(), request.size(), address, port);
     if (result == -1) {
-        isCurrentRequest = false;
+        requests.erase(requestId);
         throwErr("Write udp request error");
     }
 }
 
+bool UdpSocketClient::isRequestRunning(quint16 requestId) const {
+    return requests.find(requestId) != requests.end();
+}
+
 void UdpSocketClient::closeSock() {
     socket.abort();
 }
 
-void UdpSocketClient::processResponse(const std::vector<char> &response, const SocketException &exception) {
-    CHECK(isCurrentRequest, "callback not set");
-    const UdpSocketCallback copyCallback = currentCallback; // Копируем
-    isCurrentRequest = false;
+void UdpSocketClient::processResponse(quint16 requestId, const std::vector<char> &response, const SocketException &exception) {
+    const auto found = requests.find(requestId);
+    CHECK(found != requests.end(), "callback not set");
+    const UdpSocketCallback copyCallback = found->second.callback; // Копируем
+    requests.erase(found);
     emit callbackCall(std::bind(copyCallback, response, exception));
 }
 
 void UdpSocketClient::onReadyRead() {
 BEGIN_SLOT_WRAPPER
-    std::vector<char> response;
     while (socket.hasPendingDatagrams()) {
         const QNetworkDatagram datagram = socket.receiveDatagram();
-        const auto data = datagram.data();
-        response.insert(response.end(), data.begin(), data.end());
+        const QByteArray data = datagram.data();
+        if (data.size() < 2) {
+            LOG << "Incorrect udp response size " << data.size();
+            continue;
+        }
+        const quint16 requestId = getRequestId(data.data(), data.size());
+        if (!isRequestRunning(requestId)) {
+            LOG << "Udp response for unknown request " << requestId;
+            continue;
+        }
+        processResponse(requestId, std::vector<char>(data.begin(), data.end()), SocketException());
     }
-
-    processResponse(response, SocketException());
 END_SLOT_WRAPPER
 }
 
 void UdpSocketClient::onSocketError(QAbstractSocket::SocketError socketError) {
 BEGIN_SLOT_WRAPPER
-    processResponse(std::vector<char>(), SocketException(socketError, socket.errorString().toStdString()));
+    const SocketException exception(socketError, socket.errorString().toStdString());
+    std::vector<quint16> running;
+    for (const auto &pair: requests) {
+        running.emplace_back(pair.first);
+    }
+    for (const quint16 requestId: running) {
+        processResponse(requestId, std::vector<char>(), exception);
+    }
 END_SLOT_WRAPPER
 }
@@ -7,6 +7,7 @@
 #include <QTimer>
 
 #include <functional>
+#include <map>
 
 #include "duration.h"
 
@@ -53,8 +54,11 @@ public:
 
     void mvToThread(QThread *thread);
 
+    // Запросов может быть несколько одновременно. Ответ сопоставляется с запросом по первым 2 байтам пакета (transaction id dns)
     void sendRequest(const QHostAddress &address, int port, const std::vector<char> &request, const UdpSocketCallback &responseCallback, milliseconds timeout);
 
+    bool isRequestRunning(quint16 requestId) const;
+
     void startTm();
 
     void closeSock();
@@ -73,7 +77,17 @@ private slots:
 
 private:
 
-    void processResponse(const std::vector<char> &response, const SocketException &exception);
+    struct Request {
+        UdpSocketCallback callback;
+        time_point beginTime;
+        milliseconds timeout;
+    };
+
+private:
+
+    static quint16 getRequestId(const char *data, size_t size);
+
+    void processResponse(quint16 requestId, const std::vector<char> &response, const SocketException &exception);
 
 private:
 
@@ -85,13 +99,7 @@ private:
 
     bool isTimerStarted = false;
 
-    UdpSocketCallback currentCallback;
-
-    bool isCurrentRequest = false;
-
-    time_point beginTime;
-
-    milliseconds timeout;
+    std::map<quint16, Request> requests;
 
 };
 
@@ -46,7 +46,7 @@ public:
 
     static std::string genTx(const std::string &toAddress, uint64_t value, uint64_t fee, uint64_t nonce, const std::string &dataHex, bool isCheckHash);
 
-    void sign(const std::string &toAddress, uint64_t value, uint64_t fee, uint64_t nonce, const std::string &data, std::string &txHex, std::string &signature, std::string &publicKey, bool isCheckHash=true);
+    void sign(const std::string &toAddress, uint64_t value, uint64_t fee, uint64_t nonce, const std::string &data, std::string &txHex, std::string &signature, std::string &publicKey, bool isCheckHash=true) const;
 
     std::string getNotProtectedKeyHex() const;
 
@@ -74,6 +74,12 @@ private:
 
     CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PrivateKey privateKey;
 
+    // Ключ secp256k1 в сыром виде для libsecp256k1. Пустой для остальных кривых.
+    // SecByteBlock затирает память при уничтожении
+    CryptoPP::SecByteBlock rawPrivateKeyK1;
+
+    std::string publicKeyHex;
+
     QString folder;
     std::string name;
 
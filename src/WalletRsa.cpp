@@ -4,17 +4,25 @@
 #include "utils.h"
 
 #include "openssl_wrapper/openssl_wrapper.h"
+#include "openssl_wrapper/RsaKeyCache.h"
 
 const static QString FOLDER_RSA_KEYS("rsa/");
 const static QString FILE_PRIV_KEY_SUFFIX(".rsa.priv");
 const static QString FILE_PUB_KEY_SUFFIX(".rsa.pub");
 
+const static size_t MAX_COUNT_CACHED_PUBLIC_KEYS = 256;
+
+static RsaKeyCache& getPublicKeysCache() {
+    static RsaKeyCache cache(MAX_COUNT_CACHED_PUBLIC_KEYS);
+    return cache;
+}
+
 WalletRsa::WalletRsa(const QString &folder, const std::string &addr)
     : folder(folder)
     , address(addr)
     , publicKey(getPublicRsaKey(folder, addr))
 {
-    publicKeyRsa = ::getPublicRsa(publicKey);
+    publicKeyRsa = std::make_shared<const RsaKey>(::getPublicRsa(publicKey));
 }
 
 QString WalletRsa::genFolderRsa(const QString &folder) {
@@ -24,7 +32,7 @@ QString WalletRsa::genFolderRsa(const QString &folder) {
 WalletRsa WalletRsa::fromPublicKey(const std::string &publicKey) {
     WalletRsa wallet;
     wallet.publicKey = publicKey;
-    wallet.publicKeyRsa = ::getPublicRsa(publicKey);
+    wallet.publicKeyRsa = getPublicKeysCache().getPublicKey(publicKey);
     return wallet;
 }
 
@@ -54,7 +62,7 @@ std::vector<QString> WalletRsa::getPathsKeys(const QString &folder, const QStrin
 
 std::string WalletRsa::encrypt(const std::string &message) const {
     CHECK(publicKeyRsa != nullptr, "Publik key not set");
-    return ::encrypt(publicKeyRsa, message, publicKey);
+    return ::encrypt(*publicKeyRsa, message, publicKey);
 }
 
 void WalletRsa::unlock(const std::string &password) {
@@ -67,7 +75,7 @@ void WalletRsa::unlock(const std::string &password) {
     const std::string privateKey = readFile(fileName);
     privateKeyRsa = getPrivateRsa(privateKey, password);
 
-    CHECK(validatePublicKey(privateKeyRsa, publicKeyRsa), "Public key damaged");
+    CHECK(validatePublicKey(privateKeyRsa, *publicKeyRsa), "Public key damaged");
 }
 
 void WalletRsa::createRsaKey(const QString &folder, const std::string &addr, const std::string &password) {
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 
 #include <QString>
 
@@ -13,6 +14,7 @@ public:
 
     WalletRsa(const QString &folder, const std::string &addr);
 
+    // Разобранный ключ берется из общего для всех потоков кэша
     static WalletRsa fromPublicKey(const std::string &publicKey);
 
     static void createRsaKey(const QString &folder, const std::string &addr, const std::string &password);
@@ -26,6 +28,7 @@ public:
 
     void unlock(const std::string &password);
 
+    // Может вызываться одновременно из нескольких потоков
     std::string decryptMessage(const std::string &encryptedMessageHex) const;
 
     static QString genFolderRsa(const QString &folder);
@@ -50,7 +53,7 @@ private:
 
     std::string publicKey;
 
-    RsaKey publicKeyRsa;
+    std::shared_ptr<const RsaKey> publicKeyRsa;
 
     RsaKey privateKeyRsa;
 
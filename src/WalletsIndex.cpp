@@ -0,0 +1,71 @@
+#include "WalletsIndex.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include "check.h"
+
+const qint64 WalletsIndex::MODIFIED_PRECISION_MS;
+
+static QString normalizeFolder(const QString &folder) {
+    return QDir(folder).absolutePath();
+}
+
+static QDateTime getModified(const QString &folderPath) {
+    return QFileInfo(folderPath).lastModified();
+}
+
+WalletsIndex::WalletsIndex(qint64 modifiedPrecisionMs)
+    : modifiedPrecisionMs(modifiedPrecisionMs)
+{}
+
+bool WalletsIndex::isActual(const Folder &folder, const QDateTime &modified) const {
+    return modified.isValid() && folder.modified == modified && folder.modified.msecsTo(folder.readTime) >= modifiedPrecisionMs;
+}
+
+WalletsIndex::Folder& WalletsIndex::read(Folder &cached, const QString &folderPath, const QString &folder, const ListFunc &listFunc) {
+    // Время берется до чтения, чтобы изменение во время чтения не потерялось
+    Folder result;
+    result.modified = getModified(folderPath);
+    result.readTime = QDateTime::currentDateTime();
+    result.wallets = listFunc(folder);
+
+    cached = std::move(result);
+    return cached;
+}
+
+void WalletsIndex::addFolder(const QString &folder) {
+    CHECK(!folder.isNull() && !folder.isEmpty(), "Incorrect path to wallet: empty");
+    folders[normalizeFolder(folder)];
+}
+
+WalletsIndex::Wallets WalletsIndex::get(const QString &folder, const ListFunc &listFunc) {
+    CHECK(!folder.isNull() && !folder.isEmpty(), "Incorrect path to wallet: empty");
+    const QString folderPath = normalizeFolder(folder);
+    const auto found = folders.find(folderPath);
+    if (found == folders.end()) {
+        return listFunc(folder);
+    }
+    if (isActual(found->second, getModified(folderPath))) {
+        return found->second.wallets;
+    }
+    return read(found->second, folderPath, folder, listFunc).wallets;
+}
+
+bool WalletsIndex::refresh(const QString &folder, const ListFunc &listFunc, Wallets &wallets) {
+    CHECK(!folder.isNull() && !folder.isEmpty(), "Incorrect path to wallet: empty");
+    const QString folderPath = normalizeFolder(folder);
+    const auto found = folders.find(folderPath);
+    if (found == folders.end()) {
+        wallets = listFunc(folder);
+        return true;
+    }
+    const bool isRead = found->second.readTime.isValid();
+    const Wallets old = found->second.wallets;
+    wallets = read(found->second, folderPath, folder, listFunc).wallets;
+    return !isRead || wallets != old;
+}
+
+void WalletsIndex::clear() {
+    folders.clear();
+}
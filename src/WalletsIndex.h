@@ -0,0 +1,70 @@
+#ifndef WALLETSINDEX_H
+#define WALLETSINDEX_H
+
+#include <QString>
+#include <QDateTime>
+
+#include <vector>
+#include <map>
+#include <functional>
+
+/*
+   Закэшированные списки кошельков по папкам.
+   Кэшируются только папки, добавленные через addFolder (те, за которыми следит QFileSystemWatcher),
+   остальные папки читаются при каждом запросе.
+   Папка перечитывается, только если изменилось время модификации директории или кэш сброшен явно
+   (например, по сигналу QFileSystemWatcher), так что повторные запросы стоят одного stat.
+   Класс не потокобезопасен.
+ */
+class WalletsIndex {
+public:
+
+    // Адрес и полный путь к файлу
+    using Wallets = std::vector<std::pair<QString, QString>>;
+
+    using ListFunc = std::function<Wallets(const QString &folder)>;
+
+    /*
+       Время модификации директории на части файловых систем хранится с точностью до секунд.
+       Если папку прочитали вскоре после ее изменения, следующее изменение может не поменять это время,
+       поэтому такому чтению не доверяем и перечитываем папку при следующем запросе
+     */
+    const static qint64 MODIFIED_PRECISION_MS = 2000;
+
+public:
+
+    explicit WalletsIndex(qint64 modifiedPrecisionMs = MODIFIED_PRECISION_MS);
+
+    void addFolder(const QString &folder);
+
+    Wallets get(const QString &folder, const ListFunc &listFunc);
+
+    // Перечитывает папку. Возвращает true, если список кошельков отличается от закэшированного
+    bool refresh(const QString &folder, const ListFunc &listFunc, Wallets &wallets);
+
+    // Забывает все папки вместе с их списками
+    void clear();
+
+private:
+
+    struct Folder {
+        Wallets wallets;
+        QDateTime modified;
+        QDateTime readTime;
+    };
+
+private:
+
+    Folder& read(Folder &cached, const QString &folderPath, const QString &folder, const ListFunc &listFunc);
+
+    bool isActual(const Folder &folder, const QDateTime &modified) const;
+
+private:
+
+    const qint64 modifiedPrecisionMs;
+
+    std::map<QString, Folder> folders;
+
+};
+
+#endif // WALLETSINDEX_H
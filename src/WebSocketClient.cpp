@@ -11,6 +11,7 @@
 #include <QTimer>
 
 #include <thread>
+#include <algorithm>
 
 WebSocketClient::WebSocketClient(const QString &url, QObject *parent)
     : TimerClass(1min, parent)
@@ -37,6 +38,8 @@ WebSocketClient::WebSocketClient(const QString &url, QObject *parent)
     CHECK(connect(&m_webSocket, &QWebSocket::connected, this, &WebSocketClient::onConnected), "not connect connected");
     CHECK(connect(&m_webSocket, &QWebSocket::pong, this, &WebSocketClient::onPong), "not connect onPong");
     CHECK(connect(&m_webSocket, &QWebSocket::textMessageReceived, this, &WebSocketClient::onTextMessageReceived), "not connect textMessageReceived");
+    CHECK(connect(&m_webSocket, &QWebSocket::textFrameReceived, this, &WebSocketClient::onTextFrameReceived), "not connect textFrameReceived");
+    CHECK(connect(&m_webSocket, &QWebSocket::bytesWritten, this, &WebSocketClient::onBytesWritten), "not connect bytesWritten");
     CHECK(connect(&m_webSocket, &QWebSocket::disconnected, [this]{
         BEGIN_SLOT_WRAPPER
         LOG << "Wss client disconnected. Url " << m_url.toString();
@@ -75,6 +78,9 @@ END_SLOT_WRAPPER
 void WebSocketClient::onTimerEvent() {
 BEGIN_SLOT_WRAPPER
     LOG << "Wss check ping " << m_url.toString();
+    const Metrics metrics = getMetrics();
+    LOG << "Wss metrics " << m_url.toString() << ". Sent " << metrics.messagesSent << " " << metrics.bytesSent << " " << metrics.messagesSkipped
+        << ". Received " << metrics.messagesReceived << " " << metrics.framesReceived << " " << metrics.bytesReceived;
     const time_point now = ::now();
     if (std::chrono::duration_cast<seconds>(now - prevPongTime) >= 3min) {
         LOG << "Wss close " << m_url.toString();
@@ -103,28 +109,54 @@ void WebSocketClient::start() {
     thread1.start();
 }
 
+WebSocketClient::Metrics WebSocketClient::getMetrics() const {
+    Metrics metrics;
+    metrics.messagesSent = messagesSent.load();
+    metrics.bytesSent = bytesSent.load();
+    metrics.messagesSkipped = messagesSkipped.load();
+    metrics.framesReceived = framesReceived.load();
+    metrics.messagesReceived = messagesReceived.load();
+    metrics.bytesReceived = bytesReceived.load();
+    return metrics;
+}
+
+void WebSocketClient::sendTextMessage(const QString &message) {
+    m_webSocket.sendTextMessage(message);
+    messagesSent++;
+}
+
 void WebSocketClient::onConnected() {
 BEGIN_SLOT_WRAPPER
     LOG << "Wss client connected " << m_url.toString();
     isConnected = true;
     prevPongTime = ::now();
+    // Сообщения, поставленные в очередь до подключения, часто повторяют hello строки. Второй раз их не отправляем
+    std::set<QString> helloSent;
     for (const auto &pair: helloStrings) {
         for (const QString &helloString: pair.second) {
+            if (!helloSent.insert(helloString).second) {
+                messagesSkipped++;
+                continue;
+            }
             LOG << "Wss send hello message " << helloString;
-            m_webSocket.sendTextMessage(helloString);
+            sendTextMessage(helloString);
         }
     }
 
-    sendMessagesInternal();
+    sendMessagesInternal(helloSent);
     emit connectedSock(TypedException());
 END_SLOT_WRAPPER
 }
 
-void WebSocketClient::sendMessagesInternal() {
+void WebSocketClient::sendMessagesInternal(const std::set<QString> &alreadySent) {
     if (isConnected.load()) {
         LOG << "Wss client send message " << (!messageQueue.empty() ? messageQueue.back() : "") << ". Count " << messageQueue.size();
         for (const QString &m: messageQueue) {
-            m_webSocket.sendTextMessage(m);
+            if (alreadySent.find(m) != alreadySent.end()) {
+                messagesSkipped++;
+                continue;
+            }
+            sendTextMessage(m);
         }
         messageQueue.clear();
     }
@@ -163,12 +195,49 @@ END_SLOT_WRAPPER
 
 void WebSocketClient::onAddHelloString(QString message, QString tag) {
 BEGIN_SLOT_WRAPPER
-    helloStrings[tag].emplace_back(message);
+    std::vector<QString> &tagStrings = helloStrings[tag];
+    if (std::find(tagStrings.begin(), tagStrings.end(), message) == tagStrings.end()) {
+        tagStrings.emplace_back(message);
+    }
+END_SLOT_WRAPPER
+}
+
+// Размер строки в utf-8 без перекодирования. Одиночный суррогат кодируется как символ замены (3 байта)
+static size_t utf8Size(const QString &str) {
+    size_t result = 0;
+    const int size = str.size();
+    for (int i = 0; i < size; i++) {
+        const ushort ch = str.at(i).unicode();
+        if (ch < 0x80) {
+            result += 1;
+        } else if (ch < 0x800) {
+            result += 2;
+        } else if (QChar::isHighSurrogate(ch) && i + 1 < size && str.at(i + 1).isLowSurrogate()) {
+            result += 4;
+            i++;
+        } else {
+            result += 3;
+        }
+    }
+    return result;
+}
+
+void WebSocketClient::onTextFrameReceived(const QString &frame, bool /*isLastFrame*/) {
+BEGIN_SLOT_WRAPPER
+    framesReceived++;
+    bytesReceived += utf8Size(frame);
+END_SLOT_WRAPPER
+}
+
+void WebSocketClient::onBytesWritten(qint64 bytes) {
+BEGIN_SLOT_WRAPPER
+    bytesSent += bytes;
 END_SLOT_WRAPPER
 }
 
 void WebSocketClient::onTextMessageReceived(QString message) {
 BEGIN_SLOT_WRAPPER
+    messagesReceived++;
     LOG << "Wss received part: " << message.left(2000);
     emit messageReceived(message);
 END_SLOT_WRAPPER
@@ -4,6 +4,8 @@
 #include <QObject>
 #include <QThread>
 #include <map>
+#include <set>
+#include <atomic>
 #include <QtWebSockets/QWebSocket>
 
 #include "TimerClass.h"
@@ -13,6 +15,18 @@ struct TypedException;
 class WebSocketClient : public TimerClass
 {
     Q_OBJECT
+public:
+
+    struct Metrics {
+        uint64_t messagesSent = 0;
+        uint64_t bytesSent = 0;
+        // Повторы hello строк, которые не были отправлены
+        uint64_t messagesSkipped = 0;
+        uint64_t framesReceived = 0;
+        uint64_t messagesReceived = 0;
+        uint64_t bytesReceived = 0;
+    };
+
 public:
     explicit WebSocketClient(const QString &url, QObject *parent = nullptr);
 
@@ -20,6 +34,9 @@ public:
 
     void start();
 
+    // Можно вызывать из любого потока
+    Metrics getMetrics() const;
+
 signals:
 
     void closed();
@@ -63,9 +80,15 @@ private slots:
 
     void onPong(quint64 elapsedTime, const QByteArray &payload);
 
+    void onTextFrameReceived(const QString &frame, bool isLastFrame);
+
+    void onBytesWritten(qint64 bytes);
+
 private:
 
-    void sendMessagesInternal();
+    void sendMessagesInternal(const std::set<QString> &alreadySent = {});
+
+    void sendTextMessage(const QString &message);
 
 private:
 
@@ -81,6 +104,13 @@ private:
     std::map<QString, std::vector<QString>> helloStrings;
 
     time_point prevPongTime;
+
+    std::atomic<uint64_t> messagesSent{0};
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> messagesSkipped{0};
+    std::atomic<uint64_t> framesReceived{0};
+    std::atomic<uint64_t> messagesReceived{0};
+    std::atomic<uint64_t> bytesReceived{0};
 };
 
 #endif // WEBSOCKETCLIENT_H
@@ -0,0 +1,251 @@
+#include "CoinSelection.h"
+
+#include <algorithm>
+#include <random>
+#include <limits>
+
+#include "check.h"
+
+// Версия, количество выходов, сумма и размер скрипта выхода, locktime
+const static size_t TRANSACTION_OVERHEAD_SIZE = 4 + 1 + 8 + 1 + 4;
+// outpoint, размер скрипта, sequence
+const static size_t INPUT_OVERHEAD_SIZE = 32 + 4 + 1 + 4;
+// Подпись der (до 72 байт) + hashtype и публичный ключ вместе с push опкодами
+const static size_t INPUT_SCRIPT_COMPRESSED_SIZE = 1 + 73 + 1 + 33;
+const static size_t INPUT_SCRIPT_UNCOMPRESSED_SIZE = 1 + 73 + 1 + 65;
+const static size_t P2PKH_OUTPUT_SIZE = 8 + 1 + 25;
+const static uint64_t DUST_CHANGE = 546;
+
+const static size_t BNB_MAX_TRIES = 100000;
+const static size_t KNAPSACK_ITERATIONS = 1000;
+
+struct Utxo {
+    // Сумма за вычетом комиссии за input
+    uint64_t effectiveValue;
+    size_t index;
+};
+
+static size_t varintSize(uint64_t value) {
+    if (value <= 252) {
+        return 1;
+    } else if (value <= 0xFFFF) {
+        return 3;
+    } else if (value <= 0xFFFFFFFF) {
+        return 5;
+    } else {
+        return 9;
+    }
+}
+
+static uint64_t calcFee(uint64_t feePerKb, size_t size) {
+    return (feePerKb * size + 1023) / 1024;
+}
+
+static size_t calcTransactionSize(const CoinSelectionParams &params, size_t countInputs, bool isChange) {
+    return params.baseSize + params.inputSize * countInputs + (isChange ? params.changeOutputSize : 0);
+}
+
+static uint64_t calcTransactionFee(const CoinSelectionParams &params, size_t countInputs, bool isChange) {
+    const uint64_t fee = calcFee(params.feePerKb, params.baseSize) + calcFee(params.feePerKb, params.inputSize) * countInputs + (isChange ? calcFee(params.feePerKb, params.changeOutputSize) : 0);
+    if (!params.isMinFeeBySize) {
+        return fee;
+    }
+    return std::max(fee, uint64_t(calcTransactionSize(params, countInputs, isChange) + params.minFeeOverSize));
+}
+
+// Стоимость части транзакции при поиске. Не меньше доли этой части в итоговой комиссии, поэтому найденного набора на комиссию хватит
+static uint64_t calcPartCost(const CoinSelectionParams &params, size_t size, size_t minFeeOverSize) {
+    const uint64_t fee = calcFee(params.feePerKb, size);
+    if (!params.isMinFeeBySize) {
+        return fee;
+    }
+    return std::max(fee, uint64_t(size + minFeeOverSize));
+}
+
+CoinSelectionParams makeP2pkhCoinSelectionParams(uint64_t target, uint64_t feePerKb, size_t countUtxos, size_t outputScriptSize, bool isCompressedKey) {
+    CoinSelectionParams params;
+    params.target = target;
+    params.feePerKb = feePerKb;
+    // Размер поля количества inputов берется по максимуму, чтобы комиссия не оказалась меньше нужной
+    params.baseSize = TRANSACTION_OVERHEAD_SIZE + varintSize(countUtxos) + outputScriptSize;
+    params.inputSize = INPUT_OVERHEAD_SIZE + (isCompressedKey ? INPUT_SCRIPT_COMPRESSED_SIZE : INPUT_SCRIPT_UNCOMPRESSED_SIZE);
+    params.changeOutputSize = P2PKH_OUTPUT_SIZE;
+    params.minChange = DUST_CHANGE;
+    return params;
+}
+
+/*
+   Ищет набор с суммой в [target, target + costOfChange], при котором сдача не нужна.
+   utxos отсортированы по убыванию. Из подходящих наборов выбирается с наименьшим излишком
+ */
+static bool selectBranchAndBound(const std::vector<Utxo> &utxos, uint64_t target, uint64_t costOfChange, std::vector<size_t> &result) {
+    uint64_t available = 0;
+    for (const Utxo &utxo: utxos) {
+        available += utxo.effectiveValue;
+    }
+    if (available < target) {
+        return false;
+    }
+
+    std::vector<size_t> selection;
+    std::vector<size_t> bestSelection;
+    uint64_t bestExcess = std::numeric_limits<uint64_t>::max();
+    uint64_t value = 0;
+    size_t pos = 0;
+    for (size_t tries = 0; tries < BNB_MAX_TRIES; tries++, pos++) {
+        bool backtrack = false;
+        if (value + available < target || value > target + costOfChange) {
+            backtrack = true;
+        } else if (value >= target) {
+            const uint64_t excess = value - target;
+            if (excess <= bestExcess) {
+                bestExcess = excess;
+                bestSelection = selection;
+            }
+            backtrack = true;
+        }
+
+        if (backtrack) {
+            if (selection.empty()) {
+                break;
+            }
+            // Возвращаем в запас пропущенные utxo и пробуем ветку без последнего взятого
+            for (pos--; pos > selection.back(); pos--) {
+                available += utxos[pos].effectiveValue;
+            }
+            value -= utxos[pos].effectiveValue;
+            selection.pop_back();
+        } else {
+            available -= utxos[pos].effectiveValue;
+            // Ветку с таким же значением, как у только что пропущенного utxo, уже проверили
+            if (selection.empty() || pos - 1 == selection.back() || utxos[pos].effectiveValue != utxos[pos - 1].effectiveValue) {
+                selection.push_back(pos);
+                value += utxos[pos].effectiveValue;
+            }
+        }
+    }
+
+    if (bestSelection.empty()) {
+        return false;
+    }
+    result.clear();
+    for (const size_t i: bestSelection) {
+        result.push_back(utxos[i].index);
+    }
+    return true;
+}
+
+// Случайным перебором ищет набор с наименьшей суммой не меньше target. utxos отсортированы по убыванию
+static uint64_t approximateBestSubset(const std::vector<Utxo> &utxos, uint64_t totalLower, uint64_t target, std::vector<bool> &best) {
+    // Фиксированный seed, чтобы выбор был воспроизводимым
+    std::mt19937 random(static_cast<uint32_t>(utxos.size()));
+    best.assign(utxos.size(), true);
+    uint64_t bestValue = totalLower;
+
+    std::vector<bool> included;
+    for (size_t rep = 0; rep < KNAPSACK_ITERATIONS && bestValue != target; rep++) {
+        included.assign(utxos.size(), false);
+        uint64_t total = 0;
+        bool reachedTarget = false;
+        for (int pass = 0; pass < 2 && !reachedTarget; pass++) {
+            for (size_t i = 0; i < utxos.size(); i++) {
+                if (pass == 0 ? (random() & 1) != 0 : !included[i]) {
+                    total += utxos[i].effectiveValue;
+                    included[i] = true;
+                    if (total >= target) {
+                        reachedTarget = true;
+                        if (total < bestValue) {
+                            bestValue = total;
+                            best = included;
+                        }
+                        total -= utxos[i].effectiveValue;
+                        included[i] = false;
+                    }
+                }
+            }
+        }
+    }
+    return bestValue;
+}
+
+// Подбирает набор с суммой не меньше target. utxos отсортированы по убыванию
+static bool selectKnapsack(const std::vector<Utxo> &utxos, uint64_t target, std::vector<size_t> &result) {
+    std::vector<Utxo> lower;
+    const Utxo *lowestLarger = nullptr;
+    uint64_t totalLower = 0;
+    for (const Utxo &utxo: utxos) {
+        if (utxo.effectiveValue >= target) {
+            lowestLarger = &utxo;
+        } else {
+            lower.push_back(utxo);
+            totalLower += utxo.effectiveValue;
+        }
+    }
+
+    result.clear();
+    if (totalLower < target) {
+        if (lowestLarger == nullptr) {
+            return false;
+        }
+        result.push_back(lowestLarger->index);
+        return true;
+    }
+
+    std::vector<bool> best;
+    const uint64_t bestValue = approximateBestSubset(lower, totalLower, target, best);
+    if (lowestLarger != nullptr && lowestLarger->effectiveValue <= bestValue) {
+        result.push_back(lowestLarger->index);
+        return true;
+    }
+    for (size_t i = 0; i < lower.size(); i++) {
+        if (best[i]) {
+            result.push_back(lower[i].index);
+        }
+    }
+    return true;
+}
+
+CoinSelectionResult selectCoins(const std::vector<uint64_t> &values, const CoinSelectionParams &params) {
+    const uint64_t baseFee = calcPartCost(params, params.baseSize, params.minFeeOverSize);
+    const uint64_t inputFee = calcPartCost(params, params.inputSize, 0);
+    const uint64_t changeFee = calcPartCost(params, params.changeOutputSize, 0);
+
+    // utxo, которые не окупают свою комиссию, не рассматриваются
+    std::vector<Utxo> utxos;
+    utxos.reserve(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i] > inputFee) {
+            utxos.push_back(Utxo{values[i] - inputFee, i});
+        }
+    }
+    std::stable_sort(utxos.begin(), utxos.end(), [](const Utxo &first, const Utxo &second) {
+        return first.effectiveValue > second.effectiveValue;
+    });
+
+    const uint64_t target = params.target + baseFee;
+    // Выход сдачи и ее последующая трата
+    const uint64_t costOfChange = changeFee + inputFee;
+
+    CoinSelectionResult result;
+    if (!selectBranchAndBound(utxos, target, costOfChange, result.indexes)) {
+        const bool found = selectKnapsack(utxos, target + changeFee + params.minChange, result.indexes) || selectKnapsack(utxos, target, result.indexes);
+        CHECK_TYPED(found, TypeErrors::INCORRECT_USER_DATA, "Not enough money. Value to send " + std::to_string(params.target));
+    }
+    std::sort(result.indexes.begin(), result.indexes.end());
+
+    for (const size_t i: result.indexes) {
+        result.value += values[i];
+    }
+    // Итоговая комиссия считается от размера всей транзакции, как в BtcWallet::buildTransaction
+    const uint64_t feeWithoutChange = calcTransactionFee(params, result.indexes.size(), false);
+    const uint64_t feeWithChange = calcTransactionFee(params, result.indexes.size(), true);
+    CHECK(result.value >= params.target + feeWithoutChange, "Incorrect coin selection");
+    if (result.value - params.target >= feeWithChange + params.minChange) {
+        result.fee = feeWithChange;
+        result.change = result.value - params.target - feeWithChange;
+    } else {
+        result.fee = result.value - params.target;
+        result.change = 0;
+    }
+    return result;
+}
@@ -0,0 +1,53 @@
+#ifndef COINSELECTION_H
+#define COINSELECTION_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*
+   Выбор utxo для btc транзакции.
+   Сначала branch and bound ищет набор без сдачи, если не нашел - knapsack подбирает набор со сдачей.
+   Комиссия считается от размера транзакции (сатоши за 1024 байта, как в BtcWallet::buildTransaction)
+   и набирается по частям: за общую часть транзакции, за каждый input и за выход сдачи
+ */
+
+struct CoinSelectionParams {
+    // Сумма перевода
+    uint64_t target = 0;
+
+    uint64_t feePerKb = 0;
+
+    // Размер транзакции без inputов и без выхода сдачи
+    size_t baseSize = 0;
+
+    size_t inputSize = 0;
+
+    size_t changeOutputSize = 0;
+
+    // Сдача меньше этого значения отдается в комиссию
+    uint64_t minChange = 0;
+
+    // Комиссия не меньше размера транзакции + minFeeOverSize, как в BtcWallet::buildTransaction
+    bool isMinFeeBySize = false;
+
+    size_t minFeeOverSize = 0;
+};
+
+struct CoinSelectionResult {
+    // Индексы выбранных utxo во входном массиве
+    std::vector<size_t> indexes;
+
+    uint64_t value = 0;
+
+    uint64_t fee = 0;
+
+    uint64_t change = 0;
+};
+
+// Параметры для перевода с p2pkh адреса на адрес с выходным скриптом размера outputScriptSize
+CoinSelectionParams makeP2pkhCoinSelectionParams(uint64_t target, uint64_t feePerKb, size_t countUtxos, size_t outputScriptSize, bool isCompressedKey);
+
+CoinSelectionResult selectCoins(const std::vector<uint64_t> &values, const CoinSelectionParams &params);
+
+#endif // COINSELECTION_H
@@ -1,18 +1,22 @@
 #include "btctx.h"
 
 #include <algorithm>
-#include "cryptopp/sha.h"
+#include <limits>
 #include "secp256k1/include/secp256k1_recovery.h"
 
 #include <iostream>
 
 #include "check.h"
+#include "Sha256Hasher.h"
+#include "ParallelFor.h"
 
 #include "wif.h"
 #include "ethtx/utils2.h"
 #include "ethtx/const.h"
+#include "ethtx/ethtx.h"
 
-secp256k1_context const* getCtx();
+// Подпись inputа стоит десятки микросекунд, запуск потока сравним с ней, поэтому потоку отдается хотя бы несколько inputов
+const static size_t MIN_INPUTS_PER_THREAD = 4;
 
 void BTCTransaction::AddTransfer(
     const std::string& wif,
@@ -44,44 +48,15 @@ void BTCTransaction::AddTransfer(
     m_Transfers.push_back(transfer);
 }
 
-std::string BTCTransaction::BuildTransaction(uint64_t fee, uint64_t transferAmount) {
+std::string BTCTransaction::BuildTransaction(uint64_t fee, uint64_t transferAmount, bool isParallel) {
     //Собираем дамп для подписи
     const std::string signingdump = buildSignedDump(fee, transferAmount);
-    return signAllInputs(signingdump);
+    return signAllInputs(signingdump, isParallel);
 }
 
 static std::string doubleHash(const std::string& str) {
     //2 раза подсчитываем sha256-хэш от строки
-    CryptoPP::SHA256 sha256;
-    uint8_t sha256hash[CryptoPP::SHA256::DIGESTSIZE] = {0};
-    sha256.CalculateDigest(sha256hash, (uint8_t*)str.data(), str.size());
-    //Подсчитываем хэш от хеша
-    uint8_t sha256hashfinal[CryptoPP::SHA256::DIGESTSIZE] = {0};
-    sha256.CalculateDigest(sha256hashfinal, sha256hash, CryptoPP::SHA256::DIGESTSIZE);
-    return std::string((char*)sha256hashfinal, CryptoPP::SHA256::DIGESTSIZE);
-}
-
-std::string BTCTransaction::removeScripts(const std::string& signingdump, size_t scriptIdx, const std::vector<TransferInfo>& ti) {
-    std::string dump = "";
-    size_t pos = 0;
-    for (size_t i = 0; i < ti.size(); ++i) {
-        //В новую строку копируем все до следующего скрипта в inputе
-        CHECK(signingdump.size() >= ti[i].inscriptoffset, "Incorrect signingdump");
-        dump += signingdump.substr(pos, ti[i].inscriptoffset - pos);
-        pos = ti[i].inscriptoffset;
-        //Если это удаляемый скрипт, то заменяем его на символ 0x00
-        if (i != scriptIdx) {
-            dump.push_back(0);
-        } else {//если искомый скрипт, то копируем в неизменном виде
-            CHECK(signingdump.size() >= ti[i].inscriptsize + pos, "Incorrect signingdump");
-            dump += signingdump.substr(pos, ti[i].inscriptsize);
-        }
-        pos += ti[i].inscriptsize;
-    }
-    //Добавляем остаток строки
-    size_t remoffset = ti[ti.size()-1].inscriptoffset + ti[ti.size()-1].inscriptsize;
-    dump += signingdump.substr(remoffset, signingdump.size()-remoffset);
-    return dump;
+    return Sha256Hasher::doubleHash(str);
 }
 
 std::string BTCTransaction::buildSignedDump(uint64_t fee, uint64_t transferAmount) {
@@ -147,22 +122,56 @@ std::string BTCTransaction::buildSignedDump(uint64_t fee, uint64_t transferAmoun
     return dump;
 }
 
-std::string BTCTransaction::signAllInputs(const std::string& signingdump)
+std::string BTCTransaction::signAllInputs(const std::string& signingdump, bool isParallel)
 {
-    std::string transaction = signingdump;
-    std::string copyTransaction = transaction;
-    const std::vector<TransferInfo> copyTransfers = m_Transfers;
+    CHECK(!m_Transfers.empty(), "Empty inputs");
+    /*
+       Для подписи inputа хэшируется дамп, в котором скрипты остальных inputов заменены на 0x00.
+       Начало такого дампа до скрипта inputа совпадает с началом дампа, где заменены все скрипты,
+       поэтому состояние sha256 на этом месте запоминается и продолжается для каждого inputа без сборки строк
+     */
+    std::string stripped;
+    stripped.reserve(signingdump.size());
+    std::vector<size_t> strippedOffsets;
+    strippedOffsets.reserve(m_Transfers.size());
+    size_t pos = 0;
+    for (const TransferInfo &transfer: m_Transfers) {
+        CHECK(transfer.inscriptoffset >= pos && signingdump.size() >= transfer.inscriptoffset + transfer.inscriptsize, "Incorrect signingdump");
+        stripped.append(signingdump, pos, transfer.inscriptoffset - pos);
+        strippedOffsets.push_back(stripped.size());
+        stripped.push_back(0);
+        pos = transfer.inscriptoffset + transfer.inscriptsize;
+    }
+    CHECK(signingdump.size() >= pos + hashcodetype.size(), "Incorrect signingdump");
+    stripped.append(signingdump, pos, signingdump.size() - pos);
+
+    std::vector<Sha256Hasher> midstates;
+    midstates.reserve(m_Transfers.size());
+    Sha256Hasher hasher;
+    size_t hashed = 0;
+    for (const size_t offset: strippedOffsets) {
+        hasher.update(stripped.data() + hashed, offset - hashed);
+        hashed = offset;
+        midstates.push_back(hasher);
+    }
 
     //Подписываем каждый input
-    for (size_t i = 0; i < m_Transfers.size(); ++i) {
-        //Создаем дамп для подписи конкретного inputа
-        const std::string signtemplate = removeScripts(copyTransaction, i, copyTransfers);
-        //Подсчитываем хэш от дампа
-        const std::string sha256hash = doubleHash(signtemplate);
+    std::vector<std::string> inputScripts(m_Transfers.size());
+    const size_t minInputsPerThread = isParallel ? MIN_INPUTS_PER_THREAD : std::numeric_limits<size_t>::max();
+    parallelFor(0, m_Transfers.size(), minInputsPerThread, [&](size_t i) {
+        const TransferInfo &transfer = m_Transfers[i];
+        //Дописываем к общему началу скрипт inputа и остаток дампа
+        Sha256Hasher signHasher = midstates[i];
+        signHasher.update(signingdump.data() + transfer.inscriptoffset, transfer.inscriptsize);
+        signHasher.update(stripped.data() + strippedOffsets[i] + 1, stripped.size() - strippedOffsets[i] - 1);
+        uint8_t firsthash[Sha256Hasher::DIGEST_SIZE];
+        signHasher.finish(firsthash);
+        uint8_t sha256hash[Sha256Hasher::DIGEST_SIZE];
+        Sha256Hasher::hash(firsthash, sizeof(firsthash), sha256hash);
         //Рассчитывает сигнатуру для конкретного ключа
         secp256k1_ecdsa_signature sig;
-        const bool res = secp256k1_ecdsa_sign(getCtx(), &sig, (const uint8_t*)sha256hash.c_str(),
-                                (const uint8_t*)m_Transfers[i].privkey.c_str(),
+        const bool res = secp256k1_ecdsa_sign(getCtx(), &sig, sha256hash,
+                                (const uint8_t*)transfer.privkey.c_str(),
                                 nullptr, NULL);
         CHECK(res, "not sign");
         size_t signbufsize = 256;
@@ -174,28 +183,29 @@ std::string BTCTransaction::signAllInputs(const std::string& signingdump)
         uint8_t opcode = (uint8_t)signature.size();
         std::string inputscript = std::string((char*)&opcode, 1);
         inputscript += signature;
-        opcode = (uint8_t)m_Transfers[i].pubkey.size();
+        opcode = (uint8_t)transfer.pubkey.size();
         inputscript += std::string((char*)&opcode, 1);
-        inputscript += m_Transfers[i].pubkey;
+        inputscript += transfer.pubkey;
         opcode = (uint8_t)inputscript.size();
-        inputscript = std::string((char*)&opcode, 1) + inputscript;
-        //Устанавливаем сигнатуру в input
-        transaction.replace(m_Transfers[i].inscriptoffset, m_Transfers[i].inscriptsize, inputscript);
-        //Пересчитываем смещения
-        const size_t delta = inputscript.size() - m_Transfers[i].inscriptsize;
-        for (size_t j = i + 1; j < m_Transfers.size(); ++j) {
-            m_Transfers[j].inscriptoffset += delta;
-        }
+        inputScripts[i] = std::string((char*)&opcode, 1) + inputscript;
+    });
+
+    //Устанавливаем сигнатуры в inputы и удаляем хэшкод (4 байта с конца)
+    std::string transaction;
+    transaction.reserve(signingdump.size() + m_Transfers.size() * 256);
+    pos = 0;
+    for (size_t i = 0; i < m_Transfers.size(); ++i) {
+        transaction.append(signingdump, pos, m_Transfers[i].inscriptoffset - pos);
+        transaction += inputScripts[i];
+        pos = m_Transfers[i].inscriptoffset + m_Transfers[i].inscriptsize;
     }
-    //Удаляем хэшкод (4 байта с конца)
-    transaction = transaction.substr(0, transaction.size()-4);
+    transaction.append(signingdump, pos, signingdump.size() - hashcodetype.size() - pos);
     return transaction;
 }
 
-
 std::string BuildBTCTransaction(
     const std::vector<Input>& inputs, uint64_t fee,
-    uint64_t transferAmount, std::string receiveAddress, bool isTestnet
+    uint64_t transferAmount, std::string receiveAddress, bool isTestnet, bool isParallel
 ) {
     BTCTransaction transaction(isTestnet);
     for (size_t i = 0; i < inputs.size(); ++i) {
@@ -208,7 +218,7 @@ std::string BuildBTCTransaction(
             receiveAddress
         );
     }
-    return transaction.BuildTransaction(fee, transferAmount);
+    return transaction.BuildTransaction(fee, transferAmount, isParallel);
 }
 
 std::string calcHashTxNotWitness(const std::string &tx) {
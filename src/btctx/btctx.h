@@ -13,8 +13,9 @@ struct Input
     uint64_t outBalance;
 };
 
+// isParallel = false подписывает inputы в одном потоке, например для сравнения в тестах
 std::string BuildBTCTransaction(const std::vector<Input>& inputs, uint64_t fee,
-                                uint64_t transferAmount, std::string receiveAddress, bool isTestnet);
+                                uint64_t transferAmount, std::string receiveAddress, bool isTestnet, bool isParallel = true);
 
 struct TransferInfo
 {
@@ -52,12 +53,11 @@ public:
                         uint64_t outBalance,
                         std::string receiveAddress
                     );
-    std::string BuildTransaction(uint64_t fee, uint64_t transferAmount);
+    std::string BuildTransaction(uint64_t fee, uint64_t transferAmount, bool isParallel = true);
 
 private:
     std::string buildSignedDump(uint64_t fee, uint64_t transferAmount);
-    std::string signAllInputs(const std::string& signingdump);
-    std::string removeScripts(const std::string& signingdump, size_t scriptIdx, const std::vector<TransferInfo>& ti);
+    std::string signAllInputs(const std::string& signingdump, bool isParallel);
 
     std::vector<TransferInfo> m_Transfers;
     std::string hashcodetype;
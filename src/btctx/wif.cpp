@@ -15,13 +15,13 @@
 #include "../ethtx/scrypt/libscrypt.h"
 
 #include "check.h"
+#include "Sha256Hasher.h"
 
 #include "Base58.h"
 #include "ethtx/cert.h"
 #include "ethtx/const.h"
 #include "ethtx/utils2.h"
-
-secp256k1_context const* getCtx();
+#include "ethtx/ethtx.h"
 
 std::string WIFToPrivkey(const std::string& wif, bool& isCompressed) {
     std::vector<unsigned char> decoded;
@@ -56,12 +56,7 @@ std::string PrivKeyToCompressedPubKey(const std::string& rawprivkey) {
 }
 
 static std::string doubleHash(const std::string &str) {
-    uint8_t firsthash[CryptoPP::SHA256::DIGESTSIZE] = {0};
-    uint8_t secondhash[CryptoPP::SHA256::DIGESTSIZE] = {0};
-    CryptoPP::SHA256 sha256;
-    sha256.CalculateDigest(firsthash, (const uint8_t*)str.data(), str.size());
-    sha256.CalculateDigest(secondhash, firsthash, CryptoPP::SHA256::DIGESTSIZE);
-    return std::string((const char*)secondhash, CryptoPP::SHA256::DIGESTSIZE);
+    return Sha256Hasher::doubleHash(str);
 }
 
 std::string PubkeyToAddress(const std::string& rawpubkey, bool testnet) {
@@ -70,10 +65,9 @@ std::string PubkeyToAddress(const std::string& rawpubkey, bool testnet) {
     uint8_t address[ADDRESS_LENGTH] = {0};
     uint8_t* pk = (uint8_t*)rawpubkey.data();
     CHECK_TYPED(pk[0] == 0x04, TypeErrors::INCORRECT_ADDRESS_OR_PUBLIC_KEY, "incorrect pub key");
-    CryptoPP::SHA256 sha256;
-    uint8_t sha256hash[CryptoPP::SHA256::DIGESTSIZE] = {0};
+    uint8_t sha256hash[Sha256Hasher::DIGEST_SIZE] = {0};
     //Подсчитываем первый sha256-хэш.
-    sha256.CalculateDigest(sha256hash, pk, EC_PUB_KEY_LENGTH);
+    Sha256Hasher::hash(pk, EC_PUB_KEY_LENGTH, sha256hash);
     //Сетевой байт
     if (testnet) {
         address[0] = 0x6F;
@@ -83,7 +77,7 @@ std::string PubkeyToAddress(const std::string& rawpubkey, bool testnet) {
     //RIPEMD160-хэш от предыдущего
     CHECK_TYPED(ADDRESS_LENGTH >= CryptoPP::RIPEMD160::DIGESTSIZE + 1, TypeErrors::INCORRECT_ADDRESS_OR_PUBLIC_KEY, "Ups");
     CryptoPP::RIPEMD160 ripemd;
-    ripemd.CalculateDigest(&address[1], sha256hash, CryptoPP::SHA256::DIGESTSIZE);
+    ripemd.CalculateDigest(&address[1], sha256hash, Sha256Hasher::DIGEST_SIZE);
     const std::string finalhash = doubleHash(std::string((const char*)address, CryptoPP::RIPEMD160::DIGESTSIZE + 1));
     address[21] = finalhash[0];
     address[22] = finalhash[1];
@@ -99,10 +93,9 @@ std::string CompressedPubkeyToAddress(const std::string& rawpubkey, bool testnet
     uint8_t address[ADDRESS_LENGTH] = {0};
     uint8_t* pk = (uint8_t*)rawpubkey.data();
     CHECK_TYPED(pk[0] == 0x03 || pk[0] == 0x02, TypeErrors::INCORRECT_ADDRESS_OR_PUBLIC_KEY, "Incorrect pub key");
-    CryptoPP::SHA256 sha256;
-    uint8_t sha256hash[CryptoPP::SHA256::DIGESTSIZE] = {0};
+    uint8_t sha256hash[Sha256Hasher::DIGEST_SIZE] = {0};
     //Подсчитываем первый sha256-хэш.
-    sha256.CalculateDigest(sha256hash, pk, EC_KEY_LENGTH+1);
+    Sha256Hasher::hash(pk, EC_KEY_LENGTH+1, sha256hash);
     //Сетевой байт
     if (testnet) {
         address[0] = 0x6F;
@@ -112,7 +105,7 @@ std::string CompressedPubkeyToAddress(const std::string& rawpubkey, bool testnet
     //RIPEMD160-хэш от предыдущего
     CHECK(ADDRESS_LENGTH >= CryptoPP::RIPEMD160::DIGESTSIZE + 1, "Ups");
     CryptoPP::RIPEMD160 ripemd;
-    ripemd.CalculateDigest(&address[1], sha256hash, CryptoPP::SHA256::DIGESTSIZE);
+    ripemd.CalculateDigest(&address[1], sha256hash, Sha256Hasher::DIGEST_SIZE);
     //Сохраняем чек-сумму
     const std::string finalhash = doubleHash(std::string((const char*)address, CryptoPP::RIPEMD160::DIGESTSIZE + 1));
     address[21] = finalhash[0];
@@ -59,7 +59,9 @@ bool DBStorage::init()
     if (dbExist()) {
         execPragma(sqliteSettings1);
         execPragma(sqliteSettings2);
-        return updateDB();
+        const bool result = updateDB();
+        onInitialized();
+        return result;
     }
     LOG << "Create DB " << dbName();
     // Create settings
@@ -70,6 +72,7 @@ bool DBStorage::init()
     setSettings(settingsDBVersion, currentVersion());
 
     createDatabase();
+    onInitialized();
     return true;
 }
 
@@ -192,7 +195,7 @@ void DBStorage::execFromFile(const QString &filename)
     }
 }
 
-DBStorage::TransactionGuard::TransactionGuard(const DBStorage &storage)
+DBStorage::TransactionGuard::TransactionGuard(DBStorage &storage)
     : storage(storage)
 {
     CHECK(storage.database().transaction(), "Transaction not open");
@@ -205,6 +208,7 @@ DBStorage::TransactionGuard::~TransactionGuard() {
         if (!storage.database().rollback()) {
             LOG << "Error while rollback db commit";
         }
+        storage.onTransactionRollback();
     }
 }
 
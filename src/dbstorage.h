@@ -10,7 +10,7 @@ public:
     class TransactionGuard {
     public:
 
-        TransactionGuard(const DBStorage &storage);
+        TransactionGuard(DBStorage &storage);
 
         ~TransactionGuard();
 
@@ -24,7 +24,7 @@ public:
 
     private:
 
-        const DBStorage &storage;
+        DBStorage &storage;
         bool isClose = false;
         bool isCommited = false;
     };
@@ -54,6 +54,10 @@ protected:
     void openDB();
 
     virtual void createDatabase() = 0;
+    // Вызывается после отката транзакции, например чтобы сбросить закешированные идентификаторы
+    virtual void onTransactionRollback() {}
+    // Вызывается в конце init, когда база создана или обновлена до текущей версии
+    virtual void onInitialized() {}
     void createTable(const QString &table, const QString &createQuery);
     void createIndex(const QString &createQuery);
     QSqlDatabase database() const;
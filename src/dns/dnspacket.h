@@ -36,6 +36,8 @@ public:
 
     void        setFlags( DnsFlags flags );
     quint16     generateId();
+    void        setId( quint16 id );
+    quint16     id() const;
     void        addDomainName( const QString &domainName );
     QByteArray  toByteArray() const;
 
@@ -15,13 +15,12 @@
 
 #include "utils2.h"
 #include "const.h"
+#include "ethtx.h"
 
 #include "scrypt/libscrypt.h"
 
 #include "check.h"
 
-secp256k1_context const* getCtx();
-
 #ifdef _WIN32
 int libscrypt_salt_gen(uint8_t *salt, size_t len);
 #else
@@ -16,9 +16,10 @@
 
 #include "check.h"
 
+// Один контекст на процесс: создается он дольше, чем считается подпись, а через const контекст можно подписывать из разных потоков
 secp256k1_context const* getCtx()
 {
-        static thread_local std::unique_ptr<secp256k1_context, decltype(&secp256k1_context_destroy)> s_ctx{
+        static const std::unique_ptr<secp256k1_context, decltype(&secp256k1_context_destroy)> s_ctx{
                 secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY),
                 &secp256k1_context_destroy
         };
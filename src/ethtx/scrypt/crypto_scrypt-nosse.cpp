@@ -36,11 +36,20 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "sha256.h"
 #include "sysendian.h"
+#include "crypto_scrypt-sse.h"
 
 #include "libscrypt.h"
 
+/* Lanes are computed in parallel only while their V arrays fit into this limit */
+#define SCRYPT_MAX_PARALLEL_MEMORY ((uint64_t)(1) << 30)
+
 static void blkcpy(void *, void *, size_t);
 static void blkxor(void *, void *, size_t);
 static void salsa20_8(uint32_t[16]);
@@ -220,6 +229,92 @@ smix(uint8_t * B, size_t r, uint64_t N, uint32_t * V, uint32_t * XY)
 		le32enc(&B[4 * k], X[k]);
 }
 
+typedef void (*smix_t)(uint8_t *, size_t, uint64_t, uint32_t *, uint32_t *);
+
+/**
+ * select_smix():
+ * Return the SSE2 version of smix if the CPU supports it, otherwise the
+ * portable one.  Both give bit-identical results.
+ */
+static smix_t
+select_smix(void)
+{
+	static const smix_t selected =
+	    libscrypt_has_sse2() ? libscrypt_smix_sse2 : smix;
+	return (selected);
+}
+
+/* Temporary storage for one smix lane */
+struct smix_memory {
+	void * V0;
+	uint32_t * V;
+	void * XY0;
+	uint32_t * XY;
+};
+
+static int
+alloc_smix_memory(struct smix_memory * mem, size_t r, uint64_t N)
+{
+	mem->V0 = NULL;
+	mem->XY0 = NULL;
+#ifdef HAVE_POSIX_MEMALIGN
+	if ((errno = posix_memalign(&mem->XY0, 64, 256 * r + 64)) != 0) {
+		mem->XY0 = NULL;
+		return (-1);
+	}
+	mem->XY = (uint32_t *)(mem->XY0);
+#ifndef MAP_ANON
+	if ((errno = posix_memalign(&mem->V0, 64, 128 * r * N)) != 0) {
+		mem->V0 = NULL;
+		return (-1);
+	}
+	mem->V = (uint32_t *)(mem->V0);
+#endif
+#else
+	if ((mem->XY0 = malloc(256 * r + 64 + 63)) == NULL)
+		return (-1);
+	mem->XY = (uint32_t *)(((uintptr_t)(mem->XY0) + 63) & ~ (uintptr_t)(63));
+#ifndef MAP_ANON
+	if ((mem->V0 = malloc(128 * r * N + 63)) == NULL)
+		return (-1);
+	mem->V = (uint32_t *)(((uintptr_t)(mem->V0) + 63) & ~ (uintptr_t)(63));
+#endif
+#endif
+#ifdef MAP_ANON
+	if ((mem->V0 = mmap(NULL, 128 * r * N, PROT_READ | PROT_WRITE,
+#ifdef MAP_NOCORE
+	    MAP_ANON | MAP_PRIVATE | MAP_NOCORE,
+#else
+	    MAP_ANON | MAP_PRIVATE,
+#endif
+	    -1, 0)) == MAP_FAILED) {
+		mem->V0 = NULL;
+		return (-1);
+	}
+	mem->V = (uint32_t *)(mem->V0);
+#endif
+	return (0);
+}
+
+static int
+free_smix_memory(struct smix_memory * mem, size_t r, uint64_t N)
+{
+	int result = 0;
+
+	if (mem->V0 != NULL) {
+#ifdef MAP_ANON
+		if (munmap(mem->V0, 128 * r * N))
+			result = -1;
+#else
+		(void)r;
+		(void)N;
+		free(mem->V0);
+#endif
+	}
+	free(mem->XY0);
+	return (result);
+}
+
 /**
  * crypto_scrypt(passwd, passwdlen, salt, saltlen, N, r, p, buf, buflen):
  * Compute scrypt(passwd[0 .. passwdlen - 1], salt[0 .. saltlen - 1], N, r,
@@ -227,6 +322,9 @@ smix(uint8_t * B, size_t r, uint64_t N, uint32_t * V, uint32_t * XY)
  * must satisfy r * p < 2^30 and buflen <= (2^32 - 1) * 32.  The parameter N
  * must be a power of 2 greater than 1.
  *
+ * The p lanes are independent, so they are computed on several threads
+ * when the memory for their V arrays allows it.
+ *
  * Return 0 on success; or -1 on error
  */
 int
@@ -234,30 +332,30 @@ libscrypt_scrypt(const uint8_t * passwd, size_t passwdlen,
     const uint8_t * salt, size_t saltlen, uint64_t N, uint32_t r, uint32_t p,
     uint8_t * buf, size_t buflen)
 {
-	void * B0, * V0, * XY0;
+	void * B0;
 	uint8_t * B;
-	uint32_t * V;
-	uint32_t * XY;
 	uint32_t i;
+	size_t countThreads;
+	int result = 0;
 
 	/* Sanity-check parameters. */
 #if SIZE_MAX > UINT32_MAX
 	if (buflen > (((uint64_t)(1) << 32) - 1) * 32) {
 		errno = EFBIG;
-		goto err0;
+		return (-1);
 	}
 #endif
 	if ((uint64_t)(r) * (uint64_t)(p) >= (1 << 30)) {
 		errno = EFBIG;
-		goto err0;
+		return (-1);
 	}
 	if (r == 0 || p == 0) {
 		errno = EINVAL;
-		goto err0;
+		return (-1);
 	}
 	if (((N & (N - 1)) != 0) || (N < 2)) {
 		errno = EINVAL;
-		goto err0;
+		return (-1);
 	}
 	if ((r > SIZE_MAX / 128 / p) ||
 #if SIZE_MAX / 256 <= UINT32_MAX
@@ -265,77 +363,77 @@ libscrypt_scrypt(const uint8_t * passwd, size_t passwdlen,
 #endif
 	    (N > SIZE_MAX / 128 / r)) {
 		errno = ENOMEM;
-		goto err0;
+		return (-1);
 	}
 
 	/* Allocate memory. */
 #ifdef HAVE_POSIX_MEMALIGN
 	if ((errno = posix_memalign(&B0, 64, 128 * r * p)) != 0)
-		goto err0;
+		return (-1);
 	B = (uint8_t *)(B0);
-	if ((errno = posix_memalign(&XY0, 64, 256 * r + 64)) != 0)
-		goto err1;
-	XY = (uint32_t *)(XY0);
-#ifndef MAP_ANON
-	if ((errno = posix_memalign(&V0, 64, 128 * r * N)) != 0)
-		goto err2;
-	V = (uint32_t *)(V0);
-#endif
 #else
 	if ((B0 = malloc(128 * r * p + 63)) == NULL)
-		goto err0;
+		return (-1);
 	B = (uint8_t *)(((uintptr_t)(B0) + 63) & ~ (uintptr_t)(63));
-	if ((XY0 = malloc(256 * r + 64 + 63)) == NULL)
-		goto err1;
-	XY = (uint32_t *)(((uintptr_t)(XY0) + 63) & ~ (uintptr_t)(63));
-#ifndef MAP_ANON
-	if ((V0 = malloc(128 * r * N + 63)) == NULL)
-		goto err2;
-	V = (uint32_t *)(((uintptr_t)(V0) + 63) & ~ (uintptr_t)(63));
-#endif
-#endif
-#ifdef MAP_ANON
-	if ((V0 = mmap(NULL, 128 * r * N, PROT_READ | PROT_WRITE,
-#ifdef MAP_NOCORE
-	    MAP_ANON | MAP_PRIVATE | MAP_NOCORE,
-#else
-	    MAP_ANON | MAP_PRIVATE,
-#endif
-	    -1, 0)) == MAP_FAILED)
-		goto err2;
-	V = (uint32_t *)(V0);
 #endif
 
+	countThreads = std::min<uint64_t>(p, std::max(1u, std::thread::hardware_concurrency()));
+	countThreads = std::min<uint64_t>(countThreads, std::max<uint64_t>(1, SCRYPT_MAX_PARALLEL_MEMORY / (128 * r * N)));
+
+	std::vector<struct smix_memory> memory(countThreads);
+	for (i = 0; i < countThreads; i++) {
+		if (alloc_smix_memory(&memory[i], r, N) != 0) {
+			/* Not enough memory for one more lane */
+			if (i == 0) {
+				free_smix_memory(&memory[i], r, N);
+				free(B0);
+				return (-1);
+			}
+			free_smix_memory(&memory[i], r, N);
+			memory.resize(i);
+			break;
+		}
+	}
+	countThreads = memory.size();
+
+	const smix_t smix_func = select_smix();
+
 	/* 1: (B_0 ... B_{p-1}) <-- PBKDF2(P, S, 1, p * MFLen) */
 	libscrypt_PBKDF2_SHA256(passwd, passwdlen, salt, saltlen, 1, B, p * 128 * r);
 
 	/* 2: for i = 0 to p - 1 do */
-	for (i = 0; i < p; i++) {
-		/* 3: B_i <-- MF(B_i, N) */
-		smix(&B[i * 128 * r], r, N, V, XY);
+	if (countThreads == 1) {
+		for (i = 0; i < p; i++) {
+			/* 3: B_i <-- MF(B_i, N) */
+			smix_func(&B[(size_t)i * 128 * r], r, N, memory[0].V, memory[0].XY);
+		}
+	} else {
+		std::atomic<uint32_t> next(0);
+		const auto worker = [&](size_t thread) {
+			uint32_t lane;
+			while ((lane = next++) < p) {
+				/* 3: B_i <-- MF(B_i, N) */
+				smix_func(&B[(size_t)lane * 128 * r], r, N, memory[thread].V, memory[thread].XY);
+			}
+		};
+		std::vector<std::thread> threads;
+		threads.reserve(countThreads - 1);
+		for (i = 1; i < countThreads; i++)
+			threads.emplace_back(worker, i);
+		worker(0);
+		for (std::thread &thread: threads)
+			thread.join();
 	}
 
 	/* 5: DK <-- PBKDF2(P, B, 1, dkLen) */
 	libscrypt_PBKDF2_SHA256(passwd, passwdlen, B, p * 128 * r, 1, buf, buflen);
 
 	/* Free memory. */
-#ifdef MAP_ANON
-	if (munmap(V0, 128 * r * N))
-		goto err2;
-#else
-	free(V0);
-#endif
-	free(XY0);
+	for (i = 0; i < countThreads; i++) {
+		if (free_smix_memory(&memory[i], r, N) != 0)
+			result = -1;
+	}
 	free(B0);
 
-	/* Success! */
-	return (0);
-
-err2:
-	free(XY0);
-err1:
-	free(B0);
-err0:
-	/* Failure! */
-	return (-1);
+	return (result);
 }
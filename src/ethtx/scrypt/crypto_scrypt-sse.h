@@ -0,0 +1,21 @@
+#ifndef _CRYPTO_SCRYPT_SSE_H_
+#define _CRYPTO_SCRYPT_SSE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * libscrypt_has_sse2():
+ * Return non-zero if the SSE2 version of smix is compiled in and the CPU
+ * supports SSE2 (checked through CPUID).
+ */
+int libscrypt_has_sse2(void);
+
+/**
+ * libscrypt_smix_sse2(B, r, N, V, XY):
+ * SSE2 version of smix with the same contract as the portable one.  Must be
+ * called only if libscrypt_has_sse2() returned non-zero.
+ */
+void libscrypt_smix_sse2(uint8_t *, size_t, uint64_t, uint32_t *, uint32_t *);
+
+#endif /* !_CRYPTO_SCRYPT_SSE_H_ */
@@ -8,16 +8,12 @@
 
 #include "check.h"
 
+#include "HexBase64.h"
+
 std::string DumpToHexString(const uint8_t* dump, uint32_t dumpsize)
 {
     std::string res;
-    const char hex[] = "0123456789abcdef";
-    for (size_t i = 0; i < dumpsize; ++i)
-    {
-        unsigned char c = static_cast<unsigned char>(dump[i]);
-        res += hex[c >> 4];
-        res += hex[c & 0xf];
-    }
+    appendToHex((const char*)dump, dumpsize, res);
     return res;
 }
 
@@ -28,40 +24,8 @@ std::string DumpToHexString(const std::string &str)
 
 std::string HexStringToDump(const std::string& hexstr)
 {
-    std::string decoded = "";
-    unsigned char a,b,c;
-    a = b = c = 0;
-
-    for (int cnt = (int)hexstr.size()-1; cnt >= 0;)
-    {
-        a = hexstr.at(cnt);
-        --cnt;
-        b = (cnt >= 0) ? hexstr.at(cnt) : '0';
-        --cnt;
-        if (a >= '0' && a <= '9') {
-            a = a - '0';
-        } else if (a >= 'a' && a <= 'f') {
-            a = a - 'a' + 10;
-        } else if (a >= 'A' && a <= 'F') {
-            a = a - 'A' + 10;
-        } else {
-            throwErr("Incorrect hex str " + hexstr);
-        }
-
-        if (b >= '0' && b <= '9') {
-            b = b - '0';
-        } else if (b >= 'a' && b <= 'f') {
-            b = b - 'a' + 10;
-        } else if (b >= 'A' && b <= 'F') {
-            b = b - 'A' + 10;
-        } else {
-            throwErr("Incorrect hex str " + hexstr);
-        }
-
-        c = (b << 4) + a;
-        decoded.insert(decoded.begin(), c);
-    }
-
+    std::string decoded;
+    CHECK(appendFromHexStrict(hexstr.data(), hexstr.size(), decoded), "Incorrect hex str " + hexstr);
     return decoded;
 }
 
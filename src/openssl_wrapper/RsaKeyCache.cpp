@@ -0,0 +1,59 @@
+#include "RsaKeyCache.h"
+
+#include "check.h"
+
+#include "Sha256Hasher.h"
+
+RsaKeyCache::RsaKeyCache(size_t maxCount)
+    : maxCount(maxCount)
+{
+    CHECK(maxCount != 0, "Incorrect max count");
+}
+
+std::shared_ptr<const RsaKey> RsaKeyCache::getPublicKey(const PublikKey &pubkey) {
+    const std::string hash = Sha256Hasher::hash(pubkey);
+    {
+        std::lock_guard<std::mutex> lock(mut);
+        const auto found = index.find(hash);
+        if (found != index.end()) {
+            elements.splice(elements.begin(), elements, found->second);
+            countHits++;
+            return found->second->second;
+        }
+        countMisses++;
+    }
+
+    // Разбор ключа идет без блокировки, чтобы не задерживать другие потоки
+    const std::shared_ptr<const RsaKey> key = std::make_shared<const RsaKey>(getPublicRsa(pubkey));
+
+    std::lock_guard<std::mutex> lock(mut);
+    const auto found = index.find(hash);
+    if (found != index.end()) {
+        // Пока разбирали, ключ добавил другой поток
+        elements.splice(elements.begin(), elements, found->second);
+        return found->second->second;
+    }
+    if (elements.size() >= maxCount) {
+        index.erase(elements.back().first);
+        elements.pop_back();
+    }
+    elements.emplace_front(hash, key);
+    index[hash] = elements.begin();
+    return key;
+}
+
+void RsaKeyCache::clear() {
+    std::lock_guard<std::mutex> lock(mut);
+    elements.clear();
+    index.clear();
+}
+
+RsaKeyCache::Info RsaKeyCache::getInfo() const {
+    std::lock_guard<std::mutex> lock(mut);
+    Info info;
+    info.countElements = elements.size();
+    info.maxCount = maxCount;
+    info.countHits = countHits;
+    info.countMisses = countMisses;
+    return info;
+}
@@ -0,0 +1,55 @@
+#ifndef RSAKEYCACHE_H
+#define RSAKEYCACHE_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+
+#include "openssl_wrapper.h"
+
+/*
+   LRU разобранных публичных rsa ключей собеседников.
+   Ключ кэша - sha256 от строки публичного ключа, так что сама строка в кэше не хранится.
+   Класс потокобезопасен. Ключи отдаются через shared_ptr и остаются валидными после вытеснения из кэша.
+ */
+class RsaKeyCache {
+public:
+
+    struct Info {
+        size_t countElements = 0;
+        size_t maxCount = 0;
+        size_t countHits = 0;
+        size_t countMisses = 0;
+    };
+
+public:
+
+    explicit RsaKeyCache(size_t maxCount);
+
+    // Бросает исключение, если ключ не разбирается. Некорректные ключи не кэшируются
+    std::shared_ptr<const RsaKey> getPublicKey(const PublikKey &pubkey);
+
+    void clear();
+
+    Info getInfo() const;
+
+private:
+
+    using Element = std::pair<std::string, std::shared_ptr<const RsaKey>>;
+
+    const size_t maxCount;
+
+    mutable std::mutex mut;
+
+    std::list<Element> elements;
+
+    std::unordered_map<std::string, std::list<Element>::iterator> index;
+
+    size_t countHits = 0;
+
+    size_t countMisses = 0;
+};
+
+#endif // RSAKEYCACHE_H
@@ -5,7 +5,9 @@
 #include <string>
 #include <memory>
 #include <array>
+#include <mutex>
 
+#include <openssl/crypto.h>
 #include <openssl/rsa.h>
 #include <openssl/pem.h>
 #include <openssl/aes.h>
@@ -14,6 +16,7 @@
 
 #include "check.h"
 #include "utils.h"
+#include "HexBase64.h"
 
 static bool isInitialized = false;
 
@@ -27,11 +30,30 @@ static bool isInitialized = false;
     } \
 }
 
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+// OpenSSL 1.0 не синхронизирует доступ к общим структурам (например, к blinding в RSA) без этих callback-ов
+static std::unique_ptr<std::mutex[]> sslMutexes;
+
+static void sslLockingCallback(int mode, int n, const char */*file*/, int /*line*/) {
+    if (mode & CRYPTO_LOCK) {
+        sslMutexes[n].lock();
+    } else {
+        sslMutexes[n].unlock();
+    }
+}
+#endif
+
 void InitOpenSSL() {
     CHECK(!isInitialized, "Already initialized");
     /*SSL_load_error_strings();
     SSL_library_init();*/
     OpenSSL_add_all_algorithms();
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    if (CRYPTO_get_locking_callback() == nullptr) {
+        sslMutexes = std::make_unique<std::mutex[]>(CRYPTO_num_locks());
+        CRYPTO_set_locking_callback(sslLockingCallback);
+    }
+#endif
     isInitialized = true;
 }
 
@@ -209,30 +231,26 @@ static std::string decryptRsa(const RsaKey &rsa, const std::string &message) {
 }
 
 static std::string makeMessageHex(const std::string &aes, const std::vector<unsigned char> &iv, const std::vector<unsigned char> &message, const std::vector<unsigned char> &pubkeyPart) {
-    const auto writeInt = [](size_t value) {
-        std::string res;
-        const int len = sizeof(value);
-        for (int i = 0; i < len; i++) {
-            res = std::string(1, (char)(value % 256)) + res;
+    // Части кодируются в hex сразу в результат, без промежуточной бинарной строки
+    std::string result;
+    const auto writePart = [&result](const char *data, size_t size) {
+        char sizeBytes[sizeof(size)];
+        size_t value = size;
+        for (int i = sizeof(size) - 1; i >= 0; i--) {
+            sizeBytes[i] = (char)(value % 256);
             value /= 256;
         }
-        return res;
+        appendToHex(sizeBytes, sizeof(sizeBytes), result);
+        appendToHex(data, size, result);
     };
 
-    std::string result;
-    result += writeInt(aes.size());
-    result += aes;
-
-    result += writeInt(iv.size());
-    result += std::string(iv.begin(), iv.end());
+    result.reserve(2 * (4 * sizeof(size_t) + aes.size() + iv.size() + message.size() + pubkeyPart.size()));
+    writePart(aes.data(), aes.size());
+    writePart((const char*)iv.data(), iv.size());
+    writePart((const char*)message.data(), message.size());
+    writePart((const char*)pubkeyPart.data(), pubkeyPart.size());
 
-    result += writeInt(message.size());
-    result += std::string(message.begin(), message.end());
-
-    result += writeInt(pubkeyPart.size());
-    result += std::string(pubkeyPart.begin(), pubkeyPart.end());
-
-    return toHex(result);
+    return result;
 }
 
 static void parseMessageHex(const std::string &message, std::string &aes, std::vector<unsigned char> &iv, std::vector<unsigned char> &result, std::vector<unsigned char> &pubkeyPart) {
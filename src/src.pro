@@ -3,7 +3,7 @@ TEMPLATE = app
 TARGET = MetaGate
 
 DEFINES += VERSION_STRING=\\\"1.19.0\\\"
-DEFINES += VERSION_SETTINGS=\\\"10.2\\\"
+DEFINES += VERSION_SETTINGS=\\\"10.4\\\"
 #DEFINES += DEVELOPMENT
 DEFINES += PRODUCTION
 DEFINES += APPLICATION_NAME=\\\"MetaGate\\\"
@@ -14,13 +14,17 @@ QMAKE_INFO_PLIST +=  ../deploy/mac/default.plist
 
 SOURCES += main.cpp mainwindow.cpp \
     Wallet.cpp \
+    BatchTransactions.cpp \
     client.cpp \
     machine_uid_win.cpp \
     unzip.cpp \
     uploader.cpp \
     EthWallet.cpp \
     ethtx/scrypt/crypto_scrypt-nosse.cpp \
+    ethtx/scrypt/crypto_scrypt-sse.cpp \
     ethtx/scrypt/sha256.cpp \
+    Sha256Hasher.cpp \
+    HexBase64.cpp \
     ethtx/cert.cpp \
     ethtx/rlp.cpp \
     ethtx/ethtx.cpp \
@@ -29,6 +33,7 @@ SOURCES += main.cpp mainwindow.cpp \
     ethtx/crossguid/Guid.cpp \
     btctx/Base58.cpp \
     btctx/btctx.cpp \
+    btctx/CoinSelection.cpp \
     btctx/wif.cpp \
     BtcWallet.cpp \
     VersionWrapper.cpp \
@@ -36,14 +41,19 @@ SOURCES += main.cpp mainwindow.cpp \
     tests.cpp \
     Log.cpp \
     openssl_wrapper/openssl_wrapper.cpp \
+    openssl_wrapper/RsaKeyCache.cpp \
     utils.cpp \
     ethtx/utils2.cpp \
     NsLookup.cpp \
+    NodesFile.cpp \
+    NodesList.cpp \
+    DnsCache.cpp \
     dns/datatransformer.cpp \
     dns/dnspacket.cpp \
     dns/resourcerecord.cpp \
     WebSocketClient.cpp \
     JavascriptWrapper.cpp \
+    WalletsIndex.cpp \
     PagesMappings.cpp \
     mhurlschemehandler.cpp \
     Paths.cpp \
@@ -59,6 +69,8 @@ SOURCES += main.cpp mainwindow.cpp \
     WalletRsa.cpp \
     TypedException.cpp \
     Messenger/MessengerDBStorage.cpp \
+    Messenger/DecryptedMessagesCache.cpp \
+    Messenger/MessagesGapTracker.cpp \
     transactions/Transactions.cpp \
     transactions/TransactionsMessages.cpp \
     transactions/TransactionsDBStorage.cpp \
@@ -100,6 +112,7 @@ SOURCES +=  proxy/http_parser.c
 
 HEADERS += mainwindow.h \
     Wallet.h \
+    BatchTransactions.h \
     check.h \
     machine_uid.h \
     client.h \
@@ -107,6 +120,7 @@ HEADERS += mainwindow.h \
     uploader.h \
     EthWallet.h \
     ethtx/scrypt/libscrypt.h \
+    ethtx/scrypt/crypto_scrypt-sse.h \
     ethtx/scrypt/sha256.h \
     ethtx/scrypt/sysendian.h \
     ethtx/cert.h \
@@ -117,6 +131,7 @@ HEADERS += mainwindow.h \
     btctx/Base58.h \
     btctx/btctx.h \
     btctx/wif.h \
+    btctx/CoinSelection.h \
     btctx/Base58.h \
     btctx/btctx.h \
     btctx/wif.h \
@@ -128,14 +143,24 @@ HEADERS += mainwindow.h \
     Log.h \
     TypedException.h \
     openssl_wrapper/openssl_wrapper.h \
+    openssl_wrapper/RsaKeyCache.h \
     utils.h \
     ethtx/utils2.h \
     NsLookup.h \
+    NodesFile.h \
+    NodesList.h \
+    DnsCache.h \
+    JsonReader.h \
+    PerfectHash.h \
+    ParallelFor.h \
+    Sha256Hasher.h \
+    HexBase64.h \
     dns/datatransformer.h \
     dns/dnspacket.h \
     dns/resourcerecord.h \
     WebSocketClient.h \
     JavascriptWrapper.h \
+    WalletsIndex.h \
     algorithms.h \
     PagesMappings.h \
     SlotWrapper.h \
@@ -154,6 +179,8 @@ HEADERS += mainwindow.h \
     dbstorage.h \
     WalletRsa.h \
     Messenger/MessengerDBStorage.h \
+    Messenger/DecryptedMessagesCache.h \
+    Messenger/MessagesGapTracker.h \
     transactions/Transactions.h \
     transactions/TransactionsMessages.h \
     transactions/Transaction.h \
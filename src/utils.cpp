@@ -10,22 +10,26 @@
 #include <QDir>
 
 #include "btctx/Base58.h"
+#include "HexBase64.h"
 
 #include "check.h"
 
 std::string toHex(const std::string &data) {
-    QByteArray array(data.data(), data.size());
-    return QString(array.toHex()).toStdString();
+    std::string result;
+    appendToHex(data.data(), data.size(), result);
+    return result;
 }
 
 std::string toBase64(const std::string &value) {
-    QByteArray array(value.data(), value.size());
-    return QString(array.toBase64()).toStdString();
+    std::string result;
+    appendToBase64(value.data(), value.size(), result);
+    return result;
 }
 
 std::string fromBase64(const std::string &value) {
-    QByteArray pubKeyArray(value.data(), value.size());
-    return QByteArray::fromBase64(pubKeyArray).toStdString();
+    std::string result;
+    appendFromBase64(value.data(), value.size(), result);
+    return result;
 }
 
 std::string base58ToHex(const std::string &value) {
@@ -36,8 +40,9 @@ std::string base58ToHex(const std::string &value) {
 }
 
 std::string fromHex(const std::string &value) {
-    QByteArray pubKeyArray(value.data(), value.size());
-    return QByteArray::fromHex(pubKeyArray).toStdString();
+    std::string result;
+    appendFromHex(value.data(), value.size(), result);
+    return result;
 }
 
 bool isDecimal(const std::string &str) {
@@ -6,3 +6,11 @@ SUBDIRS += tst_qrcoder
 SUBDIRS += tst_messengerdbstorage
 SUBDIRS += tst_transactionsdbstorage
 SUBDIRS += tst_walletnamesdbstorage
+SUBDIRS += tst_nodesfile
+SUBDIRS += tst_messengermessages
+SUBDIRS += tst_messagesgaptracker
+SUBDIRS += tst_decryptedmessagescache
+SUBDIRS += tst_walletsindex
+SUBDIRS += tst_nodeslist
+SUBDIRS += tst_dnscache
+SUBDIRS += tst_parallelfor
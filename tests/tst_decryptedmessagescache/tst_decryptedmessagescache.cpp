@@ -0,0 +1,210 @@
+#include "tst_decryptedmessagescache.h"
+
+#include <QTest>
+
+#include <map>
+#include <algorithm>
+
+#include "Messenger/DecryptedMessagesCache.h"
+
+using namespace messenger;
+
+tst_DecryptedMessagesCache::tst_DecryptedMessagesCache(QObject *parent)
+    : QObject(parent)
+{
+}
+
+static QString makeText(qint64 id, int size) {
+    QString result = QString::number(id);
+    while (result.size() < size) {
+        result += "a";
+    }
+    return result;
+}
+
+// Размер элемента считается кэшем, поэтому берется по пустой строке и растет на QChar с каждым символом
+static size_t elementSize(int size) {
+    DecryptedMessagesCache cache(1024 * 1024);
+    cache.add(0, "");
+    return cache.getInfo().memorySize + size * sizeof(QChar);
+}
+
+static bool isCached(DecryptedMessagesCache &cache, qint64 id) {
+    QString tmp;
+    return cache.get(id, tmp);
+}
+
+void tst_DecryptedMessagesCache::testGet() {
+    DecryptedMessagesCache cache(elementSize(10) * 10);
+    QVERIFY(cache.isEnabled());
+
+    QString text;
+    QVERIFY(!cache.get(1, text));
+
+    cache.add(1, makeText(1, 10));
+    cache.add(2, makeText(2, 10));
+    QVERIFY(cache.get(1, text));
+    QCOMPARE(text, makeText(1, 10));
+    QVERIFY(cache.get(2, text));
+    QCOMPARE(text, makeText(2, 10));
+    QVERIFY(!cache.get(3, text));
+
+    const DecryptedMessagesCache::Info info = cache.getInfo();
+    QCOMPARE(info.countElements, size_t(2));
+    QCOMPARE(info.memorySize, elementSize(10) * 2);
+    QCOMPARE(info.countHits, size_t(2));
+    QCOMPARE(info.countMisses, size_t(2));
+}
+
+void tst_DecryptedMessagesCache::testEvictionOrder() {
+    DecryptedMessagesCache cache(elementSize(10) * 3);
+    cache.add(1, makeText(1, 10));
+    cache.add(2, makeText(2, 10));
+    cache.add(3, makeText(3, 10));
+    QCOMPARE(cache.getInfo().countElements, size_t(3));
+
+    // Обращение переносит элемент в начало, вытесняется самый давний
+    QVERIFY(isCached(cache, 1));
+    cache.add(4, makeText(4, 10));
+    QVERIFY(!isCached(cache, 2));
+    QVERIFY(isCached(cache, 3));
+    QVERIFY(isCached(cache, 1));
+    QVERIFY(isCached(cache, 4));
+
+    // Порядок теперь 4, 1, 3
+    cache.add(5, makeText(5, 10));
+    QVERIFY(!isCached(cache, 3));
+    QVERIFY(isCached(cache, 1));
+
+    // Новый элемент на два места вытесняет два самых давних
+    cache.add(6, makeText(6, 10 + int(elementSize(10) / sizeof(QChar))));
+    QVERIFY(!isCached(cache, 4));
+    QVERIFY(!isCached(cache, 5));
+    QVERIFY(isCached(cache, 1));
+    QVERIFY(isCached(cache, 6));
+    QCOMPARE(cache.getInfo().countElements, size_t(2));
+    QCOMPARE(cache.getInfo().memorySize, elementSize(10) * 3);
+}
+
+void tst_DecryptedMessagesCache::testUpdate() {
+    DecryptedMessagesCache cache(elementSize(10) * 3);
+    cache.add(1, makeText(1, 10));
+    cache.add(2, makeText(2, 10));
+
+    cache.add(1, makeText(1, 5));
+    QCOMPARE(cache.getInfo().countElements, size_t(2));
+    QCOMPARE(cache.getInfo().memorySize, elementSize(10) + elementSize(5));
+    QString text;
+    QVERIFY(cache.get(1, text));
+    QCOMPARE(text, makeText(1, 5));
+
+    // Обновление переносит элемент в начало
+    cache.add(2, makeText(2, 10));
+    cache.add(3, makeText(3, 10));
+    cache.add(4, makeText(4, 10));
+    QVERIFY(!isCached(cache, 1));
+    QVERIFY(isCached(cache, 2));
+
+    // Увеличение элемента вытесняет другие, но не его самого
+    cache.add(2, makeText(2, 10 + int(elementSize(10) * 2 / sizeof(QChar))));
+    QCOMPARE(cache.getInfo().countElements, size_t(1));
+    QCOMPARE(cache.getInfo().memorySize, elementSize(10) * 3);
+    QVERIFY(isCached(cache, 2));
+}
+
+void tst_DecryptedMessagesCache::testTooLarge() {
+    DecryptedMessagesCache cache(elementSize(10) * 2);
+    cache.add(1, makeText(1, 10));
+
+    cache.add(2, makeText(2, 10 + int(elementSize(10) * 2 / sizeof(QChar))));
+    QVERIFY(!isCached(cache, 2));
+    QVERIFY(isCached(cache, 1));
+    QCOMPARE(cache.getInfo().memorySize, elementSize(10));
+
+    // Не поместившееся новое значение не должно оставлять в кэше старое
+    cache.add(1, makeText(1, 10 + int(elementSize(10) * 2 / sizeof(QChar))));
+    QVERIFY(!isCached(cache, 1));
+    QCOMPARE(cache.getInfo().countElements, size_t(0));
+    QCOMPARE(cache.getInfo().memorySize, size_t(0));
+}
+
+void tst_DecryptedMessagesCache::testDisabled() {
+    DecryptedMessagesCache cache(0);
+    QVERIFY(!cache.isEnabled());
+    cache.add(1, "");
+    QVERIFY(!isCached(cache, 1));
+    QCOMPARE(cache.getInfo().memorySize, size_t(0));
+}
+
+void tst_DecryptedMessagesCache::testClear() {
+    DecryptedMessagesCache cache(elementSize(10) * 3);
+    cache.add(1, makeText(1, 10));
+    cache.add(2, makeText(2, 10));
+    cache.clear();
+    QVERIFY(!isCached(cache, 1));
+    QVERIFY(!isCached(cache, 2));
+    QCOMPARE(cache.getInfo().countElements, size_t(0));
+    QCOMPARE(cache.getInfo().memorySize, size_t(0));
+
+    cache.add(3, makeText(3, 10));
+    QCOMPARE(cache.getInfo().memorySize, elementSize(10));
+}
+
+void tst_DecryptedMessagesCache::testMemoryLimit() {
+    const size_t maxMemorySize = elementSize(100) * 8;
+    DecryptedMessagesCache cache(maxMemorySize);
+
+    // Повторяет вытеснение на простой модели и сверяет объем после каждой операции
+    std::map<qint64, int> sizes;
+    std::vector<qint64> order;
+    quint32 random = 1;
+    for (int i = 0; i < 2000; i++) {
+        random = random * 1103515245 + 12345;
+        const qint64 id = (random >> 16) % 30;
+        random = random * 1103515245 + 12345;
+        const int size = (random >> 16) % 300;
+
+        if (i % 3 == 0) {
+            QString text;
+            const bool isFound = cache.get(id, text);
+            QCOMPARE(isFound, sizes.find(id) != sizes.end());
+            if (isFound) {
+                QCOMPARE(text, makeText(id, sizes[id]));
+                order.erase(std::find(order.begin(), order.end(), id));
+                order.insert(order.begin(), id);
+            }
+            continue;
+        }
+
+        cache.add(id, makeText(id, size));
+        const int textSize = makeText(id, size).size();
+        if (sizes.find(id) != sizes.end()) {
+            sizes.erase(id);
+            order.erase(std::find(order.begin(), order.end(), id));
+        }
+        if (elementSize(textSize) <= maxMemorySize) {
+            size_t memorySize = elementSize(textSize);
+            for (const auto &element: sizes) {
+                memorySize += elementSize(element.second);
+            }
+            while (memorySize > maxMemorySize) {
+                memorySize -= elementSize(sizes[order.back()]);
+                sizes.erase(order.back());
+                order.pop_back();
+            }
+            sizes[id] = textSize;
+            order.insert(order.begin(), id);
+        }
+
+        size_t memorySize = 0;
+        for (const auto &element: sizes) {
+            memorySize += elementSize(element.second);
+        }
+        const DecryptedMessagesCache::Info info = cache.getInfo();
+        QVERIFY(info.memorySize <= maxMemorySize);
+        QCOMPARE(info.memorySize, memorySize);
+        QCOMPARE(info.countElements, sizes.size());
+    }
+}
+
+QTEST_MAIN(tst_DecryptedMessagesCache)
@@ -0,0 +1,30 @@
+#ifndef TST_DECRYPTEDMESSAGESCACHE_H
+#define TST_DECRYPTEDMESSAGESCACHE_H
+
+#include <QObject>
+
+class tst_DecryptedMessagesCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_DecryptedMessagesCache(QObject *parent = nullptr);
+
+private slots:
+
+    void testGet();
+
+    void testEvictionOrder();
+
+    void testUpdate();
+
+    void testTooLarge();
+
+    void testDisabled();
+
+    void testClear();
+
+    void testMemoryLimit();
+
+};
+
+#endif // TST_DECRYPTEDMESSAGESCACHE_H
@@ -0,0 +1,25 @@
+QT      += testlib
+QT      -= gui
+QT      += widgets
+TARGET = tst_decryptedmessagescache
+CONFIG   += testcase
+CONFIG += c++14
+CONFIG += static
+
+TEMPLATE = app
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    tst_decryptedmessagescache.cpp \
+    ../../src/Messenger/DecryptedMessagesCache.cpp
+
+
+HEADERS += \
+    tst_decryptedmessagescache.h \
+    ../../src/Messenger/DecryptedMessagesCache.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
@@ -0,0 +1,155 @@
+#include "tst_dnscache.h"
+
+#include <QTest>
+#include <QFile>
+#include <QDir>
+
+#include <limits>
+
+#include "check.h"
+#include "utils.h"
+
+#include "DnsCache.h"
+
+using namespace dns_cache;
+
+const static QString cacheFileName = "dns_cache_test.json";
+
+const static system_time_point NOW = intToSystemTimePoint(1546300800000);
+
+tst_DnsCache::tst_DnsCache(QObject *parent)
+    : QObject(parent)
+{
+}
+
+static Record makeRecord(const std::vector<QString> &ips, const system_time_point &expire) {
+    Record record;
+    record.ips = ips;
+    record.expire = expire;
+    return record;
+}
+
+static Cache makeCache() {
+    Cache cache;
+    cache["net-main.metahash.org"] = makeRecord({"10.0.0.1", "10.0.0.2"}, NOW + 1min);
+    cache["proxy.net-main.metahash.org"] = makeRecord({"10.0.1.1"}, NOW - 1min);
+    cache["tor.net-main.metahash.org"] = makeRecord({}, NOW + 1h);
+    return cache;
+}
+
+static void compareCache(const Cache &first, const Cache &second) {
+    QCOMPARE(first.size(), second.size());
+    for (auto iter1 = first.begin(), iter2 = second.begin(); iter1 != first.end(); iter1++, iter2++) {
+        QCOMPARE(iter1->first, iter2->first);
+        QCOMPARE(iter1->second.ips, iter2->second.ips);
+        QCOMPARE(systemTimePointToInt(iter1->second.expire), systemTimePointToInt(iter2->second.expire));
+    }
+}
+
+void tst_DnsCache::testReadWrite() {
+    QFile::remove(cacheFileName);
+    const Cache cache = makeCache();
+    writeFile(cacheFileName, cache);
+    compareCache(readFile(cacheFileName), cache);
+
+    writeFile(cacheFileName, Cache());
+    QVERIFY(readFile(cacheFileName).empty());
+}
+
+void tst_DnsCache::testReadMissingFile() {
+    QFile::remove(cacheFileName);
+    QVERIFY(readFile(cacheFileName).empty());
+}
+
+void tst_DnsCache::testReadIncorrectFile() {
+    writeToFile(cacheFileName, "[{\"name\":\"net-main.metahash.org\",\"ips\":[\"10.0", false);
+    QVERIFY(readFile(cacheFileName).empty());
+
+    writeToFile(cacheFileName, "{\"name\":\"net-main.metahash.org\"}", false);
+    QVERIFY(readFile(cacheFileName).empty());
+}
+
+void tst_DnsCache::testReadSkipsIncorrectRecords() {
+    writeToFile(cacheFileName,
+        "["
+        "{\"name\":\"a\",\"ips\":[\"10.0.0.1\"],\"expire\":\"1546300800000\"},"
+        "{\"name\":\"b\",\"ips\":[\"10.0.0.2\"],\"expire\":1546300800000},"
+        "{\"name\":\"c\",\"ips\":\"10.0.0.3\",\"expire\":\"1546300800000\"},"
+        "{\"ips\":[\"10.0.0.4\"],\"expire\":\"1546300800000\"},"
+        "{\"name\":\"d\",\"ips\":[\"10.0.0.5\"],\"expire\":\"soon\"},"
+        "{\"name\":\"e\",\"ips\":[\"10.0.0.6\",5],\"expire\":\"1546300800000\"},"
+        "5"
+        "]", false);
+
+    Cache expected;
+    expected["a"] = makeRecord({"10.0.0.1"}, NOW);
+    expected["e"] = makeRecord({"10.0.0.6"}, NOW);
+    compareCache(readFile(cacheFileName), expected);
+}
+
+void tst_DnsCache::testRewrite() {
+    writeFile(cacheFileName, makeCache());
+
+    Cache cache;
+    cache["net-main.metahash.org"] = makeRecord({"10.0.0.3"}, NOW + 2min);
+    writeFile(cacheFileName, cache);
+    compareCache(readFile(cacheFileName), cache);
+
+    // Временные файлы после записи не остаются
+    const QStringList files = QDir(".").entryList({cacheFileName + "*"}, QDir::Files | QDir::Hidden);
+    QCOMPARE(files, QStringList({cacheFileName}));
+}
+
+void tst_DnsCache::testCalcExpire_data() {
+    QTest::addColumn<size_t>("ttl");
+    QTest::addColumn<size_t>("expectedSeconds");
+
+    QTest::newRow("zero") << size_t(0) << size_t(60);
+    QTest::newRow("less min") << size_t(5) << size_t(60);
+    QTest::newRow("normal") << size_t(300) << size_t(300);
+    QTest::newRow("max") << size_t(86400) << size_t(86400);
+    QTest::newRow("more max") << size_t(std::numeric_limits<quint32>::max()) << size_t(86400);
+}
+
+void tst_DnsCache::testCalcExpire() {
+    QFETCH(size_t, ttl);
+    QFETCH(size_t, expectedSeconds);
+
+    const system_time_point expire = calcExpire(ttl, NOW);
+    QCOMPARE(size_t(std::chrono::duration_cast<seconds>(expire - NOW).count()), expectedSeconds);
+}
+
+void tst_DnsCache::testSplitNames() {
+    const Cache cache = makeCache();
+
+    std::set<QString> missing;
+    std::set<QString> stale;
+    splitNames(cache, {"net-main.metahash.org", "proxy.net-main.metahash.org", "tor.net-main.metahash.org", "unknown.metahash.org"}, NOW, missing, stale);
+    QCOMPARE(missing, std::set<QString>({"tor.net-main.metahash.org", "unknown.metahash.org"}));
+    QCOMPARE(stale, std::set<QString>({"proxy.net-main.metahash.org"}));
+
+    // Запись истекает ровно в момент expire
+    missing.clear();
+    stale.clear();
+    splitNames(cache, {"net-main.metahash.org"}, NOW + 1min, missing, stale);
+    QVERIFY(missing.empty());
+    QCOMPARE(stale, std::set<QString>({"net-main.metahash.org"}));
+
+    missing.clear();
+    stale.clear();
+    splitNames(cache, {"net-main.metahash.org"}, NOW + 1min - 1ms, missing, stale);
+    QVERIFY(missing.empty());
+    QVERIFY(stale.empty());
+}
+
+void tst_DnsCache::testNearestExpire() {
+    const Cache cache = makeCache();
+
+    QCOMPARE(systemTimePointToInt(nearestExpire(cache, {"net-main.metahash.org", "proxy.net-main.metahash.org"})), systemTimePointToInt(NOW - 1min));
+    QCOMPARE(systemTimePointToInt(nearestExpire(cache, {"net-main.metahash.org", "tor.net-main.metahash.org"})), systemTimePointToInt(NOW + 1min));
+    // Записи без адресов не учитываются
+    QVERIFY(nearestExpire(cache, {"tor.net-main.metahash.org", "unknown.metahash.org"}) == system_time_point::max());
+    QVERIFY(nearestExpire(cache, {}) == system_time_point::max());
+}
+
+QTEST_MAIN(tst_DnsCache)
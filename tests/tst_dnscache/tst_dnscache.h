@@ -0,0 +1,34 @@
+#ifndef TST_DNSCACHE_H
+#define TST_DNSCACHE_H
+
+#include <QObject>
+
+class tst_DnsCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_DnsCache(QObject *parent = nullptr);
+
+private slots:
+
+    void testReadWrite();
+
+    void testReadMissingFile();
+
+    void testReadIncorrectFile();
+
+    void testReadSkipsIncorrectRecords();
+
+    void testRewrite();
+
+    void testCalcExpire_data();
+
+    void testCalcExpire();
+
+    void testSplitNames();
+
+    void testNearestExpire();
+
+};
+
+#endif // TST_DNSCACHE_H
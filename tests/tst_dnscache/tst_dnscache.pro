@@ -0,0 +1,30 @@
+QT      += testlib
+QT      -= gui
+QT      += widgets
+TARGET = tst_dnscache
+CONFIG   += testcase
+CONFIG += c++14
+CONFIG += static
+
+TEMPLATE = app
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    tst_dnscache.cpp \
+    ../../src/Log.cpp \
+    ../../src/utils.cpp \
+    ../../src/Paths.cpp \
+    ../../src/btctx/Base58.cpp \
+    ../../src/HexBase64.cpp \
+    ../../src/DnsCache.cpp
+
+
+HEADERS += \
+    tst_dnscache.h \
+    ../../src/DnsCache.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
@@ -0,0 +1,236 @@
+#include "tst_messagesgaptracker.h"
+
+#include <QTest>
+#include <QStringList>
+
+#include "check.h"
+
+#include "Messenger/MessagesGapTracker.h"
+
+using namespace messenger;
+
+using Key = MessagesGapTracker::Key;
+
+using Ranges = std::vector<std::pair<Message::Counter, Message::Counter>>;
+
+Q_DECLARE_METATYPE(Ranges)
+
+const static Key KEY("0x00a1b2c3", "");
+
+tst_MessagesGapTracker::tst_MessagesGapTracker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+// Диапазоны в виде строки "1-3,5-5", чтобы при ошибке было видно все значение
+static QString rangesToString(const Ranges &ranges) {
+    QStringList result;
+    for (const auto &range: ranges) {
+        result << QString::number(range.first) + "-" + QString::number(range.second);
+    }
+    return result.join(",");
+}
+
+static QString notRequested(const MessagesGapTracker &tracker, const Key &key) {
+    Ranges ranges;
+    for (const MessagesGapTracker::Range &range: tracker.getNotRequested(key)) {
+        ranges.emplace_back(range.from, range.to);
+    }
+    return rangesToString(ranges);
+}
+
+void tst_MessagesGapTracker::testAddGap_data() {
+    QTest::addColumn<Ranges>("gaps");
+    QTest::addColumn<QString>("answer");
+
+    QTest::newRow("one") << Ranges{{1, 3}} << QString("1-3");
+    QTest::newRow("one counter") << Ranges{{5, 5}} << QString("5-5");
+    QTest::newRow("incorrect range ignored") << Ranges{{5, 4}} << QString("");
+    QTest::newRow("adjacent after") << Ranges{{1, 3}, {4, 6}} << QString("1-6");
+    QTest::newRow("adjacent before") << Ranges{{4, 6}, {1, 3}} << QString("1-6");
+    QTest::newRow("not adjacent") << Ranges{{1, 3}, {5, 6}} << QString("1-3,5-6");
+    QTest::newRow("fill hole") << Ranges{{1, 3}, {5, 6}, {4, 4}} << QString("1-6");
+    QTest::newRow("overlapping after") << Ranges{{1, 5}, {3, 8}} << QString("1-8");
+    QTest::newRow("overlapping before") << Ranges{{3, 8}, {1, 5}} << QString("1-8");
+    QTest::newRow("same begin") << Ranges{{3, 8}, {3, 5}} << QString("3-8");
+    QTest::newRow("same end") << Ranges{{3, 8}, {5, 8}} << QString("3-8");
+    QTest::newRow("nested") << Ranges{{1, 10}, {3, 4}} << QString("1-10");
+    QTest::newRow("nesting") << Ranges{{3, 4}, {1, 10}} << QString("1-10");
+    QTest::newRow("duplicate") << Ranges{{3, 4}, {3, 4}} << QString("3-4");
+    QTest::newRow("covering several") << Ranges{{1, 2}, {5, 6}, {9, 10}, {14, 15}, {0, 12}} << QString("0-12,14-15");
+    QTest::newRow("bridge") << Ranges{{1, 2}, {6, 7}, {3, 5}} << QString("1-7");
+    QTest::newRow("end adjacent to next") << Ranges{{1, 2}, {10, 12}, {5, 9}} << QString("1-2,5-12");
+}
+
+void tst_MessagesGapTracker::testAddGap() {
+    QFETCH(Ranges, gaps);
+    QFETCH(QString, answer);
+
+    MessagesGapTracker tracker;
+    for (const auto &gap: gaps) {
+        tracker.addGap(KEY, gap.first, gap.second);
+    }
+    QCOMPARE(notRequested(tracker, KEY), answer);
+    QCOMPARE(tracker.isGap(KEY), !answer.isEmpty());
+}
+
+void tst_MessagesGapTracker::testRemoveCounter_data() {
+    QTest::addColumn<Ranges>("gaps");
+    QTest::addColumn<QList<Message::Counter>>("counters");
+    QTest::addColumn<QString>("answer");
+
+    QTest::newRow("middle") << Ranges{{1, 5}} << QList<Message::Counter>{3} << QString("1-2,4-5");
+    QTest::newRow("begin") << Ranges{{1, 5}} << QList<Message::Counter>{1} << QString("2-5");
+    QTest::newRow("end") << Ranges{{1, 5}} << QList<Message::Counter>{5} << QString("1-4");
+    QTest::newRow("outside") << Ranges{{1, 5}} << QList<Message::Counter>{0, 6} << QString("1-5");
+    QTest::newRow("between") << Ranges{{1, 2}, {4, 5}} << QList<Message::Counter>{3} << QString("1-2,4-5");
+    QTest::newRow("one counter") << Ranges{{3, 3}} << QList<Message::Counter>{3} << QString("");
+    QTest::newRow("all") << Ranges{{1, 3}} << QList<Message::Counter>{2, 1, 3} << QString("");
+    QTest::newRow("repeated") << Ranges{{1, 3}} << QList<Message::Counter>{2, 2} << QString("1-1,3-3");
+    QTest::newRow("without gaps") << Ranges{} << QList<Message::Counter>{2} << QString("");
+}
+
+void tst_MessagesGapTracker::testRemoveCounter() {
+    QFETCH(Ranges, gaps);
+    QFETCH(QList<Message::Counter>, counters);
+    QFETCH(QString, answer);
+
+    MessagesGapTracker tracker;
+    for (const auto &gap: gaps) {
+        tracker.addGap(KEY, gap.first, gap.second);
+    }
+    for (const Message::Counter counter: counters) {
+        tracker.removeCounter(KEY, counter);
+    }
+    QCOMPARE(notRequested(tracker, KEY), answer);
+    QCOMPARE(tracker.isGap(KEY), !answer.isEmpty());
+}
+
+void tst_MessagesGapTracker::testRequests() {
+    const time_point time = ::now();
+
+    MessagesGapTracker tracker;
+    tracker.addGap(KEY, 1, 10);
+
+    tracker.addRequest(1, KEY, MessagesGapTracker::Range{3, 5}, time);
+    QVERIFY(tracker.isRequest(1));
+    QVERIFY(!tracker.isRequest(2));
+    QCOMPARE(notRequested(tracker, KEY), QString("1-2,6-10"));
+
+    // Запрошенный диапазон не отдается повторно, пока запрос не завершен
+    tracker.addGap(KEY, 4, 4);
+    QCOMPARE(notRequested(tracker, KEY), QString("1-2,6-10"));
+
+    tracker.addRequest(2, KEY, MessagesGapTracker::Range{1, 2}, time);
+    QCOMPARE(notRequested(tracker, KEY), QString("6-10"));
+
+    QVERIFY(tracker.finishRequest(1) == KEY);
+    QVERIFY(!tracker.isRequest(1));
+    QCOMPARE(notRequested(tracker, KEY), QString("6-10"));
+    QVERIFY(tracker.isGap(KEY));
+
+    QVERIFY_EXCEPTION_THROWN(tracker.finishRequest(1), Exception);
+
+    QVERIFY(tracker.finishRequest(2) == KEY);
+    tracker.addRequest(3, KEY, MessagesGapTracker::Range{6, 10}, time);
+    QCOMPARE(notRequested(tracker, KEY), QString(""));
+    QVERIFY(tracker.isGap(KEY));
+
+    tracker.finishRequest(3);
+    QVERIFY(!tracker.isGap(KEY));
+    QCOMPARE(notRequested(tracker, KEY), QString(""));
+}
+
+void tst_MessagesGapTracker::testRequestAfterFinish() {
+    const time_point time = ::now();
+
+    MessagesGapTracker tracker;
+    tracker.addGap(KEY, 1, 10);
+    tracker.addRequest(1, KEY, MessagesGapTracker::Range{1, 10}, time);
+    tracker.finishRequest(1);
+    QVERIFY(!tracker.isGap(KEY));
+
+    // Сервер не прислал часть сообщений, дыра снова находится и должна запрашиваться заново
+    tracker.addGap(KEY, 4, 6);
+    QCOMPARE(notRequested(tracker, KEY), QString("4-6"));
+
+    tracker.addRequest(2, KEY, MessagesGapTracker::Range{4, 6}, time);
+    QCOMPARE(notRequested(tracker, KEY), QString(""));
+
+    // Сообщение пришло до ответа на запрос
+    tracker.removeCounter(KEY, 5);
+    tracker.finishRequest(2);
+    QVERIFY(!tracker.isGap(KEY));
+
+    tracker.addGap(KEY, 5, 5);
+    QCOMPARE(notRequested(tracker, KEY), QString("5-5"));
+}
+
+void tst_MessagesGapTracker::testOverlappedRequests() {
+    const time_point time = ::now();
+
+    MessagesGapTracker tracker;
+    tracker.addGap(KEY, 1, 10);
+    tracker.addRequest(1, KEY, MessagesGapTracker::Range{1, 5}, time);
+    tracker.addRequest(2, KEY, MessagesGapTracker::Range{4, 8}, time);
+    QCOMPARE(notRequested(tracker, KEY), QString("9-10"));
+
+    // Завершенный запрос закрывает весь свой диапазон, в том числе общую часть со вторым запросом
+    tracker.finishRequest(1);
+    QCOMPARE(notRequested(tracker, KEY), QString("9-10"));
+
+    tracker.finishRequest(2);
+    QCOMPARE(notRequested(tracker, KEY), QString("9-10"));
+
+    tracker.addGap(KEY, 3, 3);
+    QCOMPARE(notRequested(tracker, KEY), QString("3-3,9-10"));
+}
+
+void tst_MessagesGapTracker::testExpiredRequests() {
+    const time_point time = ::now();
+    const Key key2("0x00a1b2c3", "channel");
+
+    MessagesGapTracker tracker;
+    tracker.addGap(KEY, 1, 10);
+    tracker.addGap(key2, 1, 10);
+    tracker.addRequest(1, KEY, MessagesGapTracker::Range{1, 2}, time);
+    tracker.addRequest(2, KEY, MessagesGapTracker::Range{3, 4}, time + milliseconds(100));
+    tracker.addRequest(3, key2, MessagesGapTracker::Range{1, 10}, time + milliseconds(200));
+
+    QVERIFY(tracker.finishExpiredRequests(time + milliseconds(99), milliseconds(100)).empty());
+
+    const std::vector<Key> expired = tracker.finishExpiredRequests(time + milliseconds(200), milliseconds(100));
+    QCOMPARE(expired.size(), size_t(1));
+    QVERIFY(expired[0] == KEY);
+    QVERIFY(!tracker.isRequest(1));
+    QVERIFY(!tracker.isRequest(2));
+    QVERIFY(tracker.isRequest(3));
+    QCOMPARE(notRequested(tracker, KEY), QString("5-10"));
+
+    const std::vector<Key> expired2 = tracker.finishExpiredRequests(time + milliseconds(300), milliseconds(100));
+    QCOMPARE(expired2.size(), size_t(1));
+    QVERIFY(expired2[0] == key2);
+    QVERIFY(!tracker.isGap(key2));
+}
+
+void tst_MessagesGapTracker::testKeys() {
+    const Key key2("0x00a1b2c3", "channel");
+    const Key key3("0x00d4e5f6", "");
+
+    MessagesGapTracker tracker;
+    tracker.addGap(KEY, 1, 3);
+    tracker.addGap(key2, 5, 6);
+    tracker.removeCounter(key3, 1);
+
+    QCOMPARE(notRequested(tracker, KEY), QString("1-3"));
+    QCOMPARE(notRequested(tracker, key2), QString("5-6"));
+    QCOMPARE(notRequested(tracker, key3), QString(""));
+    QVERIFY(!tracker.isGap(key3));
+
+    tracker.addRequest(1, KEY, MessagesGapTracker::Range{1, 3}, ::now());
+    tracker.finishRequest(1);
+    QVERIFY(!tracker.isGap(KEY));
+    QCOMPARE(notRequested(tracker, key2), QString("5-6"));
+}
+
+QTEST_MAIN(tst_MessagesGapTracker)
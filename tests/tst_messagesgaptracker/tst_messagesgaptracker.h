@@ -0,0 +1,32 @@
+#ifndef TST_MESSAGESGAPTRACKER_H
+#define TST_MESSAGESGAPTRACKER_H
+
+#include <QObject>
+
+class tst_MessagesGapTracker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_MessagesGapTracker(QObject *parent = nullptr);
+
+private slots:
+
+    void testAddGap_data();
+    void testAddGap();
+
+    void testRemoveCounter_data();
+    void testRemoveCounter();
+
+    void testRequests();
+
+    void testRequestAfterFinish();
+
+    void testOverlappedRequests();
+
+    void testExpiredRequests();
+
+    void testKeys();
+
+};
+
+#endif // TST_MESSAGESGAPTRACKER_H
@@ -0,0 +1,25 @@
+QT      += testlib
+QT      -= gui
+QT      += widgets
+TARGET = tst_messagesgaptracker
+CONFIG   += testcase
+CONFIG += c++14
+CONFIG += static
+
+TEMPLATE = app
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    tst_messagesgaptracker.cpp \
+    ../../src/Messenger/MessagesGapTracker.cpp
+
+
+HEADERS += \
+    tst_messagesgaptracker.h \
+    ../../src/Messenger/MessagesGapTracker.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
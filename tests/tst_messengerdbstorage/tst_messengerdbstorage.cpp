@@ -1,12 +1,14 @@
 #include "tst_messengerdbstorage.h"
 
 #include <QTest>
+#include <QtSql>
 
 #include <iostream>
 
 #include "check.h"
 
 #include "MessengerDBStorage.h"
+#include "MessengerDBRes.h"
 
 const QString dbName = "messenger.db";
 
@@ -218,6 +220,137 @@ void tst_MessengerDBStorage::testMessengerDBSpeed()
     qDebug() << db.getMessageMaxCounter("1234");
 }
 
+static std::vector<messenger::Message> makeMessages(const QString &user, const QString &collocutor, const QString &channel, messenger::Message::Counter from, int count) {
+    std::vector<messenger::Message> messages;
+    for (int n = 0; n < count; n++) {
+        messenger::Message message;
+        message.username = user;
+        message.collocutor = collocutor;
+        message.channel = channel;
+        message.isChannel = !channel.isEmpty();
+        message.isInput = true;
+        message.timestamp = 1000000 + from + n;
+        message.dataHex = "abcd";
+        message.hash = "asdfdf";
+        message.counter = from + n;
+        message.fee = 1;
+        messages.emplace_back(message);
+    }
+    return messages;
+}
+
+void tst_MessengerDBStorage::testMessengerDBAddMessages()
+{
+    if (QFile::exists(dbName))
+        QFile::remove(dbName);
+    messenger::MessengerDBStorage db;
+    db.init();
+    db.setUserPublicKey("1234", "23424", "2345342", "", "");
+    DBStorage::DbId id1 = db.getUserId("1234");
+    db.addChannel(id1, "channel", "ch1", true, "ktkt", false, true, true);
+
+    std::vector<messenger::Message> messages = makeMessages("1234", "3454", "", 1, 10);
+    const std::vector<messenger::Message> messages2 = makeMessages("1234", "3457", "", 11, 5);
+    const std::vector<messenger::Message> messages3 = makeMessages("1234", "", "ch1", 1, 7);
+    messages.insert(messages.end(), messages2.begin(), messages2.end());
+    messages.insert(messages.end(), messages3.begin(), messages3.end());
+    db.addMessages(messages);
+    db.addMessages({});
+
+    QCOMPARE(db.getMessagesCountForUserAndDest("1234", "3454", 0), 10);
+    QCOMPARE(db.getMessagesCountForUserAndDest("1234", "3457", 0), 5);
+    QCOMPARE(db.getMessageMaxCounter("1234"), 15);
+    QCOMPARE(db.getMessageMaxCounter("1234", "ch1"), 7);
+    QCOMPARE(db.getLastReadCountersForContacts("1234").size(), 2);
+    QCOMPARE(db.getLastReadCounterForUserContact("1234", "3454"), -1);
+    QCOMPARE(db.getLastReadCounterForUserContact("1234", "ch1", true), -1);
+
+    // Повторная вставка не дублирует ни сообщения, ни счетчики прочитанного
+    db.setLastReadCounterForUserContact("1234", "3454", 5);
+    db.addMessages(messages);
+    QCOMPARE(db.getMessagesCountForUserAndDest("1234", "3454", 0), 10);
+    QCOMPARE(db.getLastReadCountersForContacts("1234").size(), 2);
+    QCOMPARE(db.getLastReadCounterForUserContact("1234", "3454"), 5);
+
+    bool isError = false;
+    try {
+        db.addMessages(makeMessages("1234", "", "unknownChannel", 100, 3));
+    } catch (...) {
+        isError = true;
+    }
+    QVERIFY(isError);
+    QCOMPARE(db.getMessageMaxCounter("1234", "unknownChannel"), -1);
+}
+
+void tst_MessengerDBStorage::testMessengerDBIdCache()
+{
+    if (QFile::exists(dbName))
+        QFile::remove(dbName);
+    messenger::MessengerDBStorage db;
+    db.init();
+    db.setUserPublicKey("1234", "23424", "2345342", "", "");
+    const DBStorage::DbId id1 = db.getUserId("1234");
+    QCOMPARE(db.getUserIdOrCreate("1234"), id1);
+
+    QCOMPARE(db.getContactId("3454"), DBStorage::not_found);
+    const DBStorage::DbId contactId = db.getContactIdOrCreate("3454");
+    QCOMPARE(db.getContactId("3454"), contactId);
+
+    {
+        auto transactionGuard = db.beginTransaction();
+        QVERIFY(db.getContactIdOrCreate("3457") != DBStorage::not_found);
+    }
+    QCOMPARE(db.getContactId("3457"), DBStorage::not_found);
+    QCOMPARE(db.getContactId("3454"), contactId);
+
+    QCOMPARE(db.getChannelForUserShaName("1234", "ch1"), DBStorage::not_found);
+    db.addChannel(id1, "channel", "ch1", true, "ktkt", false, true, true);
+    QVERIFY(db.getChannelForUserShaName("1234", "ch1") != DBStorage::not_found);
+
+    QCOMPARE(db.getMessageMaxCounter("unknownUser"), -1);
+    QCOMPARE(db.getMessagesCountForUserAndDest("1234", "unknownContact", 0), 0);
+    QCOMPARE(db.getMessagesForUserAndDestNum("1234", "unknownChannel", 100, 10, true).size(), 0);
+}
+
+void tst_MessengerDBStorage::testMessengerDBAddMessagesSpeed_data()
+{
+    QTest::addColumn<bool>("isBatch");
+
+    QTest::newRow("per message") << false;
+    QTest::newRow("batch") << true;
+}
+
+void tst_MessengerDBStorage::testMessengerDBAddMessagesSpeed()
+{
+    QFETCH(bool, isBatch);
+
+    if (QFile::exists(dbName))
+        QFile::remove(dbName);
+    messenger::MessengerDBStorage db;
+    db.init();
+    db.setUserPublicKey("1234", "23424", "2345342", "", "");
+
+    const int countMessages = 1000;
+    messenger::Message::Counter from = 1;
+    QBENCHMARK {
+        const std::vector<messenger::Message> messages = makeMessages("1234", "3454", "", from, countMessages);
+        if (isBatch) {
+            db.addMessages(messages);
+        } else {
+            // Так сообщения добавлялись до появления пакетной вставки
+            for (const messenger::Message &m: messages) {
+                db.addMessage(m);
+                const messenger::Message::Counter savedPos = db.getLastReadCounterForUserContact(m.username, m.collocutor, false);
+                if (savedPos == -1) {
+                    db.setLastReadCounterForUserContact(m.username, m.collocutor, -1, false);
+                }
+            }
+        }
+        from += countMessages;
+    }
+    QCOMPARE(db.getMessageMaxCounter("1234"), from - 1);
+}
+
 void tst_MessengerDBStorage::testMessengerDecryptedText()
 {
     if (QFile::exists(dbName))
@@ -330,4 +463,351 @@ void tst_MessengerDBStorage::testMessengerDecryptedText()
     }
 }
 
+void tst_MessengerDBStorage::testMessengerDBSearch()
+{
+    if (QFile::exists(dbName))
+        QFile::remove(dbName);
+    messenger::MessengerDBStorage db;
+    db.init();
+    if (!db.isSearchEnabled()) {
+        QSKIP("sqlite without fts5");
+    }
+
+    const auto toHex = [](const QString &text) {
+        return QString(text.toUtf8().toHex());
+    };
+
+    db.setUserPublicKey("1234", "23424", "2345342", "", "");
+    DBStorage::DbId id1 = db.getUserId("1234");
+    db.addChannel(id1, "channel1", "ch1", true, "ktkt", false, true, true);
+    db.addMessage("1234", "3454", "abcd", toHex("hello world"), true, 1, 4000, true, true, true, "asdfdf", 1);
+    db.addMessage("1234", "3454", "abcd", toHex("another hello"), true, 1, 4001, true, true, true, "asdfdf", 1);
+    db.addMessage("1234", "3457", "abcd", toHex("hello from other contact"), true, 1, 4002, true, true, true, "asdfdf", 1);
+    db.addMessage("1234", "3457", "abcd", "", false, 1, 4003, true, true, true, "asdfdf", 1);
+    db.addMessage("1234", "3454", "abcd", toHex("hello channel"), true, 1, 4004, true, true, true, "asdfdf", 1, "ch1");
+
+    QCOMPARE(db.searchMessages("1234", "", false, "hello", 0, 100).size(), 4);
+    QCOMPARE(db.searchMessages("1234", "3454", false, "hello", 0, 100).size(), 2);
+    QCOMPARE(db.searchMessages("1234", "ch1", true, "hello", 0, 100).size(), 1);
+    QCOMPARE(db.searchMessages("1234", "", false, "hello world", 0, 100).size(), 1);
+    QCOMPARE(db.searchMessages("1234", "", false, "hello", 1, 2).size(), 2);
+    QCOMPARE(db.searchMessages("1234", "", false, "hello", 3, 2).size(), 1);
+    QCOMPARE(db.searchMessages("1234", "", false, "\"hel OR", 0, 100).size(), 0);
+    QCOMPARE(db.searchMessages("1234", "", false, "   ", 0, 100).size(), 0);
+    QCOMPARE(db.searchMessages("user7", "", false, "hello", 0, 100).size(), 0);
+
+    const std::vector<messenger::Message> channelResult = db.searchMessages("1234", "", false, "channel", 0, 100);
+    QCOMPARE(channelResult.size(), 1);
+    QCOMPARE(channelResult[0].isChannel, true);
+    QCOMPARE(channelResult[0].channel, QStringLiteral("ch1"));
+
+    auto notDecrypted = db.getNotDecryptedMessage("1234");
+    QCOMPARE(notDecrypted.first.size(), 1);
+    db.updateDecryptedMessage({{notDecrypted.first[0], true, toHex("decrypted later")}});
+    QCOMPARE(db.searchMessages("1234", "3457", false, "later", 0, 100).size(), 1);
+
+    db.removeDecryptedData();
+    QCOMPARE(db.searchMessages("1234", "", false, "hello", 0, 100).size(), 0);
+    QCOMPARE(db.searchMessages("1234", "", false, "later", 0, 100).size(), 0);
+}
+
+static void bindAllValues(QSqlQuery &query, const QString &sql, const std::map<QString, QVariant> &values) {
+    CHECK(query.prepare(sql), query.lastError().text().toStdString());
+    QRegExp paramRegexp(":(\\w+)");
+    for (int pos = paramRegexp.indexIn(sql); pos != -1; pos = paramRegexp.indexIn(sql, pos + paramRegexp.matchedLength())) {
+        const QString param = paramRegexp.cap(1);
+        const auto found = values.find(param);
+        query.bindValue(":" + param, found != values.end() ? found->second : QVariant(1));
+    }
+}
+
+static QString explainQueryPlan(const QString &sql) {
+    QSqlQuery query(QSqlDatabase::database(messenger::databaseName));
+    bindAllValues(query, "EXPLAIN QUERY PLAN " + sql, {});
+    CHECK(query.exec(), query.lastError().text().toStdString());
+    QStringList details;
+    while (query.next()) {
+        details.append(query.value("detail").toString());
+    }
+    return details.join("; ");
+}
+
+static std::vector<std::pair<QString, QString>> messengerQueries() {
+    using namespace messenger;
+    return {
+        {"selectMsgMaxCounter", selectMsgMaxCounter.arg(selectWhereIsNotChannel)},
+        {"selectMsgMaxCounter channel", selectMsgMaxCounter.arg(selectWhereChannel)},
+        {"selectMsgMaxConfirmedCounter", selectMsgMaxConfirmedCounter},
+        {"selectMsgMessagesForUser", selectMsgMessagesForUser},
+        {"selectMsgMessagesForUserAndDest", selectMsgMessagesForUserAndDest},
+        {"selectMsgMessagesForUserAndChannel", selectMsgMessagesForUserAndChannel},
+        {"selectMsgMessagesForUserAndDestNum", selectMsgMessagesForUserAndDestNum},
+        {"selectMsgMessagesForUserAndChannelNum", selectMsgMessagesForUserAndChannelNum},
+        {"selectMsgCountMessagesForUserAndDest", selectMsgCountMessagesForUserAndDest},
+        {"selectCountMessagesWithCounter", selectCountMessagesWithCounter.arg(selectWhereIsNotChannel)},
+        {"selectFirstNotConfirmedMessage", selectFirstNotConfirmedMessage},
+        {"selectFirstNotConfirmedMessageWithHash", selectFirstNotConfirmedMessageWithHash.arg(selectWhereIsNotChannel)},
+        {"selectFirstMessageWithHash", selectFirstMessageWithHash.arg(selectWhereIsNotChannel)},
+        {"selectCountNotConfirmedMessagesWithHash", selectCountNotConfirmedMessagesWithHash},
+        {"selectNotDecryptedMessagesContactsQuery", selectNotDecryptedMessagesContactsQuery},
+        {"selectNotDecryptedMessagesChannelsQuery", selectNotDecryptedMessagesChannelsQuery},
+    };
+}
+
+void tst_MessengerDBStorage::testMessengerDBQueryPlan()
+{
+    if (QFile::exists(dbName))
+        QFile::remove(dbName);
+    messenger::MessengerDBStorage db;
+    db.init();
+
+    const std::map<QString, QString> expectedIndexes = {
+        {"selectMsgMaxCounter", "messagesUniqueIdx2"},
+        {"selectMsgMaxCounter channel", "messagesUniqueIdx2"},
+        {"selectMsgMaxConfirmedCounter", "messagesUserConfirmedIdx"},
+        {"selectMsgMessagesForUser", "messagesUserCounterIdx"},
+        {"selectMsgMessagesForUserAndDest", "messagesUniqueIdx1"},
+        {"selectMsgMessagesForUserAndChannel", "messagesUniqueIdx2"},
+        {"selectMsgMessagesForUserAndDestNum", "messagesUniqueIdx1"},
+        {"selectMsgMessagesForUserAndChannelNum", "messagesUniqueIdx2"},
+        {"selectMsgCountMessagesForUserAndDest", "messagesUniqueIdx1"},
+        {"selectCountMessagesWithCounter", "messagesUniqueIdx2"},
+        {"selectFirstNotConfirmedMessage", "messagesUserConfirmedIdx"},
+        {"selectFirstNotConfirmedMessageWithHash", "messagesUserHashIdx"},
+        {"selectFirstMessageWithHash", "messagesUserHashIdx"},
+        {"selectCountNotConfirmedMessagesWithHash", "messagesUserHashIdx"},
+        {"selectNotDecryptedMessagesContactsQuery", "messagesNotDecryptedIdx"},
+        {"selectNotDecryptedMessagesChannelsQuery", "messagesNotDecryptedIdx"},
+    };
+
+    for (const auto &pair: messengerQueries()) {
+        const QString plan = explainQueryPlan(pair.second);
+        const QString message = pair.first + ": " + plan;
+        QVERIFY2(plan.contains(" INDEX " + expectedIndexes.at(pair.first)), message.toUtf8().constData());
+        QVERIFY2(!plan.contains(QRegExp("SCAN (TABLE messages|m)\\b")), message.toUtf8().constData());
+        QVERIFY2(!plan.contains("TEMP B-TREE"), message.toUtf8().constData());
+    }
+}
+
+void tst_MessengerDBStorage::testMessengerDBUpdate1to2()
+{
+    if (QFile::exists(dbName))
+        QFile::remove(dbName);
+    const auto indexExist = [](const QString &name) {
+        QSqlQuery query(QSqlDatabase::database(messenger::databaseName));
+        CHECK(query.prepare("SELECT COUNT(*) AS count FROM sqlite_master WHERE type = 'index' AND name = :name"), query.lastError().text().toStdString());
+        query.bindValue(":name", name);
+        CHECK(query.exec(), query.lastError().text().toStdString());
+        CHECK(query.next(), "Incorrect query");
+        return query.value("count").toInt() > 0;
+    };
+
+    {
+        messenger::MessengerDBStorage db;
+        db.init();
+        db.addMessages(makeMessages("1234", "3454", "", 1, 10));
+
+        // Возвращаем базу к схеме первой версии
+        QSqlQuery query(QSqlDatabase::database(messenger::databaseName));
+        for (const QString &sql: {"DROP INDEX messagesUserCounterIdx", "DROP INDEX messagesUserConfirmedIdx",
+                                  "DROP INDEX messagesUserHashIdx", "DROP INDEX messagesNotDecryptedIdx",
+                                  "CREATE INDEX messagesCounterIdx ON messages(morder)",
+                                  "ALTER TABLE lastreadmessage RENAME TO lastreadmessageOld",
+                                  "CREATE TABLE lastreadmessage (id INTEGER PRIMARY KEY NOT NULL, userid INTEGER NOT NULL, "
+                                  "contactid INTEGER, channelid INTEGER, lastcounter INT8)",
+                                  "INSERT INTO lastreadmessage SELECT id, userid, contactid, channelid, lastcounter FROM lastreadmessageOld",
+                                  "DROP TABLE lastreadmessageOld",
+                                  "CREATE UNIQUE INDEX lastreadmessageUniqueIdx1 ON lastreadmessage(userid, contactid)",
+                                  "CREATE UNIQUE INDEX lastreadmessageUniqueIdx2 ON lastreadmessage(userid, channelid)",
+                                  "UPDATE settings SET value = 1 WHERE key = 'dbversion'"}) {
+            QVERIFY2(query.exec(sql), query.lastError().text().toUtf8().constData());
+        }
+        QVERIFY(indexExist("messagesCounterIdx"));
+        QVERIFY(!indexExist("messagesUserCounterIdx"));
+    }
+
+    messenger::MessengerDBStorage db;
+    QVERIFY(db.init());
+    QCOMPARE(db.getSettings("dbversion").toInt(), messenger::databaseVersion);
+    QVERIFY(!indexExist("messagesCounterIdx"));
+    QVERIFY(indexExist("messagesUserCounterIdx"));
+    QVERIFY(indexExist("messagesUserConfirmedIdx"));
+    QVERIFY(indexExist("messagesUserHashIdx"));
+    QVERIFY(indexExist("messagesNotDecryptedIdx"));
+    QCOMPARE(db.getMessagesCountForUserAndDest("1234", "3454", 0), 10);
+
+    // Непрочитанные заполняются при обновлении
+    const std::vector<messenger::UnreadCounter> counters = db.getUnreadCounters("1234");
+    QCOMPARE(counters.size(), 1);
+    QCOMPARE(counters[0].name, QString("3454"));
+    QCOMPARE(counters[0].unreadCount, 10);
+}
+
+void tst_MessengerDBStorage::testMessengerDBUnreadCounters()
+{
+    if (QFile::exists(dbName))
+        QFile::remove(dbName);
+    messenger::MessengerDBStorage db;
+    db.init();
+    db.setUserPublicKey("1234", "23424", "2345342", "", "");
+    const DBStorage::DbId id1 = db.getUserId("1234");
+    db.addChannel(id1, "channel", "ch1", true, "ktkt", false, true, true);
+
+    // Счетчик из lastreadmessage должен совпадать с подсчетом сообщений после позиции чтения
+    const auto compareWithCount = [&db](std::vector<messenger::UnreadCounter> &counters) {
+        counters = db.getUnreadCounters("1234");
+        for (const messenger::UnreadCounter &counter: counters) {
+            if (counter.isChannel) {
+                const std::vector<messenger::Message> messages = db.getMessagesForUserAndDest("1234", counter.name, counter.lastCounter + 1, 100000, true);
+                QCOMPARE(counter.unreadCount, messenger::Message::Counter(messages.size()));
+            } else {
+                QCOMPARE(counter.unreadCount, db.getMessagesCountForUserAndDest("1234", counter.name, counter.lastCounter + 1));
+            }
+        }
+    };
+    const auto findCounter = [](const std::vector<messenger::UnreadCounter> &counters, const QString &name) {
+        for (const messenger::UnreadCounter &counter: counters) {
+            if (counter.name == name) {
+                return counter.unreadCount;
+            }
+        }
+        return messenger::Message::Counter(-1);
+    };
+
+    std::vector<messenger::Message> messages = makeMessages("1234", "3454", "", 1, 10);
+    const std::vector<messenger::Message> messages2 = makeMessages("1234", "3457", "", 11, 5);
+    const std::vector<messenger::Message> messages3 = makeMessages("1234", "", "ch1", 1, 7);
+    messages.insert(messages.end(), messages2.begin(), messages2.end());
+    messages.insert(messages.end(), messages3.begin(), messages3.end());
+    db.addMessages(messages);
+
+    std::vector<messenger::UnreadCounter> counters;
+    compareWithCount(counters);
+    QCOMPARE(counters.size(), 3);
+    QCOMPARE(findCounter(counters, "3454"), 10);
+    QCOMPARE(findCounter(counters, "3457"), 5);
+    QCOMPARE(findCounter(counters, "ch1"), 7);
+
+    // Повторная вставка не меняет счетчики
+    db.addMessages(messages);
+    compareWithCount(counters);
+    QCOMPARE(findCounter(counters, "3454"), 10);
+
+    db.setLastReadCounterForUserContact("1234", "3454", 6);
+    db.setLastReadCounterForUserContact("1234", "ch1", 7, true);
+    compareWithCount(counters);
+    QCOMPARE(findCounter(counters, "3454"), 4);
+    QCOMPARE(findCounter(counters, "ch1"), 0);
+
+    // Сообщения до позиции чтения не считаются непрочитанными
+    db.addMessage("1234", "3454", "abcd", "", false, 1, 0, true, true, true, "asdfdf", 1);
+    db.addMessage("1234", "3454", "abcd", "", false, 1, 20, true, true, true, "asdfdf", 1);
+    db.addMessage("1234", "", "abcd", "", false, 1, 8, true, true, true, "asdfdf", 1, "ch1");
+    compareWithCount(counters);
+    QCOMPARE(findCounter(counters, "3454"), 5);
+    QCOMPARE(findCounter(counters, "ch1"), 1);
+
+    // Подтверждение сообщения меняет его номер
+    db.addMessage("1234", "3457", "abcd", "", false, 1, 3, false, true, false, "hash1", 1);
+    compareWithCount(counters);
+    db.setLastReadCounterForUserContact("1234", "3457", 5);
+    compareWithCount(counters);
+    QCOMPARE(findCounter(counters, "3457"), 5);
+    db.updateMessage(db.findFirstNotConfirmedMessage("1234"), 30, true);
+    compareWithCount(counters);
+    QCOMPARE(findCounter(counters, "3457"), 6);
+
+    const std::vector<messenger::ChannelInfo> channels = db.getChannelsWithLastReadCounters("1234");
+    QCOMPARE(channels.size(), 1);
+    QCOMPARE(channels[0].unreadCount, 1);
+}
+
+void tst_MessengerDBStorage::testMessengerDBQuerySpeed_data()
+{
+    QTest::addColumn<bool>("isOldIndexes");
+    QTest::addColumn<QString>("sql");
+
+    // Сначала все запросы на схеме первой версии, чтобы индексы перестраивались только один раз
+    for (const bool isOldIndexes: {true, false}) {
+        for (const auto &pair: messengerQueries()) {
+            const QString name = QString(isOldIndexes ? "v1 " : "v2 ") + pair.first;
+            QTest::newRow(name.toUtf8().constData()) << isOldIndexes << pair.second;
+        }
+    }
+}
+
+void tst_MessengerDBStorage::testMessengerDBQuerySpeed()
+{
+    QFETCH(bool, isOldIndexes);
+    QFETCH(QString, sql);
+
+    // Для замеров на большой базе: MESSENGER_BENCH_MESSAGES=5000000
+    const qint64 countMessages = qEnvironmentVariableIsSet("MESSENGER_BENCH_MESSAGES") ? qgetenv("MESSENGER_BENCH_MESSAGES").toLongLong() : 100000;
+    const QString benchPath = "messengerBench";
+    QDir().mkpath(benchPath);
+
+    messenger::MessengerDBStorage db(benchPath);
+    db.init();
+    QSqlQuery query(QSqlDatabase::database(messenger::databaseName));
+
+    CHECK(query.exec("SELECT COUNT(*) AS count FROM messages"), query.lastError().text().toStdString());
+    CHECK(query.next(), "Incorrect query");
+    if (query.value("count").toLongLong() != countMessages) {
+        // 5 пользователей, 1000 собеседников, 100 каналов. Каждое 97-е сообщение не расшифровано, каждое 1013-е не подтверждено
+        const QString fillSqls[] = {
+            "DELETE FROM messages",
+            "DELETE FROM channels",
+            "INSERT OR IGNORE INTO users (id, username) "
+                "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 5) SELECT i, 'user' || i FROM n",
+            "INSERT OR IGNORE INTO contacts (id, username) "
+                "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000) SELECT i, 'contact' || i FROM n",
+            "INSERT INTO channels (id, userid, channel, shaName, isAdmin) "
+                "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 100) SELECT i, 1 + i % 5, 'ch' || i, 'sha' || i, 0 FROM n",
+            QString("INSERT INTO messages (userid, contactid, morder, dt, text, decryptedText, isDecrypted, isIncoming, canDecrypted, isConfirmed, hash, fee, channelid) "
+                "WITH RECURSIVE n(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM n WHERE i < %1 - 1) "
+                "SELECT 1 + i % 5, 1 + (i / 5) % 1000, i / 5, 1000000 + i, 'abcd', '', (i % 97) != 0, i % 2, 1, (i % 1013) != 0, 'h' || i, 1, "
+                "CASE WHEN i % 25 = 0 THEN 1 + ((i / 25) % 20) * 5 ELSE NULL END FROM n").arg(countMessages)
+        };
+        auto transactionGuard = db.beginTransaction();
+        for (const QString &fillSql: fillSqls) {
+            CHECK(query.exec(fillSql), query.lastError().text().toStdString());
+        }
+        transactionGuard.commit();
+    }
+
+    CHECK(query.exec("SELECT COUNT(*) AS count FROM sqlite_master WHERE type = 'index' AND name = 'messagesCounterIdx'"), query.lastError().text().toStdString());
+    CHECK(query.next(), "Incorrect query");
+    const bool isOldNow = query.value("count").toInt() > 0;
+    if (isOldNow != isOldIndexes) {
+        const QStringList newIndexes = {"messagesUserCounterIdx", "messagesUserConfirmedIdx", "messagesUserHashIdx", "messagesNotDecryptedIdx"};
+        if (isOldIndexes) {
+            for (const QString &index: newIndexes) {
+                CHECK(query.exec("DROP INDEX " + index), query.lastError().text().toStdString());
+            }
+            CHECK(query.exec("CREATE INDEX messagesCounterIdx ON messages(morder)"), query.lastError().text().toStdString());
+        } else {
+            QFile file(":/messenger_1to2.sql");
+            CHECK(file.open(QIODevice::ReadOnly | QIODevice::Text), "can't open file");
+            for (const QString &updateSql: QString(file.readAll()).split(';')) {
+                if (!updateSql.trimmed().isEmpty()) {
+                    CHECK(query.exec(updateSql), query.lastError().text().toStdString());
+                }
+            }
+        }
+    }
+
+    const std::map<QString, QVariant> values = {
+        {"userid", 1}, {"contactid", 6}, {"channelid", 6}, {"user", "user1"},
+        {"ob", countMessages / 5 - 2000}, {"oe", countMessages / 5 - 1000}, {"num", 100},
+        {"counter", countMessages / 10}, {"hash", QString("h%1").arg(countMessages / 2)}
+    };
+    QSqlQuery benchQuery(QSqlDatabase::database(messenger::databaseName));
+    bindAllValues(benchQuery, sql, values);
+    QBENCHMARK {
+        CHECK(benchQuery.exec(), benchQuery.lastError().text().toStdString());
+        while (benchQuery.next()) {
+        }
+    }
+}
+
 QTEST_MAIN(tst_MessengerDBStorage)
@@ -16,7 +16,17 @@ private slots:
     void testMessengerDB2();
     void testMessengerDBChannels();
     void testMessengerDBSpeed();
+    void testMessengerDBAddMessages();
+    void testMessengerDBIdCache();
+    void testMessengerDBAddMessagesSpeed_data();
+    void testMessengerDBAddMessagesSpeed();
     void testMessengerDecryptedText();
+    void testMessengerDBSearch();
+    void testMessengerDBQueryPlan();
+    void testMessengerDBUpdate1to2();
+    void testMessengerDBUnreadCounters();
+    void testMessengerDBQuerySpeed_data();
+    void testMessengerDBQuerySpeed();
 };
 
 #endif // TST_MESSENGERDBSTORAGE_H
@@ -17,6 +17,7 @@ SOURCES += \
     ../../src/utils.cpp \
     ../../src/Paths.cpp \
     ../../src/btctx/Base58.cpp \
+    ../../src/HexBase64.cpp \
     ../../src/Messenger/MessengerDBStorage.cpp
 
 
@@ -25,6 +26,9 @@ HEADERS += \
     ../../src/dbstorage.h \
     ../../src/Messenger/MessengerDBStorage.h
 
+RESOURCES += \
+    ../../dbupdates/dbupdates.qrc
+
 QMAKE_LFLAGS += -rdynamic
 unix:!macx: include(../../libs-unix.pri)
 win32: include(../../libs-win.pri)
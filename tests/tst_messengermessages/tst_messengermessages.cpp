@@ -0,0 +1,218 @@
+#include "tst_messengermessages.h"
+
+#include <QTest>
+#include <QJsonDocument>
+
+#include "check.h"
+
+#include "Messenger/MessengerMessages.h"
+
+using namespace messenger;
+
+const static int COUNT_BENCHMARK_MESSAGES = 1000;
+
+tst_MessengerMessages::tst_MessengerMessages(QObject *parent)
+    : QObject(parent)
+{
+}
+
+static QString makeMessageJson(int counter, const QString &type) {
+    QString result = "{\"from\":\"0x00a1b2c3d4e5f60718293a4b5c6d7e8f90a1b2c3d4e5f607\",";
+    result += "\"data\":\"" + QString(512, 'a') + QString::number(counter) + "\",";
+    result += "\"fee\":\"0\",";
+    result += "\"cnt\":\"" + QString::number(counter) + "\",";
+    result += "\"timestamp\":\"" + QString::number(1546300800000 + counter) + "\",";
+    result += "\"type\":\"" + type + "\"";
+    if (type == "channel") {
+        result += ",\"channel\":\"4a5b6c7d\"";
+    }
+    result += "}";
+    return result;
+}
+
+static QString makeMessagesJson(const QString &method, int count, const QString &type) {
+    QString result = "{\"result\":\"ok\",\"method\":\"" + method + "\",\"addr\":\"0x00a1b2c3\",\"request_id\":\"15\",\"data\":{\"messages\":[";
+    for (int i = count; i > 0; i--) {
+        if (i != count) {
+            result += ",";
+        }
+        result += makeMessageJson(i, type);
+    }
+    result += "]}}";
+    return result;
+}
+
+static QString makeNewMsgJson() {
+    return "{\"method\":\"new_msg\",\"addr\":\"0x00a1b2c3\",\"params\":" + makeMessageJson(7, "in") + "}";
+}
+
+static void compareResponseType(const ResponseType &result, const ResponseType &expected) {
+    QCOMPARE(result.method, expected.method);
+    QCOMPARE(result.address, expected.address);
+    QCOMPARE(result.isError, expected.isError);
+    QCOMPARE(result.error, expected.error);
+    QCOMPARE(result.errorType, expected.errorType);
+    QCOMPARE(result.id, expected.id);
+}
+
+static void compareMessages(const std::vector<NewMessageResponse> &result, const std::vector<NewMessageResponse> &expected) {
+    QCOMPARE(result.size(), expected.size());
+    for (size_t i = 0; i < result.size(); i++) {
+        QCOMPARE(result[i].collocutor, expected[i].collocutor);
+        QCOMPARE(result[i].data, expected[i].data);
+        QCOMPARE(result[i].fee, expected[i].fee);
+        QCOMPARE(result[i].counter, expected[i].counter);
+        QCOMPARE(result[i].timestamp, expected[i].timestamp);
+        QCOMPARE(result[i].isChannel, expected[i].isChannel);
+        if (!result[i].isChannel) {
+            QCOMPARE(result[i].isInput, expected[i].isInput);
+        }
+        QCOMPARE(result[i].channelName, expected[i].channelName);
+    }
+}
+
+void tst_MessengerMessages::testParseResponse_data() {
+    QTest::addColumn<QString>("response");
+
+    QTest::newRow("new_msg") << makeNewMsgJson();
+    QTest::newRow("new_msg method last")
+        << "{\"params\":" + makeMessageJson(3, "out") + ",\"addr\":\"0x00a1b2c3\",\"method\":\"new_msg\"}";
+    QTest::newRow("msg_get_my") << makeMessagesJson("msg_get_my", 10, "in");
+    QTest::newRow("msg_get_my empty") << makeMessagesJson("msg_get_my", 0, "in");
+    QTest::newRow("msg_get_channel") << makeMessagesJson("msg_get_channel", 10, "channel");
+    QTest::newRow("whitespaces and unknown fields")
+        << QString(" { \"unknown\" : [1, {\"a\": \"]}\"}, null] , \"method\" : \"msg_get_my\" ,\n\"data\" : { \"count\" : 1, \"messages\" : [ "
+           "{ \"type\" : \"in\", \"cnt\" : \"5\", \"extra\" : true, \"from\" : \"0x01\", \"data\" : \"ab\", \"fee\" : \"3\", \"timestamp\" : \"12\" } ] } } ");
+    QTest::newRow("escapes")
+        << QString("{\"method\":\"new_msg\",\"addr\":\"0x\\u0030\\\"1\\\\\",\"params\":"
+           "{\"from\":\"\\u043f\\u0440\\u0438\\n\",\"data\":\"a\\/b\",\"fee\":\"1\",\"cnt\":\"2\",\"timestamp\":\"3\",\"type\":\"out\"}}");
+    QTest::newRow("other method") << QString("{\"method\":\"msg_send_to_addr\",\"addr\":\"0x00a1b2c3\",\"request_id\":\"4\",\"data\":{\"a\":\"b\"}}");
+    QTest::newRow("error") << QString("{\"method\":\"msg_get_my\",\"error\":\"KEY_EXIST\",\"request_id\":\"4\",\"data\":{\"b\": \"1\" , \"a\":[1, 2]}}");
+    QTest::newRow("error other") << QString("{\"error\":\"SOME_ERROR\",\"method\":\"msg_get_channel\"}");
+    QTest::newRow("escaped keys")
+        << QString("{\"met\\u0068od\":\"new_msg\",\"a\\\\\\\"b\":[1],\"addr\":\"0x01\",\"params\":{\"\\u0066rom\":\"0x02\",\"data\":\"ab\",\"fee\":\"1\",\"cnt\":\"2\",\"timestamp\":\"3\",\"type\":\"in\"}}");
+    QTest::newRow("max numbers")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"18446744073709551615\",\"cnt\":\"9223372036854775807\",\"timestamp\":\"18446744073709551615\",\"type\":\"in\"}}");
+    QTest::newRow("min counter")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"0\",\"cnt\":\"-9223372036854775808\",\"timestamp\":\"0\",\"type\":\"in\"}}");
+}
+
+void tst_MessengerMessages::testParseResponse() {
+    QFETCH(QString, response);
+
+    const QJsonDocument json = QJsonDocument::fromJson(response.toUtf8());
+    const ResponseType expectedType = getMethodAndAddressResponse(json);
+
+    const ParsedResponse result = parseResponse(response);
+    compareResponseType(result.type, expectedType);
+
+    if (expectedType.isError) {
+        QCOMPARE(result.isMessagesParsed, false);
+    } else if (expectedType.method == METHOD::NEW_MSG) {
+        QCOMPARE(result.isMessagesParsed, true);
+        compareMessages(result.messages, {parseNewMessageResponse(json)});
+    } else if (expectedType.method == METHOD::NEW_MSGS) {
+        QCOMPARE(result.isMessagesParsed, true);
+        compareMessages(result.messages, parseNewMessagesResponse(json));
+    } else if (expectedType.method == METHOD::GET_CHANNEL) {
+        QCOMPARE(result.isMessagesParsed, true);
+        compareMessages(result.messages, parseGetChannelResponse(json));
+    } else {
+        QCOMPARE(result.isMessagesParsed, false);
+    }
+}
+
+void tst_MessengerMessages::testParseResponseIncorrect_data() {
+    QTest::addColumn<QString>("response");
+
+    QTest::newRow("empty") << QString("");
+    QTest::newRow("not object") << QString("[]");
+    QTest::newRow("unterminated") << QString("{\"method\":\"new_msg\"");
+    QTest::newRow("unknown method") << QString("{\"method\":\"msg_unknown\"}");
+    QTest::newRow("without params") << QString("{\"method\":\"new_msg\"}");
+    QTest::newRow("without messages") << QString("{\"method\":\"msg_get_my\",\"data\":{}}");
+    QTest::newRow("incorrect type")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"1\",\"cnt\":\"2\",\"timestamp\":\"3\",\"type\":\"unknown\"}}");
+    QTest::newRow("incorrect counter")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"1\",\"cnt\":\"2a\",\"timestamp\":\"3\",\"type\":\"in\"}}");
+    QTest::newRow("without channel")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"1\",\"cnt\":\"2\",\"timestamp\":\"3\",\"type\":\"channel\"}}");
+    QTest::newRow("trailing data") << QString("{\"method\":\"msg_send_to_addr\"} 1");
+    QTest::newRow("missing comma in object") << QString("{\"method\":\"msg_send_to_addr\" \"addr\":\"0x00a1b2c3\"}");
+    QTest::newRow("leading comma in object") << QString("{,\"method\":\"msg_send_to_addr\"}");
+    QTest::newRow("trailing comma in object") << QString("{\"method\":\"msg_send_to_addr\",}");
+    QTest::newRow("double comma in object") << QString("{\"method\":\"msg_send_to_addr\",,\"addr\":\"0x00a1b2c3\"}");
+    QTest::newRow("missing comma after nested object")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"1\",\"cnt\":\"2\",\"timestamp\":\"3\",\"type\":\"in\"} \"addr\":\"0x01\"}");
+    QTest::newRow("missing comma in array") << ("{\"method\":\"msg_get_my\",\"data\":{\"messages\":[" + makeMessageJson(2, "in") + makeMessageJson(1, "in") + "]}}");
+    QTest::newRow("leading comma in array") << ("{\"method\":\"msg_get_my\",\"data\":{\"messages\":[," + makeMessageJson(1, "in") + "]}}");
+    QTest::newRow("trailing comma in array") << ("{\"method\":\"msg_get_my\",\"data\":{\"messages\":[" + makeMessageJson(1, "in") + ",]}}");
+    QTest::newRow("counter overflow")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"1\",\"cnt\":\"9223372036854775808\",\"timestamp\":\"3\",\"type\":\"in\"}}");
+    QTest::newRow("negative counter overflow")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"1\",\"cnt\":\"-9223372036854775809\",\"timestamp\":\"3\",\"type\":\"in\"}}");
+    QTest::newRow("fee overflow")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"18446744073709551616\",\"cnt\":\"2\",\"timestamp\":\"3\",\"type\":\"in\"}}");
+    QTest::newRow("timestamp overflow")
+        << QString("{\"method\":\"new_msg\",\"params\":{\"from\":\"0x01\",\"data\":\"\",\"fee\":\"1\",\"cnt\":\"2\",\"timestamp\":\"100000000000000000000\",\"type\":\"in\"}}");
+}
+
+void tst_MessengerMessages::testParseResponseIncorrect() {
+    QFETCH(QString, response);
+
+    bool isException = false;
+    try {
+        parseResponse(response);
+    } catch (const Exception &) {
+        isException = true;
+    }
+    QCOMPARE(isException, true);
+}
+
+void tst_MessengerMessages::benchmarkParseMessagesJsonDocument() {
+    const QString response = makeMessagesJson("msg_get_my", COUNT_BENCHMARK_MESSAGES, "in");
+
+    std::vector<NewMessageResponse> result;
+    QBENCHMARK {
+        const QJsonDocument json = QJsonDocument::fromJson(response.toUtf8());
+        const ResponseType type = getMethodAndAddressResponse(json);
+        CHECK(type.method == METHOD::NEW_MSGS, "Incorrect method");
+        result = parseNewMessagesResponse(json);
+    }
+    QCOMPARE(result.size(), size_t(COUNT_BENCHMARK_MESSAGES));
+}
+
+void tst_MessengerMessages::benchmarkParseMessagesReader() {
+    const QString response = makeMessagesJson("msg_get_my", COUNT_BENCHMARK_MESSAGES, "in");
+
+    ParsedResponse result;
+    QBENCHMARK {
+        result = parseResponse(response);
+    }
+    QCOMPARE(result.messages.size(), size_t(COUNT_BENCHMARK_MESSAGES));
+}
+
+void tst_MessengerMessages::benchmarkParseNewMsgJsonDocument() {
+    const QString response = makeNewMsgJson();
+
+    NewMessageResponse result;
+    QBENCHMARK {
+        const QJsonDocument json = QJsonDocument::fromJson(response.toUtf8());
+        const ResponseType type = getMethodAndAddressResponse(json);
+        CHECK(type.method == METHOD::NEW_MSG, "Incorrect method");
+        result = parseNewMessageResponse(json);
+    }
+    QCOMPARE(result.counter, Message::Counter(7));
+}
+
+void tst_MessengerMessages::benchmarkParseNewMsgReader() {
+    const QString response = makeNewMsgJson();
+
+    ParsedResponse result;
+    QBENCHMARK {
+        result = parseResponse(response);
+    }
+    QCOMPARE(result.messages.at(0).counter, Message::Counter(7));
+}
+
+QTEST_MAIN(tst_MessengerMessages)
@@ -0,0 +1,30 @@
+#ifndef TST_MESSENGERMESSAGES_H
+#define TST_MESSENGERMESSAGES_H
+
+#include <QObject>
+
+class tst_MessengerMessages : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_MessengerMessages(QObject *parent = nullptr);
+
+private slots:
+
+    void testParseResponse_data();
+    void testParseResponse();
+
+    void testParseResponseIncorrect_data();
+    void testParseResponseIncorrect();
+
+    void benchmarkParseMessagesJsonDocument();
+
+    void benchmarkParseMessagesReader();
+
+    void benchmarkParseNewMsgJsonDocument();
+
+    void benchmarkParseNewMsgReader();
+
+};
+
+#endif // TST_MESSENGERMESSAGES_H
@@ -0,0 +1,32 @@
+QT      += testlib
+QT      -= gui
+QT      += widgets
+TARGET = tst_messengermessages
+CONFIG   += testcase
+CONFIG += c++14
+CONFIG += static
+
+TEMPLATE = app
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    tst_messengermessages.cpp \
+    ../../src/Log.cpp \
+    ../../src/utils.cpp \
+    ../../src/Paths.cpp \
+    ../../src/btctx/Base58.cpp \
+    ../../src/HexBase64.cpp \
+    ../../src/Messenger/MessengerMessages.cpp
+
+
+HEADERS += \
+    tst_messengermessages.h \
+    ../../src/JsonReader.h \
+    ../../src/PerfectHash.h \
+    ../../src/Messenger/MessengerMessages.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
@@ -0,0 +1,144 @@
+#include "tst_nodesfile.h"
+
+#include <QTest>
+#include <QFile>
+
+#include <cstring>
+
+#include "check.h"
+#include "utils.h"
+
+#include "NodesFile.h"
+
+using namespace nodes_file;
+
+const static QString binaryFileName = "fill_nodes_test.bin";
+const static QString textFileName = "fill_nodes_test.txt";
+
+const static std::string hashNodes = "0123456789abcdef0123456789abcdef";
+
+const static size_t COUNT_BENCHMARK_RECORDS = 5000;
+
+tst_NodesFile::tst_NodesFile(QObject *parent)
+    : QObject(parent)
+{
+}
+
+static NodesFileContent makeContent(size_t count) {
+    const std::vector<QString> types = {"torrent_main", "proxy_main", "torrent_v8", "proxy_v8"};
+
+    NodesFileContent content;
+    content.timePoint = intToSystemTimePoint(1546300800000);
+    for (size_t i = 0; i < count; i++) {
+        NodeRecord record;
+        record.type = types[i % types.size()];
+        record.address = "http://10." + QString::number((i / 65536) % 256) + "." + QString::number((i / 256) % 256) + "." + QString::number(i % 256) + ":5795";
+        record.ping = i * 7 % 1000;
+        record.isTimeout = i % 5 == 0;
+        content.records.emplace_back(record);
+    }
+    return content;
+}
+
+static void compareRecords(const std::vector<NodeRecord> &first, const std::vector<NodeRecord> &second) {
+    // Записи в бинарном файле сгруппированы по типам
+    const auto sortRecords = [](std::vector<NodeRecord> records) {
+        std::stable_sort(records.begin(), records.end(), [](const NodeRecord &a, const NodeRecord &b) {
+            return a.type < b.type;
+        });
+        return records;
+    };
+    const std::vector<NodeRecord> firstSorted = sortRecords(first);
+    const std::vector<NodeRecord> secondSorted = sortRecords(second);
+
+    QCOMPARE(firstSorted.size(), secondSorted.size());
+    for (size_t i = 0; i < firstSorted.size(); i++) {
+        QCOMPARE(firstSorted[i].type, secondSorted[i].type);
+        QCOMPARE(firstSorted[i].address, secondSorted[i].address);
+        QCOMPARE(firstSorted[i].ping, secondSorted[i].ping);
+        QCOMPARE(firstSorted[i].isTimeout, secondSorted[i].isTimeout);
+    }
+}
+
+void tst_NodesFile::testBinaryReadWrite() {
+    QFile::remove(binaryFileName);
+    const NodesFileContent content = makeContent(100);
+    writeBinary(binaryFileName, hashNodes, content);
+
+    NodesFileContent result;
+    QCOMPARE(readBinary(binaryFileName, hashNodes, result), true);
+    QCOMPARE(systemTimePointToInt(result.timePoint), systemTimePointToInt(content.timePoint));
+    compareRecords(result.records, content.records);
+
+    writeBinary(binaryFileName, hashNodes, NodesFileContent());
+    QCOMPARE(readBinary(binaryFileName, hashNodes, result), true);
+    QCOMPARE(result.records.size(), 0);
+}
+
+void tst_NodesFile::testBinaryIncorrectHash() {
+    QFile::remove(binaryFileName);
+    NodesFileContent result;
+    QCOMPARE(readBinary(binaryFileName, hashNodes, result), false);
+
+    writeBinary(binaryFileName, hashNodes, makeContent(10));
+    QCOMPARE(readBinary(binaryFileName, "fedcba9876543210fedcba9876543210", result), false);
+
+    writeToFile(binaryFileName, "v3\n", false);
+    QCOMPARE(readBinary(binaryFileName, hashNodes, result), false);
+}
+
+void tst_NodesFile::testBinaryIncorrectCountRecords() {
+    writeBinary(binaryFileName, hashNodes, makeContent(1));
+
+    QByteArray data;
+    {
+        QFile file(binaryFileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        data = file.readAll();
+    }
+    // Заголовок файла 56 байт, в заголовке секции количество записей идет после 32 байт типа
+    const int countRecordsOffset = 56 + 32;
+    QVERIFY(data.size() > countRecordsOffset + 4);
+
+    for (const uint32_t countRecords: {uint32_t(2), uint32_t(0x7FFFFFFF), uint32_t(0xFFFFFFFF)}) {
+        QByteArray corrupted = data;
+        std::memcpy(corrupted.data() + countRecordsOffset, &countRecords, sizeof(countRecords));
+        writeToFile(binaryFileName, corrupted.toStdString(), false);
+
+        NodesFileContent result;
+        QCOMPARE(readBinary(binaryFileName, hashNodes, result), false);
+    }
+}
+
+void tst_NodesFile::testTextReadWrite() {
+    QFile::remove(textFileName);
+    const NodesFileContent content = makeContent(100);
+    writeText(textFileName, hashNodes, content);
+
+    NodesFileContent result;
+    QCOMPARE(readText(textFileName, hashNodes, result), true);
+    QCOMPARE(systemTimePointToInt(result.timePoint), systemTimePointToInt(content.timePoint));
+    compareRecords(result.records, content.records);
+}
+
+void tst_NodesFile::benchmarkReadText() {
+    writeText(textFileName, hashNodes, makeContent(COUNT_BENCHMARK_RECORDS));
+
+    NodesFileContent result;
+    QBENCHMARK {
+        CHECK(readText(textFileName, hashNodes, result), "Not read");
+    }
+    QCOMPARE(result.records.size(), COUNT_BENCHMARK_RECORDS);
+}
+
+void tst_NodesFile::benchmarkReadBinary() {
+    writeBinary(binaryFileName, hashNodes, makeContent(COUNT_BENCHMARK_RECORDS));
+
+    NodesFileContent result;
+    QBENCHMARK {
+        CHECK(readBinary(binaryFileName, hashNodes, result), "Not read");
+    }
+    QCOMPARE(result.records.size(), COUNT_BENCHMARK_RECORDS);
+}
+
+QTEST_MAIN(tst_NodesFile)
@@ -0,0 +1,28 @@
+#ifndef TST_NODESFILE_H
+#define TST_NODESFILE_H
+
+#include <QObject>
+
+class tst_NodesFile : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_NodesFile(QObject *parent = nullptr);
+
+private slots:
+
+    void testBinaryReadWrite();
+
+    void testBinaryIncorrectHash();
+
+    void testBinaryIncorrectCountRecords();
+
+    void testTextReadWrite();
+
+    void benchmarkReadText();
+
+    void benchmarkReadBinary();
+
+};
+
+#endif // TST_NODESFILE_H
@@ -0,0 +1,30 @@
+QT      += testlib
+QT      -= gui
+QT      += widgets
+TARGET = tst_nodesfile
+CONFIG   += testcase
+CONFIG += c++14
+CONFIG += static
+
+TEMPLATE = app
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    tst_nodesfile.cpp \
+    ../../src/Log.cpp \
+    ../../src/utils.cpp \
+    ../../src/Paths.cpp \
+    ../../src/btctx/Base58.cpp \
+    ../../src/HexBase64.cpp \
+    ../../src/NodesFile.cpp
+
+
+HEADERS += \
+    tst_nodesfile.h \
+    ../../src/NodesFile.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
@@ -0,0 +1,185 @@
+#include "tst_nodeslist.h"
+
+#include <QTest>
+
+#include "NodesList.h"
+
+using namespace nodes_list;
+
+const static size_t MAX_PING = 100000;
+
+const static size_t RETIRE_COUNT_FAILS = 5;
+
+const static size_t EWMA_WEIGHT = 3;
+
+tst_NodesList::tst_NodesList(QObject *parent)
+    : QObject(parent)
+{
+}
+
+static NodeInfo makeInfo(const QString &address, size_t ping, bool isChecked, bool isTimeout) {
+    NodeInfo info;
+    info.address = address;
+    info.ping = ping;
+    info.isChecked = isChecked;
+    info.isTimeout = isTimeout;
+    return info;
+}
+
+static NodeInfo makeResult(const QString &address, size_t ping) {
+    return makeInfo(address, ping, true, false);
+}
+
+static NodeInfo makeTimeout(const QString &address) {
+    return makeInfo(address, MAX_PING, true, true);
+}
+
+static std::vector<QString> addressesOf(const std::vector<NodeInfo> &infos) {
+    std::vector<QString> result;
+    for (const NodeInfo &info: infos) {
+        result.emplace_back(info.address);
+    }
+    return result;
+}
+
+void tst_NodesList::testMergeAddresses() {
+    std::vector<NodeInfo> infos = {
+        makeResult("http://1.1.1.1:80", 10),
+        makeResult("http://2.2.2.2:80", 20),
+        makeResult("http://3.3.3.3:80", 30)
+    };
+
+    const MergeResult result = mergeAddresses(infos, {"http://2.2.2.2:80", "http://4.4.4.4:80", "http://3.3.3.3:80", "http://5.5.5.5:80"}, MAX_PING);
+
+    QCOMPARE(result.countRetired, size_t(1));
+    QCOMPARE(result.added, std::vector<QString>({"http://4.4.4.4:80", "http://5.5.5.5:80"}));
+    QCOMPARE(addressesOf(infos), std::vector<QString>({"http://2.2.2.2:80", "http://3.3.3.3:80", "http://4.4.4.4:80", "http://5.5.5.5:80"}));
+
+    QCOMPARE(infos[2].ping, MAX_PING);
+    QCOMPARE(infos[2].isChecked, false);
+    QCOMPARE(infos[2].isTimeout, false);
+    QCOMPARE(infos[2].countFails, size_t(0));
+}
+
+void tst_NodesList::testMergeAddressesKeepsState() {
+    NodeInfo failed = makeTimeout("http://1.1.1.1:80");
+    failed.countFails = 2;
+    std::vector<NodeInfo> infos = {makeResult("http://2.2.2.2:80", 20), failed};
+
+    const MergeResult result = mergeAddresses(infos, {"http://1.1.1.1:80", "http://2.2.2.2:80"}, MAX_PING);
+
+    QCOMPARE(result.countRetired, size_t(0));
+    QVERIFY(result.added.empty());
+    QCOMPARE(infos.size(), size_t(2));
+    QCOMPARE(infos[0].ping, size_t(20));
+    QCOMPARE(infos[0].isChecked, true);
+    QCOMPARE(infos[1].isTimeout, true);
+    QCOMPARE(infos[1].countFails, size_t(2));
+
+    const MergeResult empty = mergeAddresses(infos, {}, MAX_PING);
+    QCOMPARE(empty.countRetired, size_t(2));
+    QVERIFY(infos.empty());
+}
+
+void tst_NodesList::testApplyProbeFirstResult() {
+    std::vector<NodeInfo> infos;
+    mergeAddresses(infos, {"http://1.1.1.1:80"}, MAX_PING);
+
+    QVERIFY(applyProbe(infos, makeResult("http://1.1.1.1:80", 40), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+
+    // Непроверенная нода принимает пинг без усреднения
+    QCOMPARE(infos[0].ping, size_t(40));
+    QCOMPARE(infos[0].isChecked, true);
+    QCOMPARE(infos[0].isTimeout, false);
+}
+
+void tst_NodesList::testApplyProbeEwma() {
+    std::vector<NodeInfo> infos = {makeResult("http://1.1.1.1:80", 100)};
+
+    QVERIFY(applyProbe(infos, makeResult("http://1.1.1.1:80", 200), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+    QCOMPARE(infos[0].ping, size_t((100 * 7 + 200 * 3) / 10));
+
+    QVERIFY(applyProbe(infos, makeResult("http://1.1.1.1:80", 30), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+    QCOMPARE(infos[0].ping, size_t((130 * 7 + 30 * 3) / 10));
+}
+
+void tst_NodesList::testApplyProbeAfterTimeout() {
+    std::vector<NodeInfo> infos = {makeResult("http://1.1.1.1:80", 100)};
+
+    QVERIFY(applyProbe(infos, makeTimeout("http://1.1.1.1:80"), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+    QCOMPARE(infos[0].isTimeout, true);
+    QCOMPARE(infos[0].countFails, size_t(1));
+    // Пинг таймаута в среднее не попадает
+    QCOMPARE(infos[0].ping, size_t(100));
+
+    QVERIFY(applyProbe(infos, makeResult("http://1.1.1.1:80", 50), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+    QCOMPARE(infos[0].isTimeout, false);
+    QCOMPARE(infos[0].countFails, size_t(0));
+    QCOMPARE(infos[0].ping, size_t(50));
+}
+
+void tst_NodesList::testApplyProbeRetire() {
+    std::vector<NodeInfo> infos = {makeResult("http://1.1.1.1:80", 100), makeResult("http://2.2.2.2:80", 200)};
+
+    for (size_t i = 0; i < RETIRE_COUNT_FAILS - 1; i++) {
+        QVERIFY(applyProbe(infos, makeTimeout("http://1.1.1.1:80"), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+        QCOMPARE(infos.size(), size_t(2));
+    }
+    QVERIFY(applyProbe(infos, makeTimeout("http://1.1.1.1:80"), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+    QCOMPARE(addressesOf(infos), std::vector<QString>({"http://2.2.2.2:80"}));
+
+    // После удаления результаты пробы игнорируются
+    QVERIFY(!applyProbe(infos, makeResult("http://1.1.1.1:80", 10), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+    QCOMPARE(addressesOf(infos), std::vector<QString>({"http://2.2.2.2:80"}));
+}
+
+void tst_NodesList::testApplyProbeRemovedNode() {
+    std::vector<NodeInfo> infos = {makeResult("http://1.1.1.1:80", 100)};
+    mergeAddresses(infos, {"http://2.2.2.2:80"}, MAX_PING);
+
+    // Проба ушла до обновления dns, а ответ пришел после
+    QVERIFY(!applyProbe(infos, makeResult("http://1.1.1.1:80", 10), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+    QCOMPARE(addressesOf(infos), std::vector<QString>({"http://2.2.2.2:80"}));
+    QCOMPARE(infos[0].isChecked, false);
+}
+
+void tst_NodesList::testApplyProbeSort() {
+    std::vector<NodeInfo> infos;
+    mergeAddresses(infos, {"http://1.1.1.1:80", "http://2.2.2.2:80", "http://3.3.3.3:80"}, MAX_PING);
+
+    QVERIFY(applyProbe(infos, makeResult("http://3.3.3.3:80", 300), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+    QVERIFY(applyProbe(infos, makeTimeout("http://1.1.1.1:80"), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+    QVERIFY(applyProbe(infos, makeResult("http://2.2.2.2:80", 100), RETIRE_COUNT_FAILS, EWMA_WEIGHT, MAX_PING));
+
+    // Проверенные по пингу, таймауты в конце
+    QCOMPARE(addressesOf(infos), std::vector<QString>({"http://2.2.2.2:80", "http://3.3.3.3:80", "http://1.1.1.1:80"}));
+}
+
+void tst_NodesList::testCountProbesForTick_data() {
+    QTest::addColumn<size_t>("probesPerMinute");
+    QTest::addColumn<size_t>("countTicks");
+    QTest::addColumn<size_t>("expectedProbes");
+
+    QTest::newRow("zero") << size_t(0) << size_t(60) << size_t(0);
+    QTest::newRow("one per minute") << size_t(1) << size_t(60) << size_t(10);
+    QTest::newRow("less than tick") << size_t(4) << size_t(6) << size_t(4);
+    QTest::newRow("default") << size_t(30) << size_t(6) << size_t(30);
+    QTest::newRow("not divisible") << size_t(7) << size_t(60) << size_t(70);
+}
+
+void tst_NodesList::testCountProbesForTick() {
+    QFETCH(size_t, probesPerMinute);
+    QFETCH(size_t, countTicks);
+    QFETCH(size_t, expectedProbes);
+
+    const milliseconds period = 10s;
+    milliseconds credit(0);
+    size_t countProbes = 0;
+    for (size_t i = 0; i < countTicks; i++) {
+        countProbes += countProbesForTick(probesPerMinute, period, credit);
+        QVERIFY(credit < milliseconds(1min));
+    }
+    QCOMPARE(countProbes, expectedProbes);
+}
+
+QTEST_MAIN(tst_NodesList)
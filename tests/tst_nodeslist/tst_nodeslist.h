@@ -0,0 +1,36 @@
+#ifndef TST_NODESLIST_H
+#define TST_NODESLIST_H
+
+#include <QObject>
+
+class tst_NodesList : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_NodesList(QObject *parent = nullptr);
+
+private slots:
+
+    void testMergeAddresses();
+
+    void testMergeAddressesKeepsState();
+
+    void testApplyProbeFirstResult();
+
+    void testApplyProbeEwma();
+
+    void testApplyProbeAfterTimeout();
+
+    void testApplyProbeRetire();
+
+    void testApplyProbeRemovedNode();
+
+    void testApplyProbeSort();
+
+    void testCountProbesForTick_data();
+
+    void testCountProbesForTick();
+
+};
+
+#endif // TST_NODESLIST_H
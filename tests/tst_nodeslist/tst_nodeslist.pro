@@ -0,0 +1,25 @@
+QT      += testlib
+QT      -= gui
+QT      += widgets
+TARGET = tst_nodeslist
+CONFIG   += testcase
+CONFIG += c++14
+CONFIG += static
+
+TEMPLATE = app
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    tst_nodeslist.cpp \
+    ../../src/NodesList.cpp
+
+
+HEADERS += \
+    tst_nodeslist.h \
+    ../../src/NodesList.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
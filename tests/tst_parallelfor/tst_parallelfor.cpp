@@ -0,0 +1,168 @@
+#include "tst_parallelfor.h"
+
+#include <QTest>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+#include "ParallelFor.h"
+
+tst_ParallelFor::tst_ParallelFor(QObject *parent)
+    : QObject(parent)
+{
+}
+
+static size_t calc(size_t i) {
+    return i * i + 7;
+}
+
+void tst_ParallelFor::testParallelFor_data() {
+    QTest::addColumn<size_t>("from");
+    QTest::addColumn<size_t>("to");
+    QTest::addColumn<size_t>("minCountPerThread");
+
+    QTest::newRow("empty") << size_t(5) << size_t(5) << size_t(1);
+    QTest::newRow("one") << size_t(0) << size_t(1) << size_t(1);
+    QTest::newRow("many") << size_t(3) << size_t(1000) << size_t(1);
+    QTest::newRow("less min count") << size_t(0) << size_t(10) << size_t(100);
+}
+
+void tst_ParallelFor::testParallelFor() {
+    QFETCH(size_t, from);
+    QFETCH(size_t, to);
+    QFETCH(size_t, minCountPerThread);
+
+    std::unique_ptr<std::atomic<size_t>[]> counts(new std::atomic<size_t>[to]);
+    std::vector<size_t> result(to, 0);
+    for (size_t i = 0; i < to; i++) {
+        counts[i] = 0;
+    }
+    parallelFor(from, to, minCountPerThread, [&](size_t i) {
+        counts[i]++;
+        result[i] = calc(i);
+    });
+    for (size_t i = 0; i < to; i++) {
+        QCOMPARE(counts[i].load(), size_t(i >= from ? 1 : 0));
+        QCOMPARE(result[i], i >= from ? calc(i) : size_t(0));
+    }
+}
+
+void tst_ParallelFor::testParallelForBlocks_data() {
+    QTest::addColumn<size_t>("from");
+    QTest::addColumn<size_t>("to");
+    QTest::addColumn<size_t>("blockSize");
+    QTest::addColumn<size_t>("countThreads");
+
+    QTest::newRow("empty") << size_t(0) << size_t(0) << size_t(200) << size_t(4);
+    QTest::newRow("one") << size_t(0) << size_t(1) << size_t(200) << size_t(4);
+    QTest::newRow("less block") << size_t(0) << size_t(199) << size_t(200) << size_t(4);
+    QTest::newRow("one block") << size_t(0) << size_t(200) << size_t(200) << size_t(4);
+    QTest::newRow("block and one") << size_t(0) << size_t(201) << size_t(200) << size_t(4);
+    QTest::newRow("small blocks") << size_t(0) << size_t(1000) << size_t(7) << size_t(4);
+    QTest::newRow("block one element") << size_t(0) << size_t(100) << size_t(1) << size_t(4);
+    QTest::newRow("from not zero") << size_t(13) << size_t(1000) << size_t(50) << size_t(3);
+    QTest::newRow("one thread") << size_t(0) << size_t(1000) << size_t(200) << size_t(1);
+    QTest::newRow("threads more elements") << size_t(0) << size_t(10) << size_t(3) << size_t(16);
+    QTest::newRow("zero block size") << size_t(0) << size_t(10) << size_t(0) << size_t(4);
+}
+
+void tst_ParallelFor::testParallelForBlocks() {
+    QFETCH(size_t, from);
+    QFETCH(size_t, to);
+    QFETCH(size_t, blockSize);
+    QFETCH(size_t, countThreads);
+
+    std::unique_ptr<std::atomic<size_t>[]> counts(new std::atomic<size_t>[to]);
+    std::vector<size_t> result(to, 0);
+    for (size_t i = 0; i < to; i++) {
+        counts[i] = 0;
+    }
+
+    std::vector<std::pair<size_t, size_t>> blocks;
+    bool isBlockReady = true;
+    parallelForBlocks(from, to, blockSize, [&](size_t i) {
+        counts[i]++;
+        result[i] = calc(i);
+    }, [&](size_t blockFrom, size_t blockTo) {
+        // Блок отдается только после того, как все его элементы посчитаны
+        for (size_t i = blockFrom; i < blockTo; i++) {
+            if (counts[i].load() != 1 || result[i] != calc(i)) {
+                isBlockReady = false;
+            }
+        }
+        blocks.emplace_back(blockFrom, blockTo);
+    }, countThreads);
+
+    QVERIFY(isBlockReady);
+    for (size_t i = 0; i < to; i++) {
+        QCOMPARE(counts[i].load(), size_t(i >= from ? 1 : 0));
+        QCOMPARE(result[i], i >= from ? calc(i) : size_t(0));
+    }
+
+    // Блоки идут по порядку, без пропусков и покрывают весь диапазон
+    const size_t expectedBlockSize = std::max(size_t(1), blockSize);
+    size_t expectedFrom = from;
+    for (const auto &block: blocks) {
+        const size_t expectedTo = std::min(expectedFrom + expectedBlockSize, to);
+        QCOMPARE(block.first, expectedFrom);
+        QCOMPARE(block.second, expectedTo);
+        expectedFrom = expectedTo;
+    }
+    QCOMPARE(expectedFrom, to);
+}
+
+void tst_ParallelFor::testParallelForBlocksException_data() {
+    QTest::addColumn<size_t>("countThreads");
+
+    QTest::newRow("one thread") << size_t(1);
+    QTest::newRow("many threads") << size_t(4);
+}
+
+void tst_ParallelFor::testParallelForBlocksException() {
+    QFETCH(size_t, countThreads);
+
+    const size_t badIndex = 450;
+    size_t lastBlockTo = 0;
+    bool isException = false;
+    try {
+        parallelForBlocks(0, 1000, 100, [&](size_t i) {
+            if (i == badIndex) {
+                throw std::runtime_error("bad index");
+            }
+        }, [&](size_t, size_t blockTo) {
+            lastBlockTo = blockTo;
+        }, countThreads);
+    } catch (const std::runtime_error &) {
+        isException = true;
+    }
+    QVERIFY(isException);
+    // Блок с ошибкой и следующие за ним не отдаются
+    QVERIFY(lastBlockTo <= badIndex);
+}
+
+void tst_ParallelFor::testParallelForBlocksCallbackException_data() {
+    QTest::addColumn<size_t>("countThreads");
+
+    QTest::newRow("one thread") << size_t(1);
+    QTest::newRow("many threads") << size_t(4);
+}
+
+void tst_ParallelFor::testParallelForBlocksCallbackException() {
+    QFETCH(size_t, countThreads);
+
+    size_t countBlocks = 0;
+    bool isException = false;
+    try {
+        parallelForBlocks(0, 1000, 10, [](size_t) {}, [&](size_t, size_t) {
+            countBlocks++;
+            throw std::runtime_error("bad block");
+        }, countThreads);
+    } catch (const std::runtime_error &) {
+        isException = true;
+    }
+    QVERIFY(isException);
+    QCOMPARE(countBlocks, size_t(1));
+}
+
+QTEST_MAIN(tst_ParallelFor)
@@ -0,0 +1,28 @@
+#ifndef TST_PARALLELFOR_H
+#define TST_PARALLELFOR_H
+
+#include <QObject>
+
+class tst_ParallelFor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_ParallelFor(QObject *parent = nullptr);
+
+private slots:
+
+    void testParallelFor_data();
+    void testParallelFor();
+
+    void testParallelForBlocks_data();
+    void testParallelForBlocks();
+
+    void testParallelForBlocksException_data();
+    void testParallelForBlocksException();
+
+    void testParallelForBlocksCallbackException_data();
+    void testParallelForBlocksCallbackException();
+
+};
+
+#endif // TST_PARALLELFOR_H
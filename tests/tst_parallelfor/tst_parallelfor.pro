@@ -0,0 +1,24 @@
+QT      += testlib
+QT      -= gui
+QT      += widgets
+TARGET = tst_parallelfor
+CONFIG   += testcase
+CONFIG += c++14
+CONFIG += static
+
+TEMPLATE = app
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    tst_parallelfor.cpp
+
+
+HEADERS += \
+    tst_parallelfor.h \
+    ../../src/ParallelFor.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)
@@ -18,6 +18,7 @@ SOURCES += \
     ../../src/utils.cpp \
     ../../src/Paths.cpp \
     ../../src/btctx/Base58.cpp \
+    ../../src/HexBase64.cpp \
     ../../src/transactions/TransactionsDBStorage.cpp
 
 
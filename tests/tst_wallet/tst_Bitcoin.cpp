@@ -4,6 +4,9 @@
 
 #include "BtcWallet.h"
 #include "btctx/wif.h"
+#include "btctx/btctx.h"
+#include "ethtx/utils2.h"
+#include "btctx/CoinSelection.h"
 
 #include "utils.h"
 #include "check.h"
@@ -359,3 +362,166 @@ void tst_Bitcoin::testHashBtc() {
     const std::string result = BtcWallet::calcHashNotWitness(transaction);
     QCOMPARE(result, answer);
 }
+
+void tst_Bitcoin::testSelectCoins_data() {
+    QTest::addColumn<QVariantList>("values");
+    QTest::addColumn<unsigned long long>("target");
+    QTest::addColumn<QVariantList>("answer");
+    QTest::addColumn<bool>("isChange");
+
+    // При 1024 сатоши за килобайт: общая часть 44, input 149, сдача 34
+    QTest::newRow("SelectCoins exact")
+        << QVariantList{100000ULL, 50000ULL, 30000ULL}
+        << 79658ULL
+        << QVariantList{1U, 2U}
+        << false;
+
+    QTest::newRow("SelectCoins exact with small excess")
+        << QVariantList{100000ULL, 50000ULL, 30000ULL}
+        << 79500ULL
+        << QVariantList{1U, 2U}
+        << false;
+
+    QTest::newRow("SelectCoins change")
+        << QVariantList{100000ULL, 50000ULL, 30000ULL}
+        << 20000ULL
+        << QVariantList{2U}
+        << true;
+
+    QTest::newRow("SelectCoins all")
+        << QVariantList{100000ULL, 50000ULL, 30000ULL, 100ULL}
+        << 179000ULL
+        << QVariantList{0U, 1U, 2U}
+        << false;
+}
+
+void tst_Bitcoin::testSelectCoins() {
+    QFETCH(QVariantList, values);
+    QFETCH(unsigned long long, target);
+    QFETCH(QVariantList, answer);
+    QFETCH(bool, isChange);
+
+    std::vector<uint64_t> vals;
+    for (const QVariant &value: values) {
+        vals.push_back(value.toULongLong());
+    }
+    const CoinSelectionParams params = makeP2pkhCoinSelectionParams(target, 1024, vals.size(), 25, true);
+    const CoinSelectionResult result = selectCoins(vals, params);
+
+    QVariantList indexes;
+    for (const size_t index: result.indexes) {
+        indexes.push_back(uint(index));
+    }
+    QCOMPARE(indexes, answer);
+    QCOMPARE(result.change != 0, isChange);
+    QCOMPARE(result.value, target + result.fee + result.change);
+    QVERIFY(result.fee >= (params.baseSize + params.inputSize * result.indexes.size() + (isChange ? params.changeOutputSize : 0)) * params.feePerKb / 1024);
+}
+
+void tst_Bitcoin::testSelectCoinsNotEnough() {
+    const std::vector<uint64_t> values = {100000, 50000, 30000};
+    const CoinSelectionParams params = makeP2pkhCoinSelectionParams(180000, 1024, values.size(), 25, true);
+    bool isException = false;
+    try {
+        selectCoins(values, params);
+    } catch (const TypedException &) {
+        isException = true;
+    }
+    QCOMPARE(isException, true);
+}
+
+void tst_Bitcoin::testSelectCoinsMinFee_data() {
+    QTest::addColumn<unsigned long long>("feePerKb");
+    QTest::addColumn<unsigned long long>("target");
+
+    QTest::newRow("low rate") << 100ULL << 150000ULL;
+    QTest::newRow("low rate without change") << 100ULL << 149578ULL;
+    QTest::newRow("1 sat per byte") << 1024ULL << 150000ULL;
+    QTest::newRow("near 1 sat per byte") << 1100ULL << 150000ULL;
+    QTest::newRow("high rate") << 20000ULL << 150000ULL;
+}
+
+void tst_Bitcoin::testSelectCoinsMinFee() {
+    QFETCH(unsigned long long, feePerKb);
+    QFETCH(unsigned long long, target);
+
+    const std::vector<uint64_t> values = {100000, 50000, 30000, 20000};
+    CoinSelectionParams params = makeP2pkhCoinSelectionParams(target, feePerKb, values.size(), 25, true);
+    const CoinSelectionResult withoutMin = selectCoins(values, params);
+    params.isMinFeeBySize = true;
+    params.minFeeOverSize = 30;
+    const CoinSelectionResult result = selectCoins(values, params);
+
+    QCOMPARE(result.value, target + result.fee + result.change);
+    const bool isChange = result.change != 0;
+    const uint64_t size = params.baseSize + params.inputSize * result.indexes.size() + (isChange ? params.changeOutputSize : 0);
+    QVERIFY(result.fee >= size + 30);
+    if (isChange) {
+        // Комиссия ровно как в BtcWallet::buildTransaction: по ставке, но не меньше размера + 30
+        const auto calcFee = [feePerKb](uint64_t partSize) {
+            return (feePerKb * partSize + 1023) / 1024;
+        };
+        const uint64_t feeByRate = calcFee(params.baseSize) + calcFee(params.inputSize) * result.indexes.size() + calcFee(params.changeOutputSize);
+        QCOMPARE(result.fee, std::max(feeByRate, size + 30));
+    }
+    if (withoutMin.indexes == result.indexes && withoutMin.fee >= size + 30) {
+        // Когда минимум не срабатывает, комиссия не меняется
+        QCOMPARE(result.fee, withoutMin.fee);
+        QCOMPARE(result.change, withoutMin.change);
+    }
+}
+
+static std::vector<Input> makeInputs(size_t count) {
+    std::vector<Input> inputs;
+    for (size_t i = 0; i < count; i++) {
+        Input input;
+        input.wif = "cUzkK2uj56xSuwY2Ha9TMjKgwPr1uBwNKXbSB3eGbcSbZ77YwQRG";
+        input.spendtxid = HexStringToDump(QString("%1").arg(i + 1, 64, 16, QChar('0')).toStdString());
+        input.spendoutnum = i % 3;
+        input.scriptPubkey = HexStringToDump("76a9145e05738474a2d065b554bd8564857e166031570688ac");
+        input.outBalance = 1000000;
+        inputs.push_back(input);
+    }
+    return inputs;
+}
+
+static void benchmarkBitcoinTransaction(size_t countInputs) {
+    const std::vector<Input> inputs = makeInputs(countInputs);
+    const uint64_t transferAmount = countInputs * 1000000 - 20000;
+
+    std::string tx;
+    QBENCHMARK {
+        tx = BuildBTCTransaction(inputs, 10000, transferAmount, "mkDQ29a4WtweYxagdhwuTx8P6BtsTnkJwi", true);
+    }
+    // Подпись детерминированная, поэтому параллельная сборка должна совпасть с последовательной
+    const std::string reference = BuildBTCTransaction(inputs, 10000, transferAmount, "mkDQ29a4WtweYxagdhwuTx8P6BtsTnkJwi", true, false);
+    QCOMPARE(toHex(tx), toHex(reference));
+}
+
+void tst_Bitcoin::benchmarkBitcoinTransaction4Inputs() {
+    benchmarkBitcoinTransaction(4);
+}
+
+void tst_Bitcoin::benchmarkBitcoinTransaction10Inputs() {
+    benchmarkBitcoinTransaction(10);
+}
+
+void tst_Bitcoin::benchmarkBitcoinTransaction500Inputs() {
+    benchmarkBitcoinTransaction(500);
+}
+
+void tst_Bitcoin::benchmarkSelectCoins10k() {
+    std::vector<uint64_t> values;
+    uint64_t value = 1;
+    for (size_t i = 0; i < 10000; i++) {
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        values.push_back(10000 + (value >> 33) % 5000000);
+    }
+    const CoinSelectionParams params = makeP2pkhCoinSelectionParams(123456789ULL, 20000, values.size(), 25, true);
+
+    CoinSelectionResult result;
+    QBENCHMARK {
+        result = selectCoins(values, params);
+    }
+    QCOMPARE(result.value, params.target + result.fee + result.change);
+}
@@ -32,6 +32,20 @@ private slots:
     void testNotCreateBtcTransaction2_data();
     void testNotCreateBtcTransaction2();
 
+    void testSelectCoins_data();
+    void testSelectCoins();
+
+    void testSelectCoinsNotEnough();
+
+    void testSelectCoinsMinFee_data();
+    void testSelectCoinsMinFee();
+
+    void benchmarkBitcoinTransaction4Inputs();
+    void benchmarkBitcoinTransaction10Inputs();
+    void benchmarkBitcoinTransaction500Inputs();
+
+    void benchmarkSelectCoins10k();
+
 };
 
 #endif // TST_BITCOIN_H
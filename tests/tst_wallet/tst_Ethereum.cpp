@@ -4,6 +4,7 @@
 
 #include "EthWallet.h"
 #include "btctx/wif.h"
+#include "ethtx/scrypt/libscrypt.h"
 
 #include "utils.h"
 #include "check.h"
@@ -33,9 +34,11 @@ void tst_Ethereum::testCreateEth() {
     EthWallet wallet("./", address, passwd);
 }
 
+const static std::string ETH_KEYSTORE = "{\"address\": \"05cf594f12bba9430e34060498860abc69554cb1\",\"crypto\": {\"cipher\": \"aes-128-ctr\",\"ciphertext\": \"694283a4a2f3da99186e2321c24cf1b427d81a273e7bc5c5a54ab624c8930fb8\",\"cipherparams\": {\"iv\": \"5913da2f0f6cd00b9b62ff2bc0a8b9d3\"},\"kdf\": \"scrypt\",\"kdfparams\": {\"dklen\": 32,\"n\": 262144,\"p\": 1,\"r\": 8,\"salt\": \"ca45d433267bd6a50ace149d6b317b9d8f8a39f43621bad2a3108981bf533ee7\"},\"mac\": \"0a8d581e8c60553970301603ea35b0fc56cbccd5913b12f62c690acb98d111c8\"},\"id\": \"6406896a-2ec9-4dd7-b98e-5fbfc0984e6f\",\"version\": 3}";
+
 void tst_Ethereum::testEthWalletTransaction()
 {
-    writeToFile("./0x05cf594f12bba9430e34060498860abc69554cb1", "{\"address\": \"05cf594f12bba9430e34060498860abc69554cb1\",\"crypto\": {\"cipher\": \"aes-128-ctr\",\"ciphertext\": \"694283a4a2f3da99186e2321c24cf1b427d81a273e7bc5c5a54ab624c8930fb8\",\"cipherparams\": {\"iv\": \"5913da2f0f6cd00b9b62ff2bc0a8b9d3\"},\"kdf\": \"scrypt\",\"kdfparams\": {\"dklen\": 32,\"n\": 262144,\"p\": 1,\"r\": 8,\"salt\": \"ca45d433267bd6a50ace149d6b317b9d8f8a39f43621bad2a3108981bf533ee7\"},\"mac\": \"0a8d581e8c60553970301603ea35b0fc56cbccd5913b12f62c690acb98d111c8\"},\"id\": \"6406896a-2ec9-4dd7-b98e-5fbfc0984e6f\",\"version\": 3}", false);
+    writeToFile("./0x05cf594f12bba9430e34060498860abc69554cb1", ETH_KEYSTORE, false);
     const std::string password = "1";
     EthWallet wallet("./", "0x05cf594f12bba9430e34060498860abc69554cb1", password);
     const std::string result = wallet.SignTransaction(
@@ -129,3 +132,44 @@ void tst_Ethereum::testHashEth() {
     const std::string result = EthWallet::calcHash(transaction);
     QCOMPARE(result, answer);
 }
+
+void tst_Ethereum::testScrypt_data() {
+    QTest::addColumn<std::string>("password");
+    QTest::addColumn<std::string>("salt");
+    QTest::addColumn<unsigned long long>("n");
+    QTest::addColumn<unsigned int>("r");
+    QTest::addColumn<unsigned int>("p");
+    QTest::addColumn<std::string>("answer");
+
+    // RFC 7914
+    QTest::newRow("Scrypt 1")
+        << std::string("") << std::string("") << 16ULL << 1U << 1U
+        << std::string("77d6576238657b203b19ca42c18a0497f16b4844e3074ae8dfdffa3fede21442fcd0069ded0948f8326a753a0fc81f17e8d3e0fb2e0d3628cf35e20c38d18906");
+    QTest::newRow("Scrypt 2")
+        << std::string("password") << std::string("NaCl") << 1024ULL << 8U << 16U
+        << std::string("fdbabe1c9d3472007856e7190d01e9fe7c6ad7cbc8237830e77376634b3731622eaf30d92e22a3886ff109279d9830dac727afb94a83ee6d8360cbdfa2cc0640");
+    QTest::newRow("Scrypt 3")
+        << std::string("pleaseletmein") << std::string("SodiumChloride") << 16384ULL << 8U << 1U
+        << std::string("7023bdcb3afd7348461c06cd81fd38ebfda8fbba904f8e3ea9b543f6545da1f2d5432955613f0fcf62d49705242a9af9e61e85dc0d651e40dfcf017b45575887");
+}
+
+void tst_Ethereum::testScrypt() {
+    QFETCH(std::string, password);
+    QFETCH(std::string, salt);
+    QFETCH(unsigned long long, n);
+    QFETCH(unsigned int, r);
+    QFETCH(unsigned int, p);
+    QFETCH(std::string, answer);
+
+    std::string result(64, 0);
+    const int res = libscrypt_scrypt((const uint8_t*)password.data(), password.size(), (const uint8_t*)salt.data(), salt.size(), n, r, p, (uint8_t*)&result[0], result.size());
+    QCOMPARE(res, 0);
+    QCOMPARE(toHex(result), answer);
+}
+
+void tst_Ethereum::benchmarkUnlockEth() {
+    writeToFile("./0x05cf594f12bba9430e34060498860abc69554cb1", ETH_KEYSTORE, false);
+    QBENCHMARK {
+        EthWallet wallet("./", "0x05cf594f12bba9430e34060498860abc69554cb1", "1");
+    }
+}
@@ -21,6 +21,11 @@ private slots:
     void testNotCreateEthTransaction_data();
     void testNotCreateEthTransaction();
 
+    void testScrypt_data();
+    void testScrypt();
+
+    void benchmarkUnlockEth();
+
 };
 
 #endif // TST_ETHEREUM_H
@@ -0,0 +1,282 @@
+#include "tst_HexBase64.h"
+
+#include <QTest>
+#include <QDebug>
+#include <QByteArray>
+
+#include "HexBase64.h"
+
+Q_DECLARE_METATYPE(std::string)
+
+// Длины покрывают векторные блоки всех размеров и хвосты после них
+const static size_t MAX_TEST_SIZE = 300;
+
+tst_HexBase64::tst_HexBase64(QObject *parent)
+    : QObject(parent)
+{
+}
+
+static std::string makeData(size_t size) {
+    std::string result(size, 0);
+    for (size_t i = 0; i < size; i++) {
+        result[i] = char(i * 131 + 7);
+    }
+    return result;
+}
+
+static std::string toStdString(const QByteArray &array) {
+    return std::string(array.constData(), array.size());
+}
+
+static QByteArray toByteArray(const std::string &str) {
+    return QByteArray(str.data(), (int)str.size());
+}
+
+static std::string toHexNew(const std::string &data) {
+    std::string result;
+    appendToHex(data.data(), data.size(), result);
+    return result;
+}
+
+static std::string fromHexNew(const std::string &hex) {
+    std::string result;
+    appendFromHex(hex.data(), hex.size(), result);
+    return result;
+}
+
+static std::string toBase64New(const std::string &data) {
+    std::string result;
+    appendToBase64(data.data(), data.size(), result);
+    return result;
+}
+
+static std::string fromBase64New(const std::string &base64) {
+    std::string result;
+    appendFromBase64(base64.data(), base64.size(), result);
+    return result;
+}
+
+void tst_HexBase64::testHex() {
+    for (size_t size = 0; size <= MAX_TEST_SIZE; size++) {
+        const std::string data = makeData(size);
+        const std::string hex = toHexNew(data);
+        QCOMPARE(hex, toStdString(toByteArray(data).toHex()));
+        QCOMPARE(fromHexNew(hex), data);
+        QCOMPARE(fromHexNew(toStdString(toByteArray(hex).toUpper())), data);
+    }
+}
+
+void tst_HexBase64::testFromHexIncorrect_data() {
+    QTest::addColumn<std::string>("hex");
+    QTest::addColumn<bool>("isStrictCorrect");
+
+    const std::string hex = toHexNew(makeData(100));
+    QTest::newRow("odd") << hex.substr(1) << true;
+    QTest::newRow("prefix") << "0x" + hex << false;
+    QTest::newRow("spaces") << hex.substr(0, 70) + " \n" + hex.substr(70) << false;
+    QTest::newRow("incorrect symbol") << hex.substr(0, 101) + "g" + hex.substr(102) << false;
+    QTest::newRow("incorrect symbol in tail") << hex.substr(0, 199) + "z" << false;
+    QTest::newRow("not ascii") << hex.substr(0, 40) + "\xd0\xbf" + hex.substr(40) << false;
+}
+
+void tst_HexBase64::testFromHexIncorrect() {
+    QFETCH(std::string, hex);
+    QFETCH(bool, isStrictCorrect);
+
+    QCOMPARE(fromHexNew(hex), toStdString(QByteArray::fromHex(toByteArray(hex))));
+
+    std::string result = "prefix";
+    QCOMPARE(appendFromHexStrict(hex.data(), hex.size(), result), isStrictCorrect);
+    if (!isStrictCorrect) {
+        QCOMPARE(result, std::string("prefix"));
+    }
+}
+
+void tst_HexBase64::testFromHexStrict() {
+    for (size_t size = 0; size <= MAX_TEST_SIZE; size++) {
+        const std::string data = makeData(size);
+        const std::string hex = toHexNew(data);
+        std::string result;
+        QCOMPARE(appendFromHexStrict(hex.data(), hex.size(), result), true);
+        QCOMPARE(result, data);
+    }
+
+    std::string result;
+    QCOMPARE(appendFromHexStrict("abc", 3, result), true);
+    QCOMPARE(result, std::string("\x0a\xbc"));
+}
+
+void tst_HexBase64::testBase64() {
+    for (size_t size = 0; size <= MAX_TEST_SIZE; size++) {
+        const std::string data = makeData(size);
+        const std::string base64 = toBase64New(data);
+        QCOMPARE(base64, toStdString(toByteArray(data).toBase64()));
+        QCOMPARE(fromBase64New(base64), data);
+    }
+}
+
+void tst_HexBase64::testFromBase64Incorrect_data() {
+    QTest::addColumn<std::string>("base64");
+
+    const std::string base64 = toBase64New(makeData(100));
+    QTest::newRow("without padding") << base64.substr(0, base64.size() - 2);
+    QTest::newRow("line breaks") << base64.substr(0, 76) + "\r\n" + base64.substr(76);
+    QTest::newRow("padding in middle") << base64.substr(0, 50) + "==" + base64.substr(50);
+    QTest::newRow("url alphabet") << base64.substr(0, 33) + "-_" + base64.substr(35);
+    QTest::newRow("not ascii") << base64.substr(0, 40) + "\xff" + base64.substr(40);
+    QTest::newRow("truncated") << base64.substr(0, 101);
+}
+
+void tst_HexBase64::testFromBase64Incorrect() {
+    QFETCH(std::string, base64);
+
+    QCOMPARE(fromBase64New(base64), toStdString(QByteArray::fromBase64(toByteArray(base64))));
+}
+
+void tst_HexBase64::testAppend() {
+    const std::string data = makeData(50);
+
+    std::string result = "0x";
+    appendToHex(data.data(), data.size(), result);
+    QCOMPARE(result, "0x" + toHexNew(data));
+
+    std::string decoded = data;
+    appendFromHex(result.data() + 2, result.size() - 2, decoded);
+    QCOMPARE(decoded, data + data);
+
+    std::string base64 = "b64:";
+    appendToBase64(data.data(), data.size(), base64);
+    QCOMPARE(base64, "b64:" + toBase64New(data));
+
+    decoded = data;
+    appendFromBase64(base64.data() + 4, base64.size() - 4, decoded);
+    QCOMPARE(decoded, data + data);
+}
+
+static void addBenchmarkSizes() {
+    QTest::addColumn<size_t>("size");
+
+    QTest::newRow("1KB") << size_t(1024);
+    QTest::newRow("1MB") << size_t(1024 * 1024);
+}
+
+void tst_HexBase64::benchmarkToHexQt_data() {
+    addBenchmarkSizes();
+}
+
+void tst_HexBase64::benchmarkToHexQt() {
+    QFETCH(size_t, size);
+    const std::string data = makeData(size);
+
+    std::string result;
+    QBENCHMARK {
+        result = QString(QByteArray(data.data(), (int)data.size()).toHex()).toStdString();
+    }
+    QCOMPARE(result.size(), size * 2);
+}
+
+void tst_HexBase64::benchmarkToHex_data() {
+    addBenchmarkSizes();
+}
+
+void tst_HexBase64::benchmarkToHex() {
+    qDebug() << "Accelerated:" << isHexBase64Accelerated();
+    QFETCH(size_t, size);
+    const std::string data = makeData(size);
+
+    std::string result;
+    QBENCHMARK {
+        result = toHexNew(data);
+    }
+    QCOMPARE(result.size(), size * 2);
+}
+
+void tst_HexBase64::benchmarkFromHexQt_data() {
+    addBenchmarkSizes();
+}
+
+void tst_HexBase64::benchmarkFromHexQt() {
+    QFETCH(size_t, size);
+    const std::string hex = toHexNew(makeData(size));
+
+    std::string result;
+    QBENCHMARK {
+        result = QByteArray::fromHex(QByteArray(hex.data(), (int)hex.size())).toStdString();
+    }
+    QCOMPARE(result.size(), size);
+}
+
+void tst_HexBase64::benchmarkFromHex_data() {
+    addBenchmarkSizes();
+}
+
+void tst_HexBase64::benchmarkFromHex() {
+    QFETCH(size_t, size);
+    const std::string hex = toHexNew(makeData(size));
+
+    std::string result;
+    QBENCHMARK {
+        result = fromHexNew(hex);
+    }
+    QCOMPARE(result.size(), size);
+}
+
+void tst_HexBase64::benchmarkToBase64Qt_data() {
+    addBenchmarkSizes();
+}
+
+void tst_HexBase64::benchmarkToBase64Qt() {
+    QFETCH(size_t, size);
+    const std::string data = makeData(size);
+
+    std::string result;
+    QBENCHMARK {
+        result = QString(QByteArray(data.data(), (int)data.size()).toBase64()).toStdString();
+    }
+    QCOMPARE(result.size(), (size + 2) / 3 * 4);
+}
+
+void tst_HexBase64::benchmarkToBase64_data() {
+    addBenchmarkSizes();
+}
+
+void tst_HexBase64::benchmarkToBase64() {
+    QFETCH(size_t, size);
+    const std::string data = makeData(size);
+
+    std::string result;
+    QBENCHMARK {
+        result = toBase64New(data);
+    }
+    QCOMPARE(result.size(), (size + 2) / 3 * 4);
+}
+
+void tst_HexBase64::benchmarkFromBase64Qt_data() {
+    addBenchmarkSizes();
+}
+
+void tst_HexBase64::benchmarkFromBase64Qt() {
+    QFETCH(size_t, size);
+    const std::string base64 = toBase64New(makeData(size));
+
+    std::string result;
+    QBENCHMARK {
+        result = QByteArray::fromBase64(QByteArray(base64.data(), (int)base64.size())).toStdString();
+    }
+    QCOMPARE(result.size(), size);
+}
+
+void tst_HexBase64::benchmarkFromBase64_data() {
+    addBenchmarkSizes();
+}
+
+void tst_HexBase64::benchmarkFromBase64() {
+    QFETCH(size_t, size);
+    const std::string base64 = toBase64New(makeData(size));
+
+    std::string result;
+    QBENCHMARK {
+        result = fromBase64New(base64);
+    }
+    QCOMPARE(result.size(), size);
+}
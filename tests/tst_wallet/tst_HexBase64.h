@@ -0,0 +1,49 @@
+#ifndef TST_HEXBASE64_H
+#define TST_HEXBASE64_H
+
+#include <QObject>
+
+class tst_HexBase64 : public QObject {
+    Q_OBJECT
+public:
+    explicit tst_HexBase64(QObject *parent = nullptr);
+
+private slots:
+
+    void testHex();
+
+    void testFromHexIncorrect_data();
+    void testFromHexIncorrect();
+
+    void testFromHexStrict();
+
+    void testBase64();
+
+    void testFromBase64Incorrect_data();
+    void testFromBase64Incorrect();
+
+    void testAppend();
+
+    void benchmarkToHexQt_data();
+    void benchmarkToHexQt();
+    void benchmarkToHex_data();
+    void benchmarkToHex();
+
+    void benchmarkFromHexQt_data();
+    void benchmarkFromHexQt();
+    void benchmarkFromHex_data();
+    void benchmarkFromHex();
+
+    void benchmarkToBase64Qt_data();
+    void benchmarkToBase64Qt();
+    void benchmarkToBase64_data();
+    void benchmarkToBase64();
+
+    void benchmarkFromBase64Qt_data();
+    void benchmarkFromBase64Qt();
+    void benchmarkFromBase64_data();
+    void benchmarkFromBase64();
+
+};
+
+#endif // TST_HEXBASE64_H
@@ -1,8 +1,14 @@
 #include "tst_Metahash.h"
 
 #include <QTest>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <cryptopp/osrng.h>
+#include <cryptopp/hex.h>
 
 #include "Wallet.h"
+#include "BatchTransactions.h"
 
 #include "utils.h"
 #include "check.h"
@@ -11,6 +17,52 @@
 
 Q_DECLARE_METATYPE(std::string)
 
+using PrivateKey = CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PrivateKey;
+
+const static std::string RAW_KEY_K1 = "0x30740201010420d2e5d982ec5c0cf1b57aba2f63ba4f3ebf860b87c7cb9f0b5f48af472c886d28a00706052b8104000aa14403420004eae4f2efbd24da2328e4aa30df67893b3ba7ca5ef11d7c2c63e3aa4f56a68e132d0521f4591a9ceb6d4703446724c70d6d07a82552448d694730184b81dccbdf";
+const static std::string RAW_KEY_R1 = "0x307702010104201cfb36c121f0161295dc0cd721eb62151f0255bb471bd0c15d11628e3687da68a00a06082a8648ce3d030107a144034200044a9f9bb95b0e9229ef152a8ac12209f069c8e0f79c4de9cdcbffd175ffb636b1466a364bfeed15abc5e29449bb90f0574fc76c57650dd07f7c39f3948a7c1f3f";
+
+static PrivateKey loadRawPrivateKey(const std::string &rawPrivateHex) {
+    PrivateKey privateKey;
+    const std::string rawPrivkey = fromHex(rawPrivateHex.substr(2));
+    CryptoPP::StringSource ss(rawPrivkey, true);
+    privateKey.BERDecodePrivateKey(ss, true, rawPrivkey.size());
+    return privateKey;
+}
+
+// Подпись так, как она делалась раньше для всех ключей
+static std::string signCryptoPP(const PrivateKey &privateKey, const std::string &message) {
+    CryptoPP::AutoSeededRandomPool prng;
+    CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::Signer signer(privateKey);
+
+    std::string signature(signer.MaxSignatureLength(), 0x00);
+    const size_t siglen = signer.SignMessage(prng, (const byte*)message.data(), message.size(), (byte*)signature.data());
+    signature.resize(siglen);
+
+    std::string signature2(signature.size() * 10, 0);
+    const size_t resultSize = CryptoPP::DSAConvertSignatureFormat(
+        (byte*)signature2.data(), signature2.size(), CryptoPP::DSASignatureFormat::DSA_DER,
+        (const byte*)signature.data(), signature.size(), CryptoPP::DSASignatureFormat::DSA_P1363
+    );
+    signature2.resize(resultSize);
+    return toHex(signature2);
+}
+
+static bool verifyCryptoPP(const PrivateKey &privateKey, const std::string &message, const std::string &signature) {
+    CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PublicKey publicKey;
+    privateKey.MakePublicKey(publicKey);
+    CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::Verifier verifier(publicKey);
+
+    const std::string signatureBinary = fromHex(signature);
+    std::string signature2(64, 0);
+    const size_t resultSize = CryptoPP::DSAConvertSignatureFormat(
+        (byte*)signature2.data(), signature2.size(), CryptoPP::DSASignatureFormat::DSA_P1363,
+        (const byte*)signatureBinary.data(), signatureBinary.size(), CryptoPP::DSASignatureFormat::DSA_DER
+    );
+    signature2.resize(resultSize);
+    return verifier.VerifyMessage((const byte*)message.data(), message.size(), (const byte*)signature2.data(), signature2.size());
+}
+
 tst_Metahash::tst_Metahash(QObject *parent) : QObject(parent) {
     if (!isInitOpenSSL()) {
         InitOpenSSL();
@@ -207,6 +259,63 @@ void tst_Metahash::testMthSignTransaction() {
     QCOMPARE(res2, false);
 }
 
+void tst_Metahash::testMthSignCompatibility_data() {
+    QTest::addColumn<std::string>("rawkey");
+
+    QTest::newRow("MthSignCompatibility k1") << RAW_KEY_K1;
+    QTest::newRow("MthSignCompatibility r1") << RAW_KEY_R1;
+}
+
+void tst_Metahash::testMthSignCompatibility() {
+    QFETCH(std::string, rawkey);
+    std::string tmp;
+    std::string address;
+    Wallet::createWalletFromRaw("./", rawkey, "123", tmp, address);
+    Wallet wallet("./", address, "123");
+    const PrivateKey privateKey = loadRawPrivateKey(rawkey);
+
+    for (int i = 0; i < 20; i++) {
+        const std::string message = "message " + std::to_string(i);
+
+        std::string pubkey;
+        const std::string signature = wallet.sign(message, pubkey);
+        QCOMPARE(pubkey, tmp);
+        QCOMPARE(verifyCryptoPP(privateKey, message, signature), true);
+
+        // Подписи CryptoPP могут быть с high-S, они тоже должны проверяться
+        const std::string signature2 = signCryptoPP(privateKey, message);
+        QCOMPARE(Wallet::verify(message, signature2, pubkey), true);
+        QCOMPARE(Wallet::verify(message, signature2, toLower(pubkey)), true);
+        QCOMPARE(Wallet::verify(message + "1", signature2, pubkey), false);
+    }
+}
+
+void tst_Metahash::benchmarkMthSignCryptoPP() {
+    const PrivateKey privateKey = loadRawPrivateKey(RAW_KEY_K1);
+    const std::string message = Wallet::genTx("0x009806da73b1589f38630649bdee48467946d118059efd6aab", 126894, 55647, 255, "", true);
+
+    std::string signature;
+    QBENCHMARK {
+        signature = signCryptoPP(privateKey, message);
+    }
+    QCOMPARE(verifyCryptoPP(privateKey, message, signature), true);
+}
+
+void tst_Metahash::benchmarkMthSignSecp256k1() {
+    std::string tmp;
+    std::string address;
+    Wallet::createWalletFromRaw("./", RAW_KEY_K1, "123", tmp, address);
+    Wallet wallet("./", address, "123");
+    const std::string message = Wallet::genTx("0x009806da73b1589f38630649bdee48467946d118059efd6aab", 126894, 55647, 255, "", true);
+
+    std::string signature;
+    std::string pubkey;
+    QBENCHMARK {
+        signature = wallet.sign(message, pubkey);
+    }
+    QCOMPARE(Wallet::verify(message, signature, pubkey), true);
+}
+
 void tst_Metahash::testHashMth_data() {
     QTest::addColumn<std::string>("transaction");
     QTest::addColumn<std::string>("answer");
@@ -284,3 +393,93 @@ void tst_Metahash::testCreateV8Address() {
     const std::string result = Wallet::createV8Address(address, nonce);
     QCOMPARE(result, answer);
 }
+
+void tst_Metahash::testParseBatchTransactions() {
+    const std::vector<BatchTransaction> result = parseBatchTransactions(
+        "[{\"to\": \"0x01\", \"value\": \"100\", \"fee\": \"7\", \"nonce\": \"5\", \"data\": \"abcd\"},"
+        " {\"to\": \"0x02\", \"value\": \"18446744073709551615\", \"nonce\": \"6\"},"
+        " {\"to\": \"0x03\", \"value\": \"0\", \"fee\": \"\", \"nonce\": \"7\"}]"
+    );
+    QCOMPARE(result.size(), size_t(3));
+    QCOMPARE(result[0].toAddress, std::string("0x01"));
+    QCOMPARE(result[0].value, uint64_t(100));
+    QCOMPARE(result[0].fee, uint64_t(7));
+    QCOMPARE(result[0].nonce, uint64_t(5));
+    QCOMPARE(result[0].dataHex, std::string("abcd"));
+    QCOMPARE(result[1].toAddress, std::string("0x02"));
+    QCOMPARE(result[1].value, uint64_t(18446744073709551615ULL));
+    QCOMPARE(result[1].fee, uint64_t(0));
+    QCOMPARE(result[1].dataHex, std::string(""));
+    QCOMPARE(result[2].fee, uint64_t(0));
+    QCOMPARE(result[2].nonce, uint64_t(7));
+
+    QCOMPARE(parseBatchTransactions("[]").size(), size_t(0));
+}
+
+void tst_Metahash::testNotParseBatchTransactions_data() {
+    QTest::addColumn<QString>("json");
+
+    QTest::newRow("not json") << QString("[{\"to\": ");
+    QTest::newRow("not array") << QString("{\"to\": \"0x01\", \"value\": \"1\", \"nonce\": \"1\"}");
+    QTest::newRow("not object") << QString("[\"0x01\"]");
+    QTest::newRow("without to") << QString("[{\"value\": \"1\", \"nonce\": \"1\"}]");
+    QTest::newRow("to not string") << QString("[{\"to\": 1, \"value\": \"1\", \"nonce\": \"1\"}]");
+    QTest::newRow("without value") << QString("[{\"to\": \"0x01\", \"nonce\": \"1\"}]");
+    QTest::newRow("value number") << QString("[{\"to\": \"0x01\", \"value\": 1, \"nonce\": \"1\"}]");
+    QTest::newRow("value overflow") << QString("[{\"to\": \"0x01\", \"value\": \"18446744073709551616\", \"nonce\": \"1\"}]");
+    QTest::newRow("fee incorrect") << QString("[{\"to\": \"0x01\", \"value\": \"1\", \"fee\": \"1a\", \"nonce\": \"1\"}]");
+    QTest::newRow("without nonce") << QString("[{\"to\": \"0x01\", \"value\": \"1\"}]");
+    QTest::newRow("data not string") << QString("[{\"to\": \"0x01\", \"value\": \"1\", \"nonce\": \"1\", \"data\": 5}]");
+    QTest::newRow("second incorrect") << QString("[{\"to\": \"0x01\", \"value\": \"1\", \"nonce\": \"1\"}, {\"to\": \"0x01\", \"value\": \"1\"}]");
+}
+
+void tst_Metahash::testNotParseBatchTransactions() {
+    QFETCH(QString, json);
+
+    QVERIFY_EXCEPTION_THROWN(parseBatchTransactions(json), TypedException);
+}
+
+void tst_Metahash::testSignBatchTransactions() {
+    std::string tmp;
+    std::string address;
+    Wallet::createWalletFromRaw("./", RAW_KEY_K1, "123", tmp, address);
+    Wallet wallet("./", address, "123");
+
+    // Больше транзакций, чем нужно одному потоку, чтобы подпись шла параллельно
+    std::vector<BatchTransaction> transactions;
+    for (size_t i = 0; i < 50; i++) {
+        BatchTransaction tx;
+        tx.toAddress = "0x009806da73b1589f38630649bdee48467946d118059efd6aab";
+        tx.value = 126894 + i;
+        tx.fee = i % 3;
+        tx.nonce = i;
+        tx.dataHex = i % 2 == 0 ? "" : toHex(std::to_string(i));
+        transactions.push_back(tx);
+    }
+
+    const std::vector<BatchSignature> signatures = signBatchTransactions(wallet, transactions);
+    QCOMPARE(signatures.size(), transactions.size());
+
+    const QJsonArray json = makeJsonBatchSignatures(signatures).array();
+    QCOMPARE(size_t(json.size()), transactions.size());
+
+    for (size_t i = 0; i < transactions.size(); i++) {
+        const BatchTransaction &tx = transactions[i];
+        std::string txHex;
+        std::string signature;
+        std::string publicKey;
+        wallet.sign(tx.toAddress, tx.value, tx.fee, tx.nonce, tx.dataHex, txHex, signature, publicKey);
+
+        // Подпись k1 ключом детерминированная, поэтому совпадает с одиночной подписью
+        QCOMPARE(signatures[i].tx, txHex);
+        QCOMPARE(signatures[i].signature, signature);
+        QCOMPARE(signatures[i].publicKey, publicKey);
+
+        const QJsonObject obj = json[int(i)].toObject();
+        QCOMPARE(obj.value("tx").toString().toStdString(), txHex);
+        QCOMPARE(obj.value("signature").toString().toStdString(), signature);
+        QCOMPARE(obj.value("publicKey").toString().toStdString(), publicKey);
+    }
+
+    QCOMPARE(signBatchTransactions(wallet, {}).size(), size_t(0));
+}
@@ -31,12 +31,25 @@ private slots:
     void testMthSignTransaction_data();
     void testMthSignTransaction();
 
+    void testMthSignCompatibility_data();
+    void testMthSignCompatibility();
+
+    void benchmarkMthSignCryptoPP();
+    void benchmarkMthSignSecp256k1();
+
     void testHashMth_data();
     void testHashMth();
 
     void testCreateV8Address_data();
     void testCreateV8Address();
 
+    void testParseBatchTransactions();
+
+    void testNotParseBatchTransactions_data();
+    void testNotParseBatchTransactions();
+
+    void testSignBatchTransactions();
+
 };
 
 #endif // TST_METAHASH_H
@@ -0,0 +1,205 @@
+#include "tst_Sha256Hasher.h"
+
+#include <QTest>
+
+#include <functional>
+#include <cstring>
+
+#include <cryptopp/sha.h>
+
+#include "Sha256Hasher.h"
+
+#include "utils.h"
+
+Q_DECLARE_METATYPE(std::string)
+
+// Публичный ключ, от которого считается адрес
+const static size_t SHORT_MESSAGE_SIZE = 65;
+
+const static size_t LONG_MESSAGE_SIZE = 16 * 1024 * 1024;
+
+tst_Sha256Hasher::tst_Sha256Hasher(QObject *parent)
+    : QObject(parent)
+{
+}
+
+static std::string makeMessage(size_t size) {
+    std::string result(size, 0);
+    for (size_t i = 0; i < size; i++) {
+        result[i] = char(i * 131 + 7);
+    }
+    return result;
+}
+
+using CompressFunc = std::function<void(uint32_t *state, const uint8_t *blocks, size_t countBlocks)>;
+
+// Хэш с явно заданной функцией сжатия, чтобы проверить каждую реализацию, а не только выбранную процессором
+static std::string hashWithCompress(const std::string &message, const CompressFunc &compress) {
+    uint32_t state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    std::string padded = message;
+    padded.push_back(char(0x80));
+    while (padded.size() % Sha256Hasher::BLOCK_SIZE != Sha256Hasher::BLOCK_SIZE - 8) {
+        padded.push_back(0);
+    }
+    const uint64_t bitSize = uint64_t(message.size()) * 8;
+    for (int i = 7; i >= 0; i--) {
+        padded.push_back(char(bitSize >> (i * 8)));
+    }
+
+    compress(state, (const uint8_t*)padded.data(), padded.size() / Sha256Hasher::BLOCK_SIZE);
+
+    std::string result;
+    for (const uint32_t word: state) {
+        for (int i = 3; i >= 0; i--) {
+            result.push_back(char(word >> (i * 8)));
+        }
+    }
+    return result;
+}
+
+static bool isShaNiSupported() {
+    uint32_t state[8] = {};
+    const uint8_t block[Sha256Hasher::BLOCK_SIZE] = {};
+    return Sha256Hasher::compressShaNi(state, block, 1);
+}
+
+static std::string sha256CryptoPP(const std::string &message) {
+    std::string hash(CryptoPP::SHA256::DIGESTSIZE, 0);
+    CryptoPP::SHA256().CalculateDigest((byte*)&hash[0], (const byte*)message.data(), message.size());
+    return hash;
+}
+
+void tst_Sha256Hasher::testHash_data() {
+    QTest::addColumn<std::string>("message");
+    QTest::addColumn<std::string>("hash");
+
+    QTest::newRow("empty")
+        << std::string("")
+        << std::string("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    QTest::newRow("abc")
+        << std::string("abc")
+        << std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    QTest::newRow("two blocks")
+        << std::string("abcdbcdecdefdefgefghfghighijhijkijkljklmjklmnklmnomnopnopq")
+        << std::string("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    QTest::newRow("million a")
+        << std::string(1000000, 'a')
+        << std::string("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+void tst_Sha256Hasher::testHash() {
+    QFETCH(std::string, message);
+    QFETCH(std::string, hash);
+
+    QCOMPARE(toHex(Sha256Hasher::hash(message)), hash);
+
+    Sha256Hasher hasher;
+    for (size_t i = 0; i < message.size(); i += 7) {
+        hasher.update(message.substr(i, 7));
+    }
+    uint8_t digest[Sha256Hasher::DIGEST_SIZE];
+    hasher.finish(digest);
+    QCOMPARE(toHex(std::string((const char*)digest, sizeof(digest))), hash);
+}
+
+void tst_Sha256Hasher::testCompressPortable_data() {
+    testHash_data();
+}
+
+void tst_Sha256Hasher::testCompressPortable() {
+    QFETCH(std::string, message);
+    QFETCH(std::string, hash);
+
+    QCOMPARE(toHex(hashWithCompress(message, &Sha256Hasher::compressPortable)), hash);
+}
+
+void tst_Sha256Hasher::testCompressShaNi_data() {
+    testHash_data();
+}
+
+void tst_Sha256Hasher::testCompressShaNi() {
+    QFETCH(std::string, message);
+    QFETCH(std::string, hash);
+
+    if (!isShaNiSupported()) {
+        QSKIP("SHA-NI is not supported by this processor");
+    }
+    QCOMPARE(toHex(hashWithCompress(message, [](uint32_t *state, const uint8_t *blocks, size_t countBlocks) {
+        Sha256Hasher::compressShaNi(state, blocks, countBlocks);
+    })), hash);
+}
+
+void tst_Sha256Hasher::testCompressEquals() {
+    if (!isShaNiSupported()) {
+        QSKIP("SHA-NI is not supported by this processor");
+    }
+    // Несколько блоков за вызов, чтобы проверить и перенос состояния между блоками внутри реализации
+    for (size_t countBlocks = 1; countBlocks <= 8; countBlocks++) {
+        const std::string blocks = makeMessage(countBlocks * Sha256Hasher::BLOCK_SIZE + countBlocks);
+        uint32_t statePortable[8];
+        for (size_t i = 0; i < 8; i++) {
+            statePortable[i] = uint32_t(i * 0x9e3779b9 + countBlocks);
+        }
+        uint32_t stateShaNi[8];
+        std::memcpy(stateShaNi, statePortable, sizeof(stateShaNi));
+
+        Sha256Hasher::compressPortable(statePortable, (const uint8_t*)blocks.data() + countBlocks, countBlocks);
+        QVERIFY(Sha256Hasher::compressShaNi(stateShaNi, (const uint8_t*)blocks.data() + countBlocks, countBlocks));
+        QVERIFY(std::memcmp(statePortable, stateShaNi, sizeof(statePortable)) == 0);
+    }
+}
+
+void tst_Sha256Hasher::testHashCryptoPP() {
+    for (size_t size = 0; size <= 300; size++) {
+        const std::string message = makeMessage(size);
+        QCOMPARE(toHex(Sha256Hasher::hash(message)), toHex(sha256CryptoPP(message)));
+    }
+}
+
+void tst_Sha256Hasher::testDoubleHash() {
+    const std::string message = makeMessage(SHORT_MESSAGE_SIZE);
+    QCOMPARE(toHex(Sha256Hasher::doubleHash(message)), toHex(sha256CryptoPP(sha256CryptoPP(message))));
+}
+
+void tst_Sha256Hasher::benchmarkShortCryptoPP() {
+    const std::string message = makeMessage(SHORT_MESSAGE_SIZE);
+
+    std::string hash;
+    QBENCHMARK {
+        hash = sha256CryptoPP(message);
+    }
+    QCOMPARE(hash.size(), Sha256Hasher::DIGEST_SIZE);
+}
+
+void tst_Sha256Hasher::benchmarkShortSha256Hasher() {
+    const std::string message = makeMessage(SHORT_MESSAGE_SIZE);
+
+    std::string hash;
+    QBENCHMARK {
+        hash = Sha256Hasher::hash(message);
+    }
+    QCOMPARE(hash.size(), Sha256Hasher::DIGEST_SIZE);
+}
+
+void tst_Sha256Hasher::benchmarkLongCryptoPP() {
+    const std::string message = makeMessage(LONG_MESSAGE_SIZE);
+
+    std::string hash;
+    QBENCHMARK {
+        hash = sha256CryptoPP(message);
+    }
+    QCOMPARE(hash.size(), Sha256Hasher::DIGEST_SIZE);
+}
+
+void tst_Sha256Hasher::benchmarkLongSha256Hasher() {
+    const std::string message = makeMessage(LONG_MESSAGE_SIZE);
+
+    std::string hash;
+    QBENCHMARK {
+        hash = Sha256Hasher::hash(message);
+    }
+    QCOMPARE(hash.size(), Sha256Hasher::DIGEST_SIZE);
+}
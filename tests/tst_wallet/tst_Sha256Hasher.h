@@ -0,0 +1,36 @@
+#ifndef TST_SHA256HASHER_H
+#define TST_SHA256HASHER_H
+
+#include <QObject>
+
+class tst_Sha256Hasher : public QObject {
+    Q_OBJECT
+public:
+    explicit tst_Sha256Hasher(QObject *parent = nullptr);
+
+private slots:
+
+    void testHash_data();
+    void testHash();
+
+    void testCompressPortable_data();
+    void testCompressPortable();
+
+    void testCompressShaNi_data();
+    void testCompressShaNi();
+
+    void testCompressEquals();
+
+    void testHashCryptoPP();
+
+    void testDoubleHash();
+
+    void benchmarkShortCryptoPP();
+    void benchmarkShortSha256Hasher();
+
+    void benchmarkLongCryptoPP();
+    void benchmarkLongSha256Hasher();
+
+};
+
+#endif // TST_SHA256HASHER_H
@@ -6,6 +6,8 @@
 #include "tst_Bitcoin.h"
 #include "tst_Ethereum.h"
 #include "tst_Metahash.h"
+#include "tst_Sha256Hasher.h"
+#include "tst_HexBase64.h"
 
 int main(int argc, char *argv[]) {
     int status = 0;
@@ -21,6 +23,8 @@ int main(int argc, char *argv[]) {
     ASSERT_TEST(new tst_rsa());
     ASSERT_TEST(new tst_Bitcoin());
     ASSERT_TEST(new tst_Ethereum());
+    ASSERT_TEST(new tst_Sha256Hasher());
+    ASSERT_TEST(new tst_HexBase64());
 
     return status;
 }
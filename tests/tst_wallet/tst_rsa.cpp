@@ -3,9 +3,12 @@
 #include <QTest>
 
 #include <iostream>
+#include <vector>
+#include <memory>
 
 #include "utils.h"
 #include "openssl_wrapper/openssl_wrapper.h"
+#include "openssl_wrapper/RsaKeyCache.h"
 
 #include "check.h"
 
@@ -187,3 +190,66 @@ void tst_rsa::testSslIncorrectPubkey() {
     const RsaKey privateKeyRsa = getPrivateRsa(privateKey, password);
     QVERIFY_EXCEPTION_THROWN(decrypt(privateKeyRsa, encryptedMsg, publicKey), Exception);
 }
+
+void tst_rsa::testRsaKeyCache() {
+    const std::string password = "Password 1";
+    const std::string message = "Message 1";
+
+    std::vector<std::string> privateKeys;
+    std::vector<std::string> publicKeys;
+    for (size_t i = 0; i < 3; i++) {
+        privateKeys.emplace_back(createRsaKey(password));
+        publicKeys.emplace_back(getPublic(privateKeys.back(), password));
+    }
+
+    RsaKeyCache cache(2);
+    const std::shared_ptr<const RsaKey> key0 = cache.getPublicKey(publicKeys[0]);
+    QVERIFY(cache.getPublicKey(publicKeys[0]) == key0);
+    const std::shared_ptr<const RsaKey> key1 = cache.getPublicKey(publicKeys[1]);
+    QVERIFY(key1 != key0);
+    QCOMPARE(cache.getInfo().countElements, size_t(2));
+
+    // key0 использовался раньше key1, поэтому вытесняется он
+    cache.getPublicKey(publicKeys[2]);
+    QVERIFY(cache.getPublicKey(publicKeys[1]) == key1);
+    QVERIFY(cache.getPublicKey(publicKeys[0]) != key0);
+
+    const RsaKeyCache::Info info = cache.getInfo();
+    QCOMPARE(info.countElements, size_t(2));
+    QCOMPARE(info.countHits, size_t(2));
+    QCOMPARE(info.countMisses, size_t(4));
+
+    // Вытесненный ключ остается рабочим
+    const RsaKey privateKeyRsa = getPrivateRsa(privateKeys[0], password);
+    const std::string encryptedMsg = encrypt(*key0, message, publicKeys[0]);
+    QCOMPARE(decrypt(privateKeyRsa, encryptedMsg, publicKeys[0]), message);
+
+    QVERIFY_EXCEPTION_THROWN(cache.getPublicKey("0011"), Exception);
+    QCOMPARE(cache.getInfo().countElements, size_t(2));
+
+    cache.clear();
+    QCOMPARE(cache.getInfo().countElements, size_t(0));
+}
+
+void tst_rsa::benchmarkEncryptWithoutCache() {
+    const std::string password = "Password 1";
+    const std::string publicKey = getPublic(createRsaKey(password), password);
+    const std::string message(256, 'a');
+
+    QBENCHMARK {
+        const RsaKey publicKeyRsa = getPublicRsa(publicKey);
+        encrypt(publicKeyRsa, message, publicKey);
+    }
+}
+
+void tst_rsa::benchmarkEncryptWithCache() {
+    const std::string password = "Password 1";
+    const std::string publicKey = getPublic(createRsaKey(password), password);
+    const std::string message(256, 'a');
+
+    RsaKeyCache cache(256);
+    QBENCHMARK {
+        const std::shared_ptr<const RsaKey> publicKeyRsa = cache.getPublicKey(publicKey);
+        encrypt(*publicKeyRsa, message, publicKey);
+    }
+}
@@ -26,6 +26,11 @@ private slots:
     void testSslIncorrectPubkey_data();
     void testSslIncorrectPubkey();
 
+    void testRsaKeyCache();
+
+    void benchmarkEncryptWithoutCache();
+    void benchmarkEncryptWithCache();
+
 };
 
 #endif // TST_RSA_H
@@ -12,9 +12,12 @@ INCLUDEPATH = ../../src
 
 SOURCES += \
     ../../src/Wallet.cpp \
+    ../../src/BatchTransactions.cpp \
     ../../src/EthWallet.cpp \
     ../../src/ethtx/scrypt/crypto_scrypt-nosse.cpp \
+    ../../src/ethtx/scrypt/crypto_scrypt-sse.cpp \
     ../../src/ethtx/scrypt/sha256.cpp \
+    ../../src/Sha256Hasher.cpp \
     ../../src/ethtx/cert.cpp \
     ../../src/ethtx/rlp.cpp \
     ../../src/ethtx/ethtx.cpp \
@@ -22,10 +25,13 @@ SOURCES += \
     ../../src/ethtx/scrypt/crypto_scrypt_saltgen.cpp \
     ../../src/ethtx/crossguid/Guid.cpp \
     ../../src/btctx/Base58.cpp \
+    ../../src/HexBase64.cpp \
     ../../src/btctx/btctx.cpp \
+    ../../src/btctx/CoinSelection.cpp \
     ../../src/btctx/wif.cpp \
     ../../src/BtcWallet.cpp \
     ../../src/openssl_wrapper/openssl_wrapper.cpp \
+    ../../src/openssl_wrapper/RsaKeyCache.cpp \
     ../../src/utils.cpp \
     ../../src/ethtx/utils2.cpp \
     ../../src/Log.cpp \
@@ -34,13 +40,17 @@ SOURCES += \
     tst_Bitcoin.cpp \
     tst_Ethereum.cpp \
     tst_rsa.cpp \
+    tst_Sha256Hasher.cpp \
+    tst_HexBase64.cpp \
     tst_main.cpp
 
 HEADERS += \
     tst_Metahash.h \
     tst_Bitcoin.h \
     tst_Ethereum.h \
-    tst_rsa.h
+    tst_rsa.h \
+    tst_Sha256Hasher.h \
+    tst_HexBase64.h
 
 DEFINES += CRYPTOPP_IMPORTS
 DEFINES += QUAZIP_STATIC
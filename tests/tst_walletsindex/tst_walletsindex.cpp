@@ -0,0 +1,184 @@
+#include "tst_walletsindex.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+
+#include "check.h"
+
+#include "WalletsIndex.h"
+
+// Больше секунды, чтобы время модификации директории изменилось и на файловых системах с точностью до секунд
+const static int MODIFIED_WAIT_MS = 1100;
+
+tst_WalletsIndex::tst_WalletsIndex(QObject *parent)
+    : QObject(parent)
+{
+}
+
+namespace {
+
+struct CountingList {
+    int countCalls = 0;
+
+    WalletsIndex::ListFunc func() {
+        return [this](const QString &folder) {
+            countCalls++;
+            WalletsIndex::Wallets result;
+            const QDir dir(folder);
+            for (const QString &name: dir.entryList(QDir::Files, QDir::Name)) {
+                result.emplace_back(name, dir.filePath(name));
+            }
+            return result;
+        };
+    }
+};
+
+}
+
+static void createFile(const QString &folder, const QString &name) {
+    QFile file(QDir(folder).filePath(name));
+    CHECK(file.open(QIODevice::WriteOnly), "File not open");
+    file.write("key");
+}
+
+static QStringList addresses(const WalletsIndex::Wallets &wallets) {
+    QStringList result;
+    for (const auto &wallet: wallets) {
+        result << wallet.first;
+    }
+    return result;
+}
+
+void tst_WalletsIndex::testCacheHit() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    createFile(dir.path(), "0x01");
+
+    // Без окна точности любое чтение считается достоверным
+    WalletsIndex index(0);
+    index.addFolder(dir.path());
+    CountingList list;
+
+    QCOMPARE(addresses(index.get(dir.path(), list.func())), QStringList({"0x01"}));
+    QCOMPARE(list.countCalls, 1);
+    QCOMPARE(addresses(index.get(dir.path(), list.func())), QStringList({"0x01"}));
+    QCOMPARE(addresses(index.get(dir.path() + "/", list.func())), QStringList({"0x01"}));
+    QCOMPARE(list.countCalls, 1);
+}
+
+void tst_WalletsIndex::testReadInsidePrecision() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    createFile(dir.path(), "0x01");
+
+    // Папка только что изменена, поэтому чтению не доверяем и перечитываем при каждом запросе
+    WalletsIndex index;
+    index.addFolder(dir.path());
+    CountingList list;
+
+    index.get(dir.path(), list.func());
+    QCOMPARE(list.countCalls, 1);
+    index.get(dir.path(), list.func());
+    QCOMPARE(list.countCalls, 2);
+    QCOMPARE(addresses(index.get(dir.path(), list.func())), QStringList({"0x01"}));
+    QCOMPARE(list.countCalls, 3);
+}
+
+void tst_WalletsIndex::testCreateDelete() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    createFile(dir.path(), "0x01");
+
+    WalletsIndex index(0);
+    index.addFolder(dir.path());
+    CountingList list;
+
+    QCOMPARE(addresses(index.get(dir.path(), list.func())), QStringList({"0x01"}));
+    QCOMPARE(list.countCalls, 1);
+
+    QTest::qSleep(MODIFIED_WAIT_MS);
+    createFile(dir.path(), "0x02");
+    QCOMPARE(addresses(index.get(dir.path(), list.func())), QStringList({"0x01", "0x02"}));
+    QCOMPARE(list.countCalls, 2);
+    index.get(dir.path(), list.func());
+    QCOMPARE(list.countCalls, 2);
+
+    QTest::qSleep(MODIFIED_WAIT_MS);
+    QVERIFY(QFile::remove(QDir(dir.path()).filePath("0x01")));
+    QCOMPARE(addresses(index.get(dir.path(), list.func())), QStringList({"0x02"}));
+    QCOMPARE(list.countCalls, 3);
+}
+
+void tst_WalletsIndex::testRefresh() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    createFile(dir.path(), "0x01");
+
+    WalletsIndex index(0);
+    index.addFolder(dir.path());
+    CountingList list;
+
+    // Первое чтение папки считается изменением
+    WalletsIndex::Wallets wallets;
+    QVERIFY(index.refresh(dir.path(), list.func(), wallets));
+    QCOMPARE(addresses(wallets), QStringList({"0x01"}));
+    QCOMPARE(list.countCalls, 1);
+
+    // refresh перечитывает папку всегда, но об изменении сообщает, только если изменился список
+    QVERIFY(!index.refresh(dir.path(), list.func(), wallets));
+    QCOMPARE(addresses(wallets), QStringList({"0x01"}));
+    QCOMPARE(list.countCalls, 2);
+
+    createFile(dir.path(), "0x02");
+    QVERIFY(index.refresh(dir.path(), list.func(), wallets));
+    QCOMPARE(addresses(wallets), QStringList({"0x01", "0x02"}));
+    QCOMPARE(list.countCalls, 3);
+
+    // Список после refresh отдается из кэша
+    QCOMPARE(addresses(index.get(dir.path(), list.func())), QStringList({"0x01", "0x02"}));
+    QCOMPARE(list.countCalls, 3);
+}
+
+void tst_WalletsIndex::testNotAddedFolder() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    createFile(dir.path(), "0x01");
+
+    WalletsIndex index(0);
+    CountingList list;
+
+    QCOMPARE(addresses(index.get(dir.path(), list.func())), QStringList({"0x01"}));
+    QCOMPARE(addresses(index.get(dir.path(), list.func())), QStringList({"0x01"}));
+    QCOMPARE(list.countCalls, 2);
+
+    QVERIFY_EXCEPTION_THROWN(index.get("", list.func()), Exception);
+}
+
+void tst_WalletsIndex::testClear() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    createFile(dir.path(), "0x01");
+
+    WalletsIndex index(0);
+    index.addFolder(dir.path());
+    CountingList list;
+
+    index.get(dir.path(), list.func());
+    index.get(dir.path(), list.func());
+    QCOMPARE(list.countCalls, 1);
+
+    // После clear папка больше не кэшируется, пока ее не добавят снова
+    index.clear();
+    index.get(dir.path(), list.func());
+    index.get(dir.path(), list.func());
+    QCOMPARE(list.countCalls, 3);
+
+    index.addFolder(dir.path());
+    index.get(dir.path(), list.func());
+    index.get(dir.path(), list.func());
+    QCOMPARE(list.countCalls, 4);
+}
+
+QTEST_MAIN(tst_WalletsIndex)
@@ -0,0 +1,28 @@
+#ifndef TST_WALLETSINDEX_H
+#define TST_WALLETSINDEX_H
+
+#include <QObject>
+
+class tst_WalletsIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit tst_WalletsIndex(QObject *parent = nullptr);
+
+private slots:
+
+    void testCacheHit();
+
+    void testReadInsidePrecision();
+
+    void testCreateDelete();
+
+    void testRefresh();
+
+    void testNotAddedFolder();
+
+    void testClear();
+
+};
+
+#endif // TST_WALLETSINDEX_H
@@ -0,0 +1,25 @@
+QT      += testlib
+QT      -= gui
+QT      += widgets
+TARGET = tst_walletsindex
+CONFIG   += testcase
+CONFIG += c++14
+CONFIG += static
+
+TEMPLATE = app
+
+INCLUDEPATH = ../../src
+
+SOURCES += \
+    tst_walletsindex.cpp \
+    ../../src/WalletsIndex.cpp
+
+
+HEADERS += \
+    tst_walletsindex.h \
+    ../../src/WalletsIndex.h
+
+QMAKE_LFLAGS += -rdynamic
+unix:!macx: include(../../libs-unix.pri)
+win32: include(../../libs-win.pri)
+macx: include(../../libs-macos.pri)